@@ -37,6 +37,7 @@ constexpr int syscall_vector = 0x82;
 
 extern "C" {
 struct pollfd;
+struct epoll_event;
 struct timeval;
 struct timespec;
 struct sockaddr;
@@ -193,7 +194,12 @@ namespace Kernel {
     S(anon_create)            \
     S(msyscall)               \
     S(readv)                  \
-    S(emuctl)
+    S(emuctl)                 \
+    S(epoll_create)           \
+    S(epoll_ctl)              \
+    S(epoll_wait)             \
+    S(sendfile)               \
+    S(splice)
 
 namespace Syscall {
 
@@ -278,6 +284,37 @@ struct SC_poll_params {
     const u32* sigmask;
 };
 
+struct SC_epoll_ctl_params {
+    int epfd;
+    int op;
+    int fd;
+    const struct epoll_event* event;
+};
+
+struct SC_epoll_wait_params {
+    int epfd;
+    struct epoll_event* events;
+    int maxevents;
+    const struct timespec* timeout;
+    const u32* sigmask;
+};
+
+struct SC_sendfile_params {
+    int out_fd;
+    int in_fd;
+    int64_t* offset;
+    size_t count;
+};
+
+struct SC_splice_params {
+    int fd_in;
+    int64_t* off_in;
+    int fd_out;
+    int64_t* off_out;
+    size_t length;
+    unsigned flags;
+};
+
 struct SC_clock_nanosleep_params {
     int clock_id;
     int flags;
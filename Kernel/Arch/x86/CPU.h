@@ -771,6 +771,11 @@ public:
         m_mm_data = &mm_data;
     }
 
+    ALWAYS_INLINE bool has_mm_data() const
+    {
+        return m_mm_data;
+    }
+
     ALWAYS_INLINE MemoryManagerData& get_mm_data() const
     {
         return *m_mm_data;
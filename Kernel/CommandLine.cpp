@@ -178,6 +178,33 @@ UNMAP_AFTER_INIT AHCIResetMode CommandLine::ahci_reset_mode() const
     PANIC("Unknown AHCIResetMode: {}", ahci_reset_mode);
 }
 
+UNMAP_AFTER_INIT size_t CommandLine::fault_around_page_count() const
+{
+    const auto fault_around = lookup("fault_around").value_or("16");
+    auto page_count = fault_around.to_uint();
+    if (!page_count.has_value() || page_count.value() > 64 || (page_count.value() & (page_count.value() - 1)))
+        PANIC("fault_around must be a power of two no larger than 64, got: {}", fault_around);
+    return page_count.value();
+}
+
+UNMAP_AFTER_INIT static size_t parse_descriptor_count(const String& key, const String& value)
+{
+    auto count = value.to_uint();
+    if (!count.has_value() || count.value() < 64 || count.value() > 4096 || (count.value() & (count.value() - 1)))
+        PANIC("{} must be a power of two between 64 and 4096, got: {}", key, value);
+    return count.value();
+}
+
+UNMAP_AFTER_INIT size_t CommandLine::e1000_rx_descriptor_count() const
+{
+    return parse_descriptor_count("e1000_rx_descriptors", lookup("e1000_rx_descriptors").value_or("256"));
+}
+
+UNMAP_AFTER_INIT size_t CommandLine::e1000_tx_descriptor_count() const
+{
+    return parse_descriptor_count("e1000_tx_descriptors", lookup("e1000_tx_descriptors").value_or("256"));
+}
+
 UNMAP_AFTER_INIT BootMode CommandLine::boot_mode() const
 {
     const auto boot_mode = lookup("boot_mode").value_or("graphical");
@@ -87,6 +87,9 @@ public:
     [[nodiscard]] bool disable_physical_storage() const;
     [[nodiscard]] bool disable_ps2_controller() const;
     [[nodiscard]] AHCIResetMode ahci_reset_mode() const;
+    [[nodiscard]] size_t fault_around_page_count() const;
+    [[nodiscard]] size_t e1000_rx_descriptor_count() const;
+    [[nodiscard]] size_t e1000_tx_descriptor_count() const;
     [[nodiscard]] String userspace_init() const;
     [[nodiscard]] Vector<String> userspace_init_args() const;
     [[nodiscard]] String root_device() const;
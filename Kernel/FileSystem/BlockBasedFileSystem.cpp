@@ -25,68 +25,113 @@
  */
 
 #include <AK/IntrusiveList.h>
+#include <AK/QuickSort.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/KBuffer.h>
 #include <Kernel/Process.h>
+#include <Kernel/Tasks/SyncTask.h>
+#include <Kernel/Time/TimeManagement.h>
+#include <Kernel/VM/MemoryManager.h>
 
 namespace Kernel {
 
+struct CacheChunk;
+
 struct CacheEntry {
     IntrusiveListNode<CacheEntry> list_node;
     BlockBasedFS::BlockIndex block_index { 0 };
     u8* data { nullptr };
+    CacheChunk* chunk { nullptr };
+    Time dirty_since;
     bool has_data { false };
+    bool is_dirty { false };
+};
+
+// The cache grows and shrinks in chunks of entries, whose block data lives in one KBuffer.
+struct CacheChunk {
+    static constexpr size_t entry_count = 64;
+
+    IntrusiveListNode<CacheChunk> list_node;
+    NonnullOwnPtr<KBuffer> block_data;
+    CacheEntry entries[entry_count];
+
+    explicit CacheChunk(NonnullOwnPtr<KBuffer> data, size_t block_size)
+        : block_data(move(data))
+    {
+        for (size_t i = 0; i < entry_count; ++i) {
+            entries[i].data = block_data->data() + i * block_size;
+            entries[i].chunk = this;
+        }
+    }
 };
 
 class DiskCache {
 public:
+    static constexpr size_t min_chunk_count = 2;
+    static constexpr size_t max_cache_size = 128 * MiB;
+
     explicit DiskCache(BlockBasedFS& fs)
         : m_fs(fs)
-        , m_cached_block_data(KBuffer::create_with_size(m_entry_count * m_fs.block_size()))
-        , m_entries(KBuffer::create_with_size(m_entry_count * sizeof(CacheEntry)))
     {
-        for (size_t i = 0; i < m_entry_count; ++i) {
-            entries()[i].data = m_cached_block_data.data() + i * m_fs.block_size();
-            m_clean_list.append(entries()[i]);
-        }
+        for (size_t i = 0; i < min_chunk_count; ++i)
+            VERIFY(try_grow());
     }
 
-    ~DiskCache() = default;
+    ~DiskCache()
+    {
+        while (auto* chunk = m_chunks.first()) {
+            m_chunks.remove(*chunk);
+            delete chunk;
+        }
+    }
 
     bool is_dirty() const { return m_dirty; }
     void set_dirty(bool b) { m_dirty = b; }
 
-    void mark_all_clean()
-    {
-        while (auto* entry = m_dirty_list.first())
-            m_clean_list.prepend(*entry);
-        m_dirty = false;
-    }
-
     void mark_dirty(CacheEntry& entry)
     {
-        m_dirty_list.prepend(entry);
+        // NOTE: An entry keeps its place in the dirty list (and its age) until it's written back,
+        //       so the dirty list stays ordered from oldest to youngest.
+        if (entry.is_dirty)
+            return;
+        entry.is_dirty = true;
+        entry.dirty_since = TimeManagement::the().monotonic_time();
+        m_dirty_list.append(entry);
+        ++m_dirty_count;
         m_dirty = true;
     }
 
     void mark_clean(CacheEntry& entry)
     {
+        if (entry.is_dirty) {
+            entry.is_dirty = false;
+            --m_dirty_count;
+            if (!m_dirty_count)
+                m_dirty = false;
+        }
         m_clean_list.prepend(entry);
     }
 
-    CacheEntry& get(BlockBasedFS::BlockIndex block_index) const
+    size_t dirty_count() const { return m_dirty_count; }
+
+    bool contains(BlockBasedFS::BlockIndex block_index) const { return m_hash.contains(block_index); }
+
+    // Returns nullptr if every entry is dirty and they can't be written back.
+    CacheEntry* get(BlockBasedFS::BlockIndex block_index) const
     {
         if (auto it = m_hash.find(block_index); it != m_hash.end()) {
-            auto& entry = const_cast<CacheEntry&>(*it->value);
-            VERIFY(entry.block_index == block_index);
+            auto* entry = const_cast<CacheEntry*>(it->value);
+            VERIFY(entry->block_index == block_index);
             return entry;
         }
 
-        if (m_clean_list.is_empty()) {
-            // Not a single clean entry! Flush writes and try again.
+        if (m_clean_list.is_empty() && !const_cast<DiskCache&>(*this).try_grow()) {
+            // Not a single clean entry and no memory to grow into! Flush writes and try again.
             // NOTE: We want to make sure we only call FileBackedFS flush here,
             //       not some FileBackedFS subclass flush!
-            m_fs.flush_writes_impl();
+            if (m_fs.flush_writes_impl().is_error() && m_clean_list.is_empty())
+                return nullptr;
             return get(block_index);
         }
 
@@ -94,36 +139,144 @@ public:
         auto& new_entry = *m_clean_list.last();
         m_clean_list.prepend(new_entry);
 
-        m_hash.remove(new_entry.block_index);
+        forget(new_entry);
         m_hash.set(block_index, &new_entry);
 
         new_entry.block_index = block_index;
         new_entry.has_data = false;
 
-        return new_entry;
+        return &new_entry;
     }
 
-    const CacheEntry* entries() const { return (const CacheEntry*)m_entries.data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries.data(); }
-
+    // NOTE: Dirty entries are visited from oldest to youngest.
     template<typename Callback>
     void for_each_dirty_entry(Callback callback)
     {
-        for (auto& entry : m_dirty_list)
-            callback(entry);
+        for (auto& entry : m_dirty_list) {
+            if (callback(entry) == IterationDecision::Break)
+                break;
+        }
+    }
+
+    size_t entry_count() const { return m_chunk_count * CacheChunk::entry_count; }
+
+    u8* read_ahead_buffer(size_t max_block_count)
+    {
+        if (!m_read_ahead_buffer)
+            m_read_ahead_buffer = KBuffer::try_create_with_size(max_block_count * m_fs.block_size(), Region::Access::Read | Region::Access::Write, "DiskCache read-ahead");
+        return m_read_ahead_buffer ? m_read_ahead_buffer->data() : nullptr;
+    }
+
+    u8* writeback_buffer(size_t max_block_count)
+    {
+        if (!m_writeback_buffer)
+            m_writeback_buffer = KBuffer::try_create_with_size(max_block_count * m_fs.block_size(), Region::Access::Read | Region::Access::Write, "DiskCache writeback");
+        return m_writeback_buffer ? m_writeback_buffer->data() : nullptr;
+    }
+
+    // Grow or shrink the cache towards a share of the memory that's currently available.
+    // Under memory pressure, we give back as much as we can.
+    void resize_to_target()
+    {
+        auto target_chunk_count = this->target_chunk_count();
+        while (m_chunk_count < target_chunk_count) {
+            if (!try_grow())
+                break;
+        }
+        while (m_chunk_count > target_chunk_count) {
+            if (!shrink())
+                break;
+        }
     }
 
 private:
+    size_t chunk_size() const { return CacheChunk::entry_count * m_fs.block_size(); }
+
+    size_t target_chunk_count() const
+    {
+        size_t total_bytes = MM.user_physical_pages() * PAGE_SIZE;
+        size_t available_bytes = min(MM.user_physical_pages_uncommitted(), MM.user_physical_pages() - MM.user_physical_pages_used()) * PAGE_SIZE;
+
+        // Memory pressure: Keep only the bare minimum around.
+        if (available_bytes < total_bytes / 16)
+            return min_chunk_count;
+
+        // Aim for a quarter of the memory that we could be using, counting our own.
+        size_t target_bytes = min((available_bytes + m_chunk_count * chunk_size()) / 4, max_cache_size);
+        return max(target_bytes / chunk_size(), min_chunk_count);
+    }
+
+    bool try_grow()
+    {
+        if (m_chunk_count >= min_chunk_count && m_chunk_count >= target_chunk_count())
+            return false;
+        auto block_data = KBuffer::try_create_with_size(chunk_size(), Region::Access::Read | Region::Access::Write, "DiskCache");
+        if (!block_data)
+            return false;
+        auto* chunk = new CacheChunk(block_data.release_nonnull(), m_fs.block_size());
+        for (auto& entry : chunk->entries)
+            m_clean_list.append(entry);
+        m_chunks.append(*chunk);
+        ++m_chunk_count;
+        dbgln_if(BBFS_DEBUG, "DiskCache: Grew to {} entries", entry_count());
+        return true;
+    }
+
+    void forget(const CacheEntry& entry) const
+    {
+        if (auto it = m_hash.find(entry.block_index); it != m_hash.end() && it->value == &entry)
+            m_hash.remove(it);
+    }
+
+    bool shrink()
+    {
+        VERIFY(m_chunk_count > min_chunk_count);
+        auto* chunk = m_chunks.last();
+        VERIFY(chunk);
+        for (auto& entry : chunk->entries) {
+            if (entry.is_dirty) {
+                // Blocks that couldn't be written back stay dirty, so the chunk has to stay as well.
+                if (m_fs.flush_writes_impl().is_error())
+                    return false;
+                break;
+            }
+        }
+        for (auto& entry : chunk->entries) {
+            VERIFY(!entry.is_dirty);
+            forget(entry);
+            m_clean_list.remove(entry);
+        }
+        m_chunks.remove(*chunk);
+        delete chunk;
+        --m_chunk_count;
+        dbgln_if(BBFS_DEBUG, "DiskCache: Shrunk to {} entries", entry_count());
+        return true;
+    }
+
     BlockBasedFS& m_fs;
-    size_t m_entry_count { 10000 };
+    size_t m_chunk_count { 0 };
+    IntrusiveList<CacheChunk, RawPtr<CacheChunk>, &CacheChunk::list_node> m_chunks;
     mutable HashMap<BlockBasedFS::BlockIndex, CacheEntry*> m_hash;
     mutable IntrusiveList<CacheEntry, RawPtr<CacheEntry>, &CacheEntry::list_node> m_clean_list;
     mutable IntrusiveList<CacheEntry, RawPtr<CacheEntry>, &CacheEntry::list_node> m_dirty_list;
-    KBuffer m_cached_block_data;
-    KBuffer m_entries;
+    OwnPtr<KBuffer> m_read_ahead_buffer;
+    OwnPtr<KBuffer> m_writeback_buffer;
+    size_t m_dirty_count { 0 };
     bool m_dirty { false };
 };
 
+static constexpr size_t min_read_ahead_block_count = 4;
+static constexpr size_t max_read_ahead_block_count = 32;
+
+// Dirty blocks are written back by the SyncTask once they've been dirty for a while,
+// or as soon as too much of the cache is dirty. Writers only ever write back blocks
+// themselves once the cache is getting close to being entirely dirty.
+static constexpr Time dirty_expire_time = Time::from_seconds(5);
+static constexpr size_t dirty_background_ratio_percent = 10;
+static constexpr size_t dirty_ratio_percent = 40;
+static constexpr size_t max_writeback_batch_block_count = 256;
+static constexpr size_t max_writeback_run_block_count = 64;
+
 BlockBasedFS::BlockBasedFS(FileDescription& file_description)
     : FileBackedFS(file_description)
 {
@@ -142,7 +295,8 @@ KResult BlockBasedFS::write_block(BlockIndex index, const UserOrKernelBuffer& da
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::write_block {}, size={}", index, count);
 
     if (!allow_cache) {
-        flush_specific_block_if_needed(index);
+        if (auto result = flush_specific_block_if_needed(index); result.is_error())
+            return result;
         u32 base_offset = index.value() * block_size() + offset;
         auto seek_result = file_description().seek(base_offset, SEEK_SET);
         if (seek_result.is_error())
@@ -154,18 +308,31 @@ KResult BlockBasedFS::write_block(BlockIndex index, const UserOrKernelBuffer& da
         return KSuccess;
     }
 
-    auto& entry = cache().get(index);
+    auto* entry = cache().get(index);
+    if (!entry)
+        return EIO;
     if (count < block_size()) {
         // Fill the cache first.
         auto result = read_block(index, nullptr, block_size());
         if (result.is_error())
             return result;
     }
-    if (!data.read(entry.data + offset, count))
+    if (!data.read(entry->data + offset, count))
         return EFAULT;
 
-    cache().mark_dirty(entry);
-    entry.has_data = true;
+    cache().mark_dirty(*entry);
+    entry->has_data = true;
+
+    auto dirty_count = cache().dirty_count();
+    auto entry_count = cache().entry_count();
+    if (dirty_count * 100 > entry_count * dirty_ratio_percent) {
+        // We're producing dirty blocks faster than the SyncTask can write them back.
+        // Help out with the oldest ones, so that get() never has to flush everything.
+        write_back_oldest_entries(dirty_count - entry_count * dirty_background_ratio_percent / 100);
+    } else if (dirty_count * 100 > entry_count * dirty_background_ratio_percent && !m_writeback_requested) {
+        m_writeback_requested = true;
+        SyncTask::request_writeback();
+    }
     return KSuccess;
 }
 
@@ -196,25 +363,22 @@ bool BlockBasedFS::raw_write(BlockIndex index, const UserOrKernelBuffer& buffer)
 bool BlockBasedFS::raw_read_blocks(BlockIndex index, size_t count, UserOrKernelBuffer& buffer)
 {
     LOCKER(m_lock);
-    auto current = buffer;
-    for (unsigned block = index.value(); block < (index.value() + count); block++) {
-        if (!raw_read(BlockIndex { block }, current))
-            return false;
-        current = current.offset(logical_block_size());
-    }
-    return true;
+    // Issue the whole range as a single request, so the device gets to see it as such.
+    auto seek_result = file_description().seek(index.value() * m_logical_block_size, SEEK_SET);
+    if (seek_result.is_error())
+        return false;
+    auto nread = file_description().read(buffer, count * m_logical_block_size);
+    return !nread.is_error() && nread.value() == count * m_logical_block_size;
 }
 
 bool BlockBasedFS::raw_write_blocks(BlockIndex index, size_t count, const UserOrKernelBuffer& buffer)
 {
     LOCKER(m_lock);
-    auto current = buffer;
-    for (unsigned block = index.value(); block < (index.value() + count); block++) {
-        if (!raw_write(block, current))
-            return false;
-        current = current.offset(logical_block_size());
-    }
-    return true;
+    auto seek_result = file_description().seek(index.value() * m_logical_block_size, SEEK_SET);
+    if (seek_result.is_error())
+        return false;
+    auto nwritten = file_description().write(buffer, count * m_logical_block_size);
+    return !nwritten.is_error() && nwritten.value() == count * m_logical_block_size;
 }
 
 KResult BlockBasedFS::write_blocks(BlockIndex index, unsigned count, const UserOrKernelBuffer& data, bool allow_cache)
@@ -238,7 +402,8 @@ KResult BlockBasedFS::read_block(BlockIndex index, UserOrKernelBuffer* buffer, s
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_block {}", index);
 
     if (!allow_cache) {
-        const_cast<BlockBasedFS*>(this)->flush_specific_block_if_needed(index);
+        if (auto result = const_cast<BlockBasedFS*>(this)->flush_specific_block_if_needed(index); result.is_error())
+            return result;
         auto base_offset = index.value() * block_size() + offset;
         auto seek_result = file_description().seek(base_offset, SEEK_SET);
         if (seek_result.is_error())
@@ -250,24 +415,81 @@ KResult BlockBasedFS::read_block(BlockIndex index, UserOrKernelBuffer* buffer, s
         return KSuccess;
     }
 
-    auto& entry = cache().get(index);
-    if (!entry.has_data) {
-        auto base_offset = index.value() * block_size();
-        auto seek_result = file_description().seek(base_offset, SEEK_SET);
-        if (seek_result.is_error())
-            return seek_result.error();
-        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-        auto nread = file_description().read(entry_data_buffer, block_size());
-        if (nread.is_error())
-            return nread.error();
-        VERIFY(nread.value() == block_size());
-        entry.has_data = true;
+    auto* entry = cache().get(index);
+    if (!entry)
+        return EIO;
+    if (!entry->has_data) {
+        auto result = const_cast<BlockBasedFS*>(this)->read_into_cache(index, *entry);
+        if (result.is_error())
+            return result;
+    } else if (index == m_read_ahead_next_block) {
+        // Keep track of sequential readers that are consuming blocks we read ahead.
+        m_read_ahead_next_block = index.value() + 1;
     }
-    if (buffer && !buffer->write(entry.data + offset, count))
+    if (buffer && !buffer->write(entry->data + offset, count))
         return EFAULT;
     return KSuccess;
 }
 
+size_t BlockBasedFS::read_ahead_block_count(BlockIndex index)
+{
+    if (index != m_read_ahead_next_block) {
+        m_read_ahead_window = 1;
+        return 1;
+    }
+    // Sequential access: Double the window every time the reader catches up with us.
+    m_read_ahead_window = clamp(m_read_ahead_window * 2, min_read_ahead_block_count, max_read_ahead_block_count);
+
+    // Never read ahead further than what we already have cached, or than what
+    // the cache could hold without evicting the blocks we're reading.
+    size_t count = 1;
+    size_t max_count = min(m_read_ahead_window, cache().entry_count() / 4);
+    while (count < max_count && !cache().contains(BlockIndex { index.value() + count }))
+        ++count;
+    return count;
+}
+
+KResult BlockBasedFS::read_into_cache(BlockIndex index, CacheEntry& entry)
+{
+    auto count = read_ahead_block_count(index);
+    m_read_ahead_next_block = index.value() + count;
+
+    if (count > 1) {
+        if (auto* read_ahead_data = cache().read_ahead_buffer(max_read_ahead_block_count)) {
+            auto read_ahead_buffer = UserOrKernelBuffer::for_kernel_buffer(read_ahead_data);
+            size_t logical_blocks_per_block = block_size() / logical_block_size();
+            if (raw_read_blocks(index.value() * logical_blocks_per_block, count * logical_blocks_per_block, read_ahead_buffer)) {
+                dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_into_cache {}, read ahead {} blocks", index, count - 1);
+                memcpy(entry.data, read_ahead_data, block_size());
+                entry.has_data = true;
+                for (size_t i = 1; i < count; ++i) {
+                    auto* read_ahead_entry = cache().get(BlockIndex { index.value() + i });
+                    if (!read_ahead_entry)
+                        break;
+                    VERIFY(!read_ahead_entry->has_data);
+                    memcpy(read_ahead_entry->data, read_ahead_data + i * block_size(), block_size());
+                    read_ahead_entry->has_data = true;
+                }
+                return KSuccess;
+            }
+            // We may have run into the end of the device, just read the block we were asked for.
+        }
+        m_read_ahead_next_block = index.value() + 1;
+    }
+
+    auto base_offset = index.value() * block_size();
+    auto seek_result = file_description().seek(base_offset, SEEK_SET);
+    if (seek_result.is_error())
+        return seek_result.error();
+    auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+    auto nread = file_description().read(entry_data_buffer, block_size());
+    if (nread.is_error())
+        return nread.error();
+    VERIFY(nread.value() == block_size());
+    entry.has_data = true;
+    return KSuccess;
+}
+
 KResult BlockBasedFS::read_blocks(BlockIndex index, unsigned count, UserOrKernelBuffer& buffer, bool allow_cache) const
 {
     LOCKER(m_lock);
@@ -287,51 +509,146 @@ KResult BlockBasedFS::read_blocks(BlockIndex index, unsigned count, UserOrKernel
     return KSuccess;
 }
 
-void BlockBasedFS::flush_specific_block_if_needed(BlockIndex index)
+KResult BlockBasedFS::write_back_entries(Vector<CacheEntry*>& entries)
+{
+    LOCKER(m_lock);
+    if (entries.is_empty())
+        return KSuccess;
+
+    // Coalesce runs of adjacent blocks into a single device request each.
+    quick_sort(entries, [](auto* a, auto* b) { return a->block_index < b->block_index; });
+    auto* staging_data = cache().writeback_buffer(max_writeback_run_block_count);
+    size_t logical_blocks_per_block = block_size() / logical_block_size();
+
+    KResult result = KSuccess;
+    for (size_t i = 0; i < entries.size();) {
+        auto first_index = entries[i]->block_index.value();
+        size_t run_length = 1;
+        if (staging_data) {
+            while (i + run_length < entries.size()
+                && run_length < max_writeback_run_block_count
+                && entries[i + run_length]->block_index.value() == first_index + run_length) {
+                ++run_length;
+            }
+        }
+
+        u8* data = entries[i]->data;
+        if (run_length > 1) {
+            for (size_t j = 0; j < run_length; ++j)
+                memcpy(staging_data + j * block_size(), entries[i + j]->data, block_size());
+            data = staging_data;
+        }
+
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(data);
+        if (raw_write_blocks(first_index * logical_blocks_per_block, run_length * logical_blocks_per_block, buffer)) {
+            for (size_t j = 0; j < run_length; ++j)
+                cache().mark_clean(*entries[i + j]);
+        } else {
+            // Leave the blocks dirty, so their data isn't lost and gets written back again later.
+            dbgln("{}: Failed to write back {} blocks at {}", class_name(), run_length, first_index);
+            result = EIO;
+        }
+        i += run_length;
+    }
+    return result;
+}
+
+void BlockBasedFS::write_back_oldest_entries(size_t max_count)
+{
+    LOCKER(m_lock);
+    Vector<CacheEntry*> entries;
+    cache().for_each_dirty_entry([&](CacheEntry& entry) {
+        if (entries.size() >= min(max_count, max_writeback_batch_block_count))
+            return IterationDecision::Break;
+        entries.append(&entry);
+        return IterationDecision::Continue;
+    });
+    // Blocks that fail to write stay dirty, and the SyncTask will retry them.
+    [[maybe_unused]] auto result = write_back_entries(entries);
+}
+
+KResult BlockBasedFS::flush_specific_block_if_needed(BlockIndex index)
 {
     LOCKER(m_lock);
     if (!cache().is_dirty())
-        return;
-    Vector<CacheEntry*, 32> cleaned_entries;
+        return KSuccess;
+    Vector<CacheEntry*> entries;
     cache().for_each_dirty_entry([&](CacheEntry& entry) {
-        if (entry.block_index != index) {
-            size_t base_offset = entry.block_index.value() * block_size();
-            auto seek_result = file_description().seek(base_offset, SEEK_SET);
-            VERIFY(!seek_result.is_error());
-            // FIXME: Should this error path be surfaced somehow?
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-            [[maybe_unused]] auto rc = file_description().write(entry_data_buffer, block_size());
-            cleaned_entries.append(&entry);
-        }
+        if (entry.block_index != index)
+            entries.append(&entry);
+        return IterationDecision::Continue;
     });
-    // NOTE: We make a separate pass to mark entries clean since marking them clean
+    // NOTE: We write the entries back in a separate pass, since marking them clean
     //       moves them out of the dirty list which would disturb the iteration above.
-    for (auto* entry : cleaned_entries)
-        cache().mark_clean(*entry);
+    return write_back_entries(entries);
 }
 
-void BlockBasedFS::flush_writes_impl()
+KResult BlockBasedFS::flush_writes_impl()
 {
     LOCKER(m_lock);
     if (!cache().is_dirty())
-        return;
-    u32 count = 0;
+        return KSuccess;
+    Vector<CacheEntry*> entries;
     cache().for_each_dirty_entry([&](CacheEntry& entry) {
-        u32 base_offset = entry.block_index.value() * block_size();
-        auto seek_result = file_description().seek(base_offset, SEEK_SET);
-        VERIFY(!seek_result.is_error());
-        // FIXME: Should this error path be surfaced somehow?
-        auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
-        [[maybe_unused]] auto rc = file_description().write(entry_data_buffer, block_size());
-        ++count;
+        entries.append(&entry);
+        return IterationDecision::Continue;
     });
-    cache().mark_all_clean();
-    dbgln("{}: Flushed {} blocks to disk", class_name(), count);
+    if (auto result = write_back_entries(entries); result.is_error())
+        return result;
+    dbgln("{}: Flushed {} blocks to disk", class_name(), entries.size());
+    return KSuccess;
+}
+
+bool BlockBasedFS::write_back_expired_entries()
+{
+    LOCKER(m_lock);
+    m_writeback_requested = false;
+    if (!m_cache || !cache().is_dirty())
+        return false;
+
+    auto now = TimeManagement::the().monotonic_time();
+    auto entry_count = cache().entry_count();
+    auto dirty_count = cache().dirty_count();
+
+    // Once we're over the background threshold, write back until we're comfortably below it.
+    size_t excess_count = 0;
+    if (dirty_count * 100 > entry_count * dirty_background_ratio_percent)
+        excess_count = dirty_count - entry_count * dirty_background_ratio_percent / 200;
+
+    Vector<CacheEntry*> entries;
+    bool has_more = false;
+    cache().for_each_dirty_entry([&](CacheEntry& entry) {
+        if (entries.size() >= excess_count && now - entry.dirty_since < dirty_expire_time)
+            return IterationDecision::Break;
+        if (entries.size() >= max_writeback_batch_block_count) {
+            has_more = true;
+            return IterationDecision::Break;
+        }
+        entries.append(&entry);
+        return IterationDecision::Continue;
+    });
+
+    dbgln_if(BBFS_DEBUG, "{}: Writing back {} of {} dirty blocks", class_name(), entries.size(), dirty_count);
+    // The blocks that failed are still dirty, so don't go around again right away.
+    if (write_back_entries(entries).is_error())
+        return false;
+    return has_more;
+}
+
+void BlockBasedFS::write_back()
+{
+    // Write back in bounded batches, so that writers get a chance to grab the lock in between.
+    while (write_back_expired_entries())
+        ;
+
+    LOCKER(m_lock);
+    if (m_cache)
+        m_cache->resize_to_target();
 }
 
-void BlockBasedFS::flush_writes()
+KResult BlockBasedFS::flush_writes()
 {
-    flush_writes_impl();
+    return flush_writes_impl();
 }
 
 DiskCache& BlockBasedFS::cache() const
@@ -30,6 +30,8 @@
 
 namespace Kernel {
 
+struct CacheEntry;
+
 class BlockBasedFS : public FileBackedFS {
 public:
     TYPEDEF_DISTINCT_ORDERED_ID(u64, BlockIndex);
@@ -38,8 +40,9 @@ public:
 
     size_t logical_block_size() const { return m_logical_block_size; };
 
-    virtual void flush_writes() override;
-    void flush_writes_impl();
+    virtual KResult flush_writes() override;
+    virtual void write_back() override;
+    KResult flush_writes_impl();
 
 protected:
     explicit BlockBasedFS(FileDescription&);
@@ -60,9 +63,19 @@ protected:
 
 private:
     DiskCache& cache() const;
-    void flush_specific_block_if_needed(BlockIndex index);
+    KResult flush_specific_block_if_needed(BlockIndex index);
+
+    size_t read_ahead_block_count(BlockIndex);
+    KResult read_into_cache(BlockIndex, CacheEntry&);
+
+    KResult write_back_entries(Vector<CacheEntry*>&);
+    void write_back_oldest_entries(size_t max_count);
+    bool write_back_expired_entries();
 
     mutable OwnPtr<DiskCache> m_cache;
+    mutable BlockIndex m_read_ahead_next_block { 0 };
+    size_t m_read_ahead_window { 1 };
+    bool m_writeback_requested { false };
 };
 
 }
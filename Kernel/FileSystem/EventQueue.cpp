@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/EventQueue.h>
+#include <Kernel/FileSystem/FileDescription.h>
+
+namespace Kernel {
+
+// Serializes attaching and detaching watchers with the destruction of the
+// descriptions they watch, since watchers don't keep their description alive.
+// Lock order: s_watchers_lock -> FileBlockCondition::m_lock -> EventQueue::m_lock
+static SpinLock<u8> s_watchers_lock;
+static HashMap<FileDescription*, Vector<EventQueueWatcher*, 1>>* s_watchers_by_description;
+
+EventQueueWatcher::EventQueueWatcher(EventQueue& queue, int fd, FileDescription& description, const epoll_event& event)
+    : m_queue(queue)
+    , m_fd(fd)
+    , m_description(description)
+    , m_event(event)
+{
+    VERIFY(s_watchers_lock.is_locked());
+    s_watchers_by_description->ensure(&description).append(this);
+    description.set_has_event_queue_watchers({}, true);
+
+    // NOTE: This may call unblock() right away if the description is already ready.
+    [[maybe_unused]] bool added = description.block_condition().add_blocker(*this, nullptr);
+    VERIFY(added);
+}
+
+EventQueueWatcher::~EventQueueWatcher()
+{
+    VERIFY(s_watchers_lock.is_locked());
+    m_description.block_condition().remove_blocker(*this, nullptr);
+
+    auto it = s_watchers_by_description->find(&m_description);
+    VERIFY(it != s_watchers_by_description->end());
+    it->value.remove_first_matching([&](auto* watcher) { return watcher == this; });
+    if (it->value.is_empty()) {
+        s_watchers_by_description->remove(it);
+        m_description.set_has_event_queue_watchers({}, false);
+    }
+
+    ScopedSpinLock lock(m_queue.m_lock);
+    if (m_ready_list_node.is_in_list())
+        m_queue.m_ready_list.remove(*this);
+}
+
+auto EventQueueWatcher::block_flags() const -> BlockFlags
+{
+    // FileDescription::should_unblock() doesn't track exceptional conditions, so EPOLLPRI is never reported.
+    auto flags = BlockFlags::None;
+    if (m_event.events & EPOLLIN)
+        flags |= BlockFlags::Read;
+    if (m_event.events & EPOLLOUT)
+        flags |= BlockFlags::Write;
+    return flags;
+}
+
+u32 EventQueueWatcher::ready_events()
+{
+    auto unblock_flags = m_description.should_unblock(block_flags());
+    u32 events = 0;
+    if (has_flag(unblock_flags, BlockFlags::Read))
+        events |= EPOLLIN;
+    if (has_flag(unblock_flags, BlockFlags::Write))
+        events |= EPOLLOUT;
+    return events;
+}
+
+bool EventQueueWatcher::unblock(bool, void*)
+{
+    if (m_description.should_unblock(block_flags()) != BlockFlags::None)
+        m_queue.watcher_became_ready(*this);
+
+    // Never let the block condition drop us, we want to hear about every change.
+    return false;
+}
+
+NonnullRefPtr<EventQueue> EventQueue::create()
+{
+    return adopt(*new EventQueue);
+}
+
+EventQueue::~EventQueue()
+{
+    ScopedSpinLock watchers_lock(s_watchers_lock);
+    decltype(m_watchers) watchers;
+    {
+        ScopedSpinLock lock(m_lock);
+        watchers = move(m_watchers);
+    }
+    // The watchers are destroyed here, while we still hold s_watchers_lock.
+}
+
+KResult EventQueue::add(int fd, FileDescription& description, const epoll_event& event)
+{
+    if (description.is_event_queue())
+        return EINVAL;
+
+    ScopedSpinLock watchers_lock(s_watchers_lock);
+    if (!s_watchers_by_description)
+        s_watchers_by_description = new HashMap<FileDescription*, Vector<EventQueueWatcher*, 1>>;
+
+    OwnPtr<EventQueueWatcher> stale_watcher;
+    {
+        ScopedSpinLock lock(m_lock);
+        auto it = m_watchers.find(fd);
+        if (it != m_watchers.end()) {
+            if (&it->value->description() == &description)
+                return EEXIST;
+            // This fd number was closed and reused while the old description
+            // is still open elsewhere. Forget about the old one.
+            stale_watcher = take_watcher(fd, it->value->description());
+        }
+    }
+    stale_watcher = nullptr;
+
+    auto watcher = make<EventQueueWatcher>(*this, fd, description, event);
+    dbgln_if(POLL_SELECT_DEBUG, "EventQueue {}: Watching fd {} for events {:#x}", this, fd, event.events);
+
+    ScopedSpinLock lock(m_lock);
+    m_watchers.set(fd, move(watcher));
+    return KSuccess;
+}
+
+KResult EventQueue::modify(int fd, FileDescription& description, const epoll_event& event)
+{
+    ScopedSpinLock watchers_lock(s_watchers_lock);
+    EventQueueWatcher* watcher;
+    {
+        ScopedSpinLock lock(m_lock);
+        auto it = m_watchers.find(fd);
+        if (it == m_watchers.end() || &it->value->description() != &description)
+            return ENOENT;
+        watcher = it->value.ptr();
+        watcher->m_event = event;
+        watcher->m_is_disarmed = false;
+        if (watcher->m_ready_list_node.is_in_list())
+            m_ready_list.remove(*watcher);
+    }
+
+    // Pick up the current state of the description for the new set of events.
+    watcher->unblock(false, nullptr);
+    return KSuccess;
+}
+
+KResult EventQueue::remove(int fd, FileDescription& description)
+{
+    ScopedSpinLock watchers_lock(s_watchers_lock);
+    OwnPtr<EventQueueWatcher> watcher;
+    {
+        ScopedSpinLock lock(m_lock);
+        watcher = take_watcher(fd, description);
+    }
+    if (!watcher)
+        return ENOENT;
+    return KSuccess;
+}
+
+OwnPtr<EventQueueWatcher> EventQueue::take_watcher(int fd, const FileDescription& description)
+{
+    VERIFY(m_lock.is_locked());
+    auto it = m_watchers.find(fd);
+    if (it == m_watchers.end() || &it->value->description() != &description)
+        return {};
+    OwnPtr<EventQueueWatcher> watcher = move(it->value);
+    m_watchers.remove(it);
+    return watcher;
+}
+
+void EventQueue::description_will_be_destroyed(Badge<FileDescription>, FileDescription& description)
+{
+    ScopedSpinLock watchers_lock(s_watchers_lock);
+    for (;;) {
+        auto it = s_watchers_by_description->find(&description);
+        if (it == s_watchers_by_description->end())
+            break;
+        VERIFY(!it->value.is_empty());
+        auto& queue = it->value.first()->m_queue;
+        auto fd = it->value.first()->fd();
+        OwnPtr<EventQueueWatcher> watcher;
+        {
+            ScopedSpinLock lock(queue.m_lock);
+            watcher = queue.take_watcher(fd, description);
+        }
+        VERIFY(watcher);
+        // Destroying the watcher removes it from s_watchers_by_description.
+    }
+}
+
+void EventQueue::watcher_became_ready(EventQueueWatcher& watcher)
+{
+    {
+        ScopedSpinLock lock(m_lock);
+        if (watcher.m_is_disarmed || watcher.m_ready_list_node.is_in_list())
+            return;
+        m_ready_list.append(watcher);
+    }
+    m_wait_queue.wake_all();
+    evaluate_block_conditions();
+}
+
+size_t EventQueue::collect_ready_events(epoll_event* events, size_t max_events)
+{
+    VERIFY(s_watchers_lock.is_locked());
+    ScopedSpinLock lock(m_lock);
+
+    // Level-triggered watchers that are still ready go to the back of the list,
+    // so that every ready description gets its turn when max_events is small.
+    IntrusiveList<EventQueueWatcher, RawPtr<EventQueueWatcher>, &EventQueueWatcher::m_ready_list_node> still_ready;
+    size_t count = 0;
+    while (count < max_events) {
+        auto* watcher = m_ready_list.take_first();
+        if (!watcher)
+            break;
+        auto ready_events = watcher->ready_events();
+        if (!ready_events)
+            continue;
+
+        events[count].events = ready_events;
+        events[count].data = watcher->m_event.data;
+        count++;
+
+        if (watcher->m_event.events & EPOLLONESHOT)
+            watcher->m_is_disarmed = true;
+        else if (!(watcher->m_event.events & EPOLLET))
+            still_ready.append(*watcher);
+    }
+    while (auto* watcher = still_ready.take_first())
+        m_ready_list.append(*watcher);
+    return count;
+}
+
+KResultOr<size_t> EventQueue::wait(epoll_event* events, size_t max_events, const Thread::BlockTimeout& timeout)
+{
+    VERIFY(max_events > 0);
+    for (;;) {
+        size_t count;
+        {
+            ScopedSpinLock watchers_lock(s_watchers_lock);
+            count = collect_ready_events(events, max_events);
+        }
+        if (count > 0)
+            return count;
+
+        auto result = Thread::current()->wait_on(m_wait_queue, timeout, "EventQueue");
+        if (result.was_interrupted())
+            return EINTR;
+        if (result.timed_out())
+            return 0;
+    }
+}
+
+bool EventQueue::can_read(const FileDescription&, size_t) const
+{
+    ScopedSpinLock lock(m_lock);
+    return !m_ready_list.is_empty();
+}
+
+}
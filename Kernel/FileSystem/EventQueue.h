@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Badge.h>
+#include <AK/HashMap.h>
+#include <AK/IntrusiveList.h>
+#include <AK/NonnullOwnPtr.h>
+#include <Kernel/FileSystem/File.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/UnixTypes.h>
+#include <Kernel/WaitQueue.h>
+
+namespace Kernel {
+
+class EventQueue;
+
+// A persistent registration of interest in a file description.
+// Unlike the blockers used by select() and poll(), a watcher stays attached to
+// the description's block condition across waits and only records readiness,
+// so waiting on an EventQueue costs O(ready) instead of O(watched).
+class EventQueueWatcher final : public Thread::FileBlocker {
+public:
+    EventQueueWatcher(EventQueue&, int fd, FileDescription&, const epoll_event&);
+    virtual ~EventQueueWatcher() override;
+
+    virtual const char* state_string() const override { return "EventQueue"; }
+    virtual void not_blocking(bool) override { VERIFY_NOT_REACHED(); }
+    virtual bool unblock(bool from_add_blocker, void*) override;
+
+    int fd() const { return m_fd; }
+    FileDescription& description() { return m_description; }
+
+private:
+    friend class EventQueue;
+
+    BlockFlags block_flags() const;
+    u32 ready_events();
+
+    EventQueue& m_queue;
+    int m_fd { -1 };
+    // NOTE: This is not a strong reference, since watching a description must not keep it open.
+    //       FileDescription detaches its watchers when it's destroyed.
+    FileDescription& m_description;
+    epoll_event m_event {};
+    bool m_is_disarmed { false };
+    IntrusiveListNode<EventQueueWatcher> m_ready_list_node;
+};
+
+class EventQueue final : public File {
+public:
+    static NonnullRefPtr<EventQueue> create();
+    virtual ~EventQueue() override;
+
+    KResult add(int fd, FileDescription&, const epoll_event&);
+    KResult modify(int fd, FileDescription&, const epoll_event&);
+    KResult remove(int fd, FileDescription&);
+
+    // Blocks until at least one watched description is ready (or the timeout expires),
+    // then fills in at most max_events entries.
+    KResultOr<size_t> wait(epoll_event* events, size_t max_events, const Thread::BlockTimeout&);
+
+    static void description_will_be_destroyed(Badge<FileDescription>, FileDescription&);
+
+    virtual bool can_read(const FileDescription&, size_t) const override;
+    virtual bool can_write(const FileDescription&, size_t) const override { return false; }
+    virtual KResultOr<size_t> read(FileDescription&, u64, UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual KResultOr<size_t> write(FileDescription&, u64, const UserOrKernelBuffer&, size_t) override { return EINVAL; }
+    virtual String absolute_path(const FileDescription&) const override { return "event-queue"; }
+    virtual const char* class_name() const override { return "EventQueue"; }
+    virtual bool is_event_queue() const override { return true; }
+
+private:
+    friend class EventQueueWatcher;
+
+    EventQueue() = default;
+
+    void watcher_became_ready(EventQueueWatcher&);
+    size_t collect_ready_events(epoll_event* events, size_t max_events);
+    OwnPtr<EventQueueWatcher> take_watcher(int fd, const FileDescription&);
+
+    mutable SpinLock<u8> m_lock;
+    HashMap<int, NonnullOwnPtr<EventQueueWatcher>> m_watchers;
+    IntrusiveList<EventQueueWatcher, RawPtr<EventQueueWatcher>, &EventQueueWatcher::m_ready_list_node> m_ready_list;
+    WaitQueue m_wait_queue;
+};
+
+}
@@ -690,7 +690,24 @@ void Ext2FS::flush_block_group_descriptor_table()
         dbgln("Ext2FS[{}]::flush_block_group_descriptor_table(): Failed to write blocks: {}", fsid(), result.error());
 }
 
-void Ext2FS::flush_writes()
+KResult Ext2FS::flush_writes()
+{
+    LOCKER(m_lock);
+    flush_metadata();
+    auto result = BlockBasedFS::flush_writes();
+    uncache_unused_inodes();
+    return result;
+}
+
+void Ext2FS::write_back()
+{
+    LOCKER(m_lock);
+    flush_metadata();
+    BlockBasedFS::write_back();
+    uncache_unused_inodes();
+}
+
+void Ext2FS::flush_metadata()
 {
     LOCKER(m_lock);
     if (m_super_block_dirty) {
@@ -711,8 +728,11 @@ void Ext2FS::flush_writes()
             dbgln_if(EXT2_DEBUG, "Ext2FS[{}]::flush_writes(): Flushed bitmap block {}", fsid(), cached_bitmap->bitmap_block_index);
         }
     }
+}
 
-    BlockBasedFS::flush_writes();
+void Ext2FS::uncache_unused_inodes()
+{
+    LOCKER(m_lock);
 
     // Uncache Inodes that are only kept alive by the index-to-inode lookup cache.
     // We don't uncache Inodes that are being watched by at least one InodeWatcher.
@@ -153,7 +153,10 @@ private:
     RefPtr<Inode> get_inode(InodeIdentifier) const;
     KResultOr<NonnullRefPtr<Inode>> create_inode(Ext2FSInode& parent_inode, const String& name, mode_t, dev_t, uid_t, gid_t);
     KResult create_directory(Ext2FSInode& parent_inode, const String& name, mode_t, uid_t, gid_t);
-    virtual void flush_writes() override;
+    virtual KResult flush_writes() override;
+    virtual void write_back() override;
+    void flush_metadata();
+    void uncache_unused_inodes();
 
     BlockIndex first_block_index() const;
     KResultOr<InodeIndex> allocate_inode(GroupIndex preferred_group = 0);
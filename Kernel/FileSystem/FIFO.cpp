@@ -144,6 +144,14 @@ bool FIFO::can_write(const FileDescription&, size_t) const
     return m_buffer.space_for_writing() || !m_readers;
 }
 
+size_t FIFO::space_for_writing(const FileDescription&) const
+{
+    // Writes fail without readers, so there's no room at all.
+    if (!m_readers)
+        return 0;
+    return m_buffer.space_for_writing();
+}
+
 KResultOr<size_t> FIFO::read(FileDescription&, u64, UserOrKernelBuffer& buffer, size_t size)
 {
     if (!m_writers && m_buffer.is_empty())
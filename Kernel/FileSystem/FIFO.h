@@ -26,9 +26,9 @@
 
 #pragma once
 
-#include <Kernel/DoubleBuffer.h>
 #include <Kernel/FileSystem/File.h>
 #include <Kernel/Lock.h>
+#include <Kernel/RingBuffer.h>
 #include <Kernel/UnixTypes.h>
 #include <Kernel/WaitQueue.h>
 
@@ -55,6 +55,9 @@ public:
     void attach(Direction);
     void detach(Direction);
 
+    size_t buffer_capacity() const { return m_buffer.capacity(); }
+    KResult set_buffer_capacity(size_t capacity) { return m_buffer.set_capacity(capacity); }
+
 private:
     // ^File
     virtual KResultOr<size_t> write(FileDescription&, u64, const UserOrKernelBuffer&, size_t) override;
@@ -62,6 +65,7 @@ private:
     virtual KResult stat(::stat&) const override;
     virtual bool can_read(const FileDescription&, size_t) const override;
     virtual bool can_write(const FileDescription&, size_t) const override;
+    virtual size_t space_for_writing(const FileDescription&) const override;
     virtual String absolute_path(const FileDescription&) const override;
     virtual const char* class_name() const override { return "FIFO"; }
     virtual bool is_fifo() const override { return true; }
@@ -70,7 +74,7 @@ private:
 
     unsigned m_writers { 0 };
     unsigned m_readers { 0 };
-    DoubleBuffer m_buffer;
+    RingBuffer m_buffer;
 
     uid_t m_uid { 0 };
 
@@ -27,6 +27,7 @@
 #pragma once
 
 #include <AK/NonnullRefPtr.h>
+#include <AK/NumericLimits.h>
 #include <AK/RefCounted.h>
 #include <AK/String.h>
 #include <AK/Types.h>
@@ -101,6 +102,9 @@ public:
 
     virtual bool can_read(const FileDescription&, size_t) const = 0;
     virtual bool can_write(const FileDescription&, size_t) const = 0;
+    // How much a write could take right now without blocking or coming up short.
+    // Files that take everything they're handed, or fail outright, don't need to override this.
+    virtual size_t space_for_writing(const FileDescription&) const { return NumericLimits<size_t>::max(); }
 
     virtual KResult attach(FileDescription&) { return KSuccess; }
     virtual void detach(FileDescription&) { }
@@ -129,6 +133,7 @@ public:
     virtual bool is_block_device() const { return false; }
     virtual bool is_character_device() const { return false; }
     virtual bool is_socket() const { return false; }
+    virtual bool is_event_queue() const { return false; }
 
     virtual FileBlockCondition& block_condition() { return m_block_condition; }
 
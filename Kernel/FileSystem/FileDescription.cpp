@@ -29,6 +29,7 @@
 #include <Kernel/Devices/BlockDevice.h>
 #include <Kernel/Devices/CharacterDevice.h>
 #include <Kernel/FileSystem/Custody.h>
+#include <Kernel/FileSystem/EventQueue.h>
 #include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/FileSystem/FileSystem.h>
@@ -77,6 +78,10 @@ FileDescription::FileDescription(File& file)
 
 FileDescription::~FileDescription()
 {
+    // NOTE: Nobody can start watching us anymore since we're being destroyed,
+    //       so it's fine to check this without taking the watchers lock.
+    if (m_has_event_queue_watchers)
+        EventQueue::description_will_be_destroyed({}, *this);
     m_file->detach(*this);
     if (is_fifo())
         static_cast<FIFO*>(m_file.ptr())->detach(m_fifo_direction);
@@ -179,6 +184,17 @@ KResultOr<size_t> FileDescription::read(UserOrKernelBuffer& buffer, size_t count
     return nread_or_error;
 }
 
+KResultOr<size_t> FileDescription::read(UserOrKernelBuffer& buffer, u64 offset, size_t count)
+{
+    LOCKER(m_lock);
+    if (Checked<off_t>::addition_would_overflow(offset, count))
+        return EOVERFLOW;
+    auto nread_or_error = m_file->read(*this, offset, buffer, count);
+    if (!nread_or_error.is_error())
+        evaluate_block_conditions();
+    return nread_or_error;
+}
+
 KResultOr<size_t> FileDescription::write(const UserOrKernelBuffer& data, size_t size)
 {
     LOCKER(m_lock);
@@ -193,11 +209,27 @@ KResultOr<size_t> FileDescription::write(const UserOrKernelBuffer& data, size_t
     return nwritten_or_error;
 }
 
+KResultOr<size_t> FileDescription::write(const UserOrKernelBuffer& data, u64 offset, size_t size)
+{
+    LOCKER(m_lock);
+    if (Checked<off_t>::addition_would_overflow(offset, size))
+        return EOVERFLOW;
+    auto nwritten_or_error = m_file->write(*this, offset, data, size);
+    if (!nwritten_or_error.is_error())
+        evaluate_block_conditions();
+    return nwritten_or_error;
+}
+
 bool FileDescription::can_write() const
 {
     return m_file->can_write(*this, offset());
 }
 
+size_t FileDescription::space_for_writing() const
+{
+    return m_file->space_for_writing(*this);
+}
+
 bool FileDescription::can_read() const
 {
     return m_file->can_read(*this, offset());
@@ -351,6 +383,18 @@ FIFO* FileDescription::fifo()
     return static_cast<FIFO*>(m_file.ptr());
 }
 
+bool FileDescription::is_event_queue() const
+{
+    return m_file->is_event_queue();
+}
+
+EventQueue* FileDescription::event_queue()
+{
+    if (!is_event_queue())
+        return nullptr;
+    return static_cast<EventQueue*>(m_file.ptr());
+}
+
 bool FileDescription::is_socket() const
 {
     return m_file->is_socket();
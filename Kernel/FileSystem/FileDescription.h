@@ -38,6 +38,9 @@
 
 namespace Kernel {
 
+class EventQueue;
+class EventQueueWatcher;
+
 class FileDescriptionData {
 public:
     virtual ~FileDescriptionData() = default;
@@ -68,13 +71,16 @@ public:
 
     KResultOr<off_t> seek(off_t, int whence);
     KResultOr<size_t> read(UserOrKernelBuffer&, size_t);
+    KResultOr<size_t> read(UserOrKernelBuffer&, u64 offset, size_t);
     KResultOr<size_t> write(const UserOrKernelBuffer& data, size_t);
+    KResultOr<size_t> write(const UserOrKernelBuffer& data, u64 offset, size_t);
     KResult stat(::stat&);
 
     KResult chmod(mode_t);
 
     bool can_read() const;
     bool can_write() const;
+    size_t space_for_writing() const;
 
     ssize_t get_dir_entries(UserOrKernelBuffer& buffer, ssize_t);
 
@@ -127,6 +133,10 @@ public:
     FIFO::Direction fifo_direction() const { return m_fifo_direction; }
     void set_fifo_direction(Badge<FIFO>, FIFO::Direction direction) { m_fifo_direction = direction; }
 
+    bool is_event_queue() const;
+    EventQueue* event_queue();
+    void set_has_event_queue_watchers(Badge<EventQueueWatcher>, bool b) { m_has_event_queue_watchers = b; }
+
     OwnPtr<FileDescriptionData>& data() { return m_data; }
 
     void set_original_inode(Badge<VFS>, NonnullRefPtr<Inode>&& inode) { m_inode = move(inode); }
@@ -167,6 +177,7 @@ private:
     bool m_should_append : 1 { false };
     bool m_direct : 1 { false };
     FIFO::Direction m_fifo_direction { FIFO::Direction::Neither };
+    bool m_has_event_queue_watchers { false };
 
     Lock m_lock { "FileDescription" };
 };
@@ -71,7 +71,27 @@ FS::DirectoryEntryView::DirectoryEntryView(const StringView& n, InodeIdentifier
 {
 }
 
-void FS::sync()
+KResult FS::sync()
+{
+    Inode::sync();
+
+    NonnullRefPtrVector<FS, 32> fses;
+    {
+        InterruptDisabler disabler;
+        for (auto& it : all_fses())
+            fses.append(*it.value);
+    }
+
+    KResult result = KSuccess;
+    for (auto& fs : fses) {
+        // Keep going, so one failing file system doesn't keep the others from being flushed.
+        if (auto flush_result = fs.flush_writes(); flush_result.is_error())
+            result = flush_result;
+    }
+    return result;
+}
+
+void FS::write_back_all()
 {
     Inode::sync();
 
@@ -83,7 +103,7 @@ void FS::sync()
     }
 
     for (auto& fs : fses)
-        fs.flush_writes();
+        fs.write_back();
 }
 
 void FS::lock_all()
@@ -53,7 +53,8 @@ public:
 
     unsigned fsid() const { return m_fsid; }
     static FS* from_fsid(u32);
-    static void sync();
+    static KResult sync();
+    static void write_back_all();
     static void lock_all();
 
     virtual bool initialize() = 0;
@@ -78,7 +79,11 @@ public:
         u8 file_type { 0 };
     };
 
-    virtual void flush_writes() { }
+    virtual KResult flush_writes() { return KSuccess; }
+
+    // Like flush_writes(), but file systems with a write-back cache may choose
+    // to only write out what has been dirty for a while.
+    virtual void write_back() { [[maybe_unused]] auto result = flush_writes(); }
 
     size_t block_size() const { return m_block_size; }
 
@@ -46,12 +46,45 @@ InodeFile::~InodeFile()
 {
 }
 
+bool InodeFile::should_use_page_cache(const FileDescription& description) const
+{
+    // Only file-backed filesystems have contents that stay put between reads.
+    if (description.is_direct() || !m_inode->fs().is_file_backed())
+        return false;
+    return m_inode->metadata().is_regular_file();
+}
+
+RefPtr<SharedInodeVMObject> InodeFile::page_cache_for_read()
+{
+    // A one-off read goes straight to the inode. Only files that are mapped, or that
+    // get read more than once, are worth setting up a page cache for.
+    if (!m_page_cache) {
+        m_page_cache = m_inode->shared_vmobject();
+        if (!m_page_cache && m_has_been_read)
+            m_page_cache = SharedInodeVMObject::create_with_inode(*m_inode);
+        m_has_been_read = true;
+    }
+    return m_page_cache;
+}
+
 KResultOr<size_t> InodeFile::read(FileDescription& description, u64 offset, UserOrKernelBuffer& buffer, size_t count)
 {
     if (Checked<off_t>::addition_would_overflow(offset, count))
         return EOVERFLOW;
 
-    ssize_t nread = m_inode->read_bytes(offset, count, buffer, &description);
+    RefPtr<SharedInodeVMObject> page_cache;
+    if (should_use_page_cache(description))
+        page_cache = page_cache_for_read();
+
+    ssize_t nread;
+    if (page_cache) {
+        auto nread_or_error = page_cache->read_through_cache(offset, count, buffer);
+        if (nread_or_error.is_error())
+            return nread_or_error.error();
+        nread = nread_or_error.value();
+    } else {
+        nread = m_inode->read_bytes(offset, count, buffer, &description);
+    }
     if (nread > 0) {
         Thread::current()->did_file_read(nread);
         evaluate_block_conditions();
@@ -68,6 +101,9 @@ KResultOr<size_t> InodeFile::write(FileDescription& description, u64 offset, con
 
     ssize_t nwritten = m_inode->write_bytes(offset, count, data, &description);
     if (nwritten > 0) {
+        // Even writes that bypass the cache have to keep the pages that are already cached coherent.
+        if (auto vmobject = m_inode->shared_vmobject())
+            vmobject->update_cache(offset, nwritten, data);
         m_inode->set_mtime(kgettimeofday().to_truncated_seconds());
         Thread::current()->did_file_write(nwritten);
         evaluate_block_conditions();
@@ -132,6 +168,8 @@ KResult InodeFile::truncate(u64 size)
     auto truncate_result = m_inode->truncate(size);
     if (truncate_result.is_error())
         return truncate_result;
+    if (auto vmobject = m_inode->shared_vmobject())
+        vmobject->invalidate_cache_from(size);
     int mtime_result = m_inode->set_mtime(kgettimeofday().to_truncated_seconds());
     if (mtime_result < 0)
         return KResult((ErrnoCode)-mtime_result);
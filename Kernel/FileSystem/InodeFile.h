@@ -65,7 +65,13 @@ public:
 
 private:
     explicit InodeFile(NonnullRefPtr<Inode>&&);
+    bool should_use_page_cache(const FileDescription&) const;
+    RefPtr<SharedInodeVMObject> page_cache_for_read();
+
     NonnullRefPtr<Inode> m_inode;
+    // Keeps the inode's page cache alive for as long as this file is open.
+    RefPtr<SharedInodeVMObject> m_page_cache;
+    bool m_has_been_read { false };
 };
 
 }
@@ -86,6 +86,7 @@ enum ProcFileType {
     FI_Root_df,
     FI_Root_all,
     FI_Root_memstat,
+    FI_Root_kmalloc,
     FI_Root_cpuinfo,
     FI_Root_dmesg,
     FI_Root_interrupts,
@@ -340,6 +341,7 @@ static bool procfs$pid_vm(InodeIdentifier identifier, KBufferBuilder& builder)
             region_object.add("amount_resident", region->amount_resident());
             region_object.add("amount_dirty", region->amount_dirty());
             region_object.add("cow_pages", region->cow_pages());
+            region_object.add("pages_mapped_ahead", region->pages_mapped_ahead());
             region_object.add("name", region->name());
             region_object.add("vmobject", region->vmobject().class_name());
 
@@ -513,6 +515,11 @@ static bool procfs$net_adapters(InodeIdentifier, KBufferBuilder& builder)
         obj.add("bytes_in", adapter.bytes_in());
         obj.add("packets_out", adapter.packets_out());
         obj.add("bytes_out", adapter.bytes_out());
+        obj.add("packets_dropped", adapter.packets_dropped());
+        obj.add("interrupts", adapter.interrupts());
+        obj.add("receive_polls", adapter.receive_polls());
+        obj.add("tx_checksum_offload", adapter.has_offload(NetworkAdapter::Offload::TransmitChecksum));
+        obj.add("rx_checksum_offload", adapter.has_offload(NetworkAdapter::Offload::ReceiveChecksum));
         obj.add("link_up", adapter.link_up());
         obj.add("mtu", adapter.mtu());
     });
@@ -549,6 +556,9 @@ static bool procfs$net_tcp(InodeIdentifier, KBufferBuilder& builder)
         obj.add("bytes_in", socket.bytes_in());
         obj.add("packets_out", socket.packets_out());
         obj.add("bytes_out", socket.bytes_out());
+        obj.add("congestion_window", socket.congestion_window());
+        obj.add("send_window", socket.send_window());
+        obj.add("receive_window", socket.receive_window());
     });
     array.finish();
     return true;
@@ -739,6 +749,7 @@ static bool procfs$memstat(InodeIdentifier, KBufferBuilder& builder)
 
     auto super_physical_total = MM.super_physical_pages();
     auto super_physical_used = MM.super_physical_pages_used();
+    auto zeroed_page_pool_pages = MM.zeroed_page_pool_count();
     mm_lock.unlock();
 
     JsonObjectSerializer<KBufferBuilder> json { builder };
@@ -751,6 +762,9 @@ static bool procfs$memstat(InodeIdentifier, KBufferBuilder& builder)
     json.add("user_physical_uncommitted", user_physical_pages_uncommitted);
     json.add("super_physical_allocated", super_physical_used);
     json.add("super_physical_available", super_physical_total - super_physical_used);
+    json.add("zeroed_page_pool_pages", zeroed_page_pool_pages);
+    json.add("zeroed_page_pool_hits", MM.zeroed_page_pool_hits());
+    json.add("zeroed_page_pool_misses", MM.zeroed_page_pool_misses());
     json.add("kmalloc_call_count", stats.kmalloc_call_count);
     json.add("kfree_call_count", stats.kfree_call_count);
     slab_alloc_stats([&json](size_t slab_size, size_t num_allocated, size_t num_free) {
@@ -762,6 +776,29 @@ static bool procfs$memstat(InodeIdentifier, KBufferBuilder& builder)
     return true;
 }
 
+static bool procfs$kmalloc(InodeIdentifier, KBufferBuilder& builder)
+{
+    kmalloc_size_class_stats size_classes[kmalloc_size_class_count];
+    get_kmalloc_size_class_stats(size_classes);
+
+    JsonArraySerializer array { builder };
+    for (auto& size_class : size_classes) {
+        auto obj = array.add_object();
+        obj.add("size", size_class.size);
+        obj.add("spans", size_class.span_count);
+        obj.add("total_objects", size_class.total_objects);
+        obj.add("allocated_objects", size_class.total_objects - size_class.free_objects - size_class.cached_objects);
+        obj.add("free_objects", size_class.free_objects);
+        obj.add("cached_objects", size_class.cached_objects);
+        obj.add("allocation_count", size_class.allocation_count);
+        obj.add("free_count", size_class.free_count);
+        obj.add("refill_count", size_class.refill_count);
+        obj.add("drain_count", size_class.drain_count);
+    }
+    array.finish();
+    return true;
+}
+
 static bool procfs$all(InodeIdentifier, KBufferBuilder& builder)
 {
     JsonArraySerializer array { builder };
@@ -1702,6 +1739,7 @@ ProcFS::ProcFS()
     m_entries[FI_Root_df] = { "df", FI_Root_df, false, procfs$df };
     m_entries[FI_Root_all] = { "all", FI_Root_all, false, procfs$all };
     m_entries[FI_Root_memstat] = { "memstat", FI_Root_memstat, false, procfs$memstat };
+    m_entries[FI_Root_kmalloc] = { "kmalloc", FI_Root_kmalloc, false, procfs$kmalloc };
     m_entries[FI_Root_cpuinfo] = { "cpuinfo", FI_Root_cpuinfo, false, procfs$cpuinfo };
     m_entries[FI_Root_dmesg] = { "dmesg", FI_Root_dmesg, true, procfs$dmesg };
     m_entries[FI_Root_self] = { "self", FI_Root_self, false, procfs$self };
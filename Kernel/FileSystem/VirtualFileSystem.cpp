@@ -831,9 +831,9 @@ void VFS::for_each_mount(Function<void(const Mount&)> callback) const
     }
 }
 
-void VFS::sync()
+KResult VFS::sync()
 {
-    FS::sync();
+    return FS::sync();
 }
 
 Custody& VFS::root_custody()
@@ -34,7 +34,6 @@ class CoreDump;
 class Custody;
 class Device;
 class DiskCache;
-class DoubleBuffer;
 class File;
 class FileDescription;
 class FutexQueue;
@@ -59,6 +58,7 @@ class ThreadTracer;
 class Range;
 class RangeAllocator;
 class Region;
+class RingBuffer;
 class Scheduler;
 class SchedulerPerProcessorData;
 class Socket;
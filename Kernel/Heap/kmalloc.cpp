@@ -214,6 +214,57 @@ bool g_dump_kmalloc_stacks;
 static u8* s_next_eternal_ptr;
 READONLY_AFTER_INIT static u8* s_end_of_eternal_range;
 
+// Small allocations are served from per-CPU caches of fixed-size objects, which are
+// carved out of larger spans that come from the heap. The per-CPU caches are only ever
+// touched with interrupts disabled on their own processor, so the common case neither
+// scans the heap bitmap nor contends on s_lock.
+static constexpr size_t s_slab_size_classes[] = { 16, 32, 64, 128, 256, 512, 1024 };
+static_assert(sizeof(s_slab_size_classes) / sizeof(s_slab_size_classes[0]) == kmalloc_size_class_count);
+static constexpr size_t s_slab_span_size = 16 * KiB;
+static constexpr size_t s_slab_batch_bytes = 4 * KiB;
+static constexpr size_t s_slab_max_batch_size = 16;
+static constexpr size_t s_slab_max_processors = sizeof(u32) * 8;
+
+// Every slab object is preceded by a header word, just like heap allocations are
+// preceded by the Heap's AllocationHeader. The heap keeps a chunk count in there,
+// which never gets anywhere near this tag, so kfree() can tell the two apart.
+static constexpr size_t s_slab_header_tag = 0x51ab0000;
+static constexpr size_t s_slab_header_tag_mask = 0xffffff00;
+
+struct SlabHeader {
+    size_t tag_and_size_class;
+    u8 data[0];
+};
+
+struct FreeSlabObject {
+    FreeSlabObject* next;
+};
+
+struct SlabSizeClass {
+    SpinLock<u8> lock;
+    FreeSlabObject* freelist { nullptr };
+    size_t free_count { 0 };
+    size_t span_count { 0 };
+};
+
+struct SlabMagazine {
+    size_t count { 0 };
+    void* objects[s_slab_max_batch_size * 2];
+
+    // Per-CPU counters, summed up when someone asks for statistics.
+    size_t allocation_count { 0 };
+    size_t free_count { 0 };
+    size_t refill_count { 0 };
+    size_t drain_count { 0 };
+};
+
+struct SlabProcessorCache {
+    SlabMagazine magazines[kmalloc_size_class_count];
+};
+
+static SlabSizeClass s_slab_size_class_data[kmalloc_size_class_count];
+static SlabProcessorCache s_slab_processor_caches[s_slab_max_processors];
+
 static void kmalloc_allocate_backup_memory()
 {
     g_kmalloc_global->allocate_backup_memory();
@@ -232,6 +283,8 @@ UNMAP_AFTER_INIT void kmalloc_init()
     g_kmalloc_global = new (g_kmalloc_global_heap) KmallocGlobalHeap(kmalloc_pool_heap, sizeof(kmalloc_pool_heap));
 
     s_lock.initialize();
+    for (auto& data : s_slab_size_class_data)
+        data.lock.initialize();
 
     s_next_eternal_ptr = kmalloc_eternal_heap;
     s_end_of_eternal_range = s_next_eternal_ptr + sizeof(kmalloc_pool_heap);
@@ -249,16 +302,189 @@ void* kmalloc_eternal(size_t size)
     return ptr;
 }
 
-void* kmalloc(size_t size)
+ALWAYS_INLINE static Optional<size_t> slab_size_class_for_size(size_t size)
 {
-    ScopedSpinLock lock(s_lock);
-    ++g_kmalloc_call_count;
+    for (size_t i = 0; i < kmalloc_size_class_count; ++i) {
+        if (size <= s_slab_size_classes[i])
+            return i;
+    }
+    return {};
+}
+
+static constexpr size_t slab_batch_size(size_t size_class)
+{
+    return clamp(s_slab_batch_bytes / s_slab_size_classes[size_class], (size_t)4, s_slab_max_batch_size);
+}
+
+ALWAYS_INLINE static SlabHeader* slab_header_for(void* ptr)
+{
+    return (SlabHeader*)((u8*)ptr - sizeof(SlabHeader));
+}
+
+ALWAYS_INLINE static Optional<size_t> slab_size_class_of(void* ptr)
+{
+    auto tag_and_size_class = slab_header_for(ptr)->tag_and_size_class;
+    if ((tag_and_size_class & s_slab_header_tag_mask) != s_slab_header_tag)
+        return {};
+    return tag_and_size_class & ~s_slab_header_tag_mask;
+}
+
+// NOTE: Interrupts must be disabled, so that we can't be moved to another processor.
+ALWAYS_INLINE static SlabMagazine& current_slab_magazine(size_t size_class)
+{
+    auto cpu = Processor::id();
+    VERIFY(cpu < s_slab_max_processors);
+    return s_slab_processor_caches[cpu].magazines[size_class];
+}
+
+static void slab_refill(SlabMagazine& magazine, size_t size_class)
+{
+    auto& data = s_slab_size_class_data[size_class];
+    auto batch_size = slab_batch_size(size_class);
+    ++magazine.refill_count;
+
+    {
+        ScopedSpinLock lock(data.lock);
+        while (magazine.count < batch_size && data.freelist) {
+            auto* object = data.freelist;
+            data.freelist = object->next;
+            --data.free_count;
+            magazine.objects[magazine.count++] = object;
+        }
+    }
+    if (magazine.count)
+        return;
+
+    // Carve a new span. We don't hold the size class lock while doing so, since
+    // expanding the heap may end up calling back into kmalloc() with s_lock held.
+    u8* span;
+    {
+        ScopedSpinLock lock(s_lock);
+        span = (u8*)g_kmalloc_global->m_heap.allocate(s_slab_span_size);
+    }
+    if (!span)
+        PANIC("kmalloc: Out of memory (requested slab span for size class {})", s_slab_size_classes[size_class]);
+
+    size_t slot_size = sizeof(SlabHeader) + s_slab_size_classes[size_class];
+    size_t object_count = s_slab_span_size / slot_size;
+    FreeSlabObject* leftovers = nullptr;
+    FreeSlabObject* last_leftover = nullptr;
+    size_t leftover_count = 0;
+    for (size_t i = 0; i < object_count; ++i) {
+        auto* header = (SlabHeader*)(span + i * slot_size);
+        header->tag_and_size_class = s_slab_header_tag | size_class;
+        if (magazine.count < batch_size) {
+            magazine.objects[magazine.count++] = header->data;
+            continue;
+        }
+        auto* object = (FreeSlabObject*)header->data;
+        object->next = leftovers;
+        leftovers = object;
+        if (!last_leftover)
+            last_leftover = object;
+        ++leftover_count;
+    }
+
+    ScopedSpinLock lock(data.lock);
+    ++data.span_count;
+    if (!leftovers)
+        return;
+    last_leftover->next = data.freelist;
+    data.freelist = leftovers;
+    data.free_count += leftover_count;
+}
+
+static void slab_drain(SlabMagazine& magazine, size_t size_class)
+{
+    auto& data = s_slab_size_class_data[size_class];
+    auto batch_size = slab_batch_size(size_class);
+    ++magazine.drain_count;
+
+    // The magazine is used as a stack, so its bottom batch is what this processor freed the
+    // longest ago. That batch moves to the shared freelist of the size class, where any
+    // processor can refill from it; the top of the stack serves the next kmalloc() here.
+    ScopedSpinLock lock(data.lock);
+    for (size_t i = 0; i < batch_size; ++i) {
+        auto* object = (FreeSlabObject*)magazine.objects[i];
+        object->next = data.freelist;
+        data.freelist = object;
+    }
+    data.free_count += batch_size;
+    lock.unlock();
+
+    for (size_t i = batch_size; i < magazine.count; ++i)
+        magazine.objects[i - batch_size] = magazine.objects[i];
+    magazine.count -= batch_size;
+}
+
+static void* slab_allocate(size_t size_class)
+{
+    void* ptr;
+    {
+        InterruptDisabler disabler;
+        auto& magazine = current_slab_magazine(size_class);
+        if (!magazine.count)
+            slab_refill(magazine, size_class);
+        ptr = magazine.objects[--magazine.count];
+        ++magazine.allocation_count;
+    }
+    __builtin_memset(ptr, KMALLOC_SCRUB_BYTE, s_slab_size_classes[size_class]);
+    return ptr;
+}
+
+static void slab_deallocate(void* ptr, size_t size_class)
+{
+    VERIFY(size_class < kmalloc_size_class_count);
+    __builtin_memset(ptr, KFREE_SCRUB_BYTE, s_slab_size_classes[size_class]);
+
+    InterruptDisabler disabler;
+    auto& magazine = current_slab_magazine(size_class);
+    if (magazine.count == slab_batch_size(size_class) * 2)
+        slab_drain(magazine, size_class);
+    magazine.objects[magazine.count++] = ptr;
+    ++magazine.free_count;
+}
+
+void get_kmalloc_size_class_stats(kmalloc_size_class_stats (&stats)[kmalloc_size_class_count])
+{
+    for (size_t size_class = 0; size_class < kmalloc_size_class_count; ++size_class) {
+        auto& data = s_slab_size_class_data[size_class];
+        auto& class_stats = stats[size_class];
+        class_stats = {};
+        class_stats.size = s_slab_size_classes[size_class];
+        {
+            ScopedSpinLock lock(data.lock);
+            class_stats.span_count = data.span_count;
+            class_stats.free_objects = data.free_count;
+        }
+        class_stats.total_objects = class_stats.span_count * (s_slab_span_size / (sizeof(SlabHeader) + class_stats.size));
+
+        // The per-CPU numbers are read without synchronization, so they may be slightly stale.
+        for (auto& cache : s_slab_processor_caches) {
+            auto& magazine = cache.magazines[size_class];
+            class_stats.cached_objects += magazine.count;
+            class_stats.allocation_count += magazine.allocation_count;
+            class_stats.free_count += magazine.free_count;
+            class_stats.refill_count += magazine.refill_count;
+            class_stats.drain_count += magazine.drain_count;
+        }
+    }
+}
 
+void* kmalloc(size_t size)
+{
     if (g_dump_kmalloc_stacks && Kernel::g_kernel_symbols_available) {
+        ScopedSpinLock lock(s_lock);
         dbgln("kmalloc({})", size);
         Kernel::dump_backtrace();
     }
 
+    if (auto size_class = slab_size_class_for_size(size); size_class.has_value())
+        return slab_allocate(size_class.value());
+
+    ScopedSpinLock lock(s_lock);
+    ++g_kmalloc_call_count;
+
     void* ptr = g_kmalloc_global->m_heap.allocate(size);
     if (!ptr) {
         PANIC("kmalloc: Out of memory (requested size: {})", size);
@@ -272,6 +498,11 @@ void kfree(void* ptr)
     if (!ptr)
         return;
 
+    if (auto size_class = slab_size_class_of(ptr); size_class.has_value()) {
+        slab_deallocate(ptr, size_class.value());
+        return;
+    }
+
     ScopedSpinLock lock(s_lock);
     ++g_kfree_call_count;
 
@@ -280,6 +511,17 @@ void kfree(void* ptr)
 
 void* krealloc(void* ptr, size_t new_size)
 {
+    if (ptr) {
+        if (auto size_class = slab_size_class_of(ptr); size_class.has_value()) {
+            if (new_size <= s_slab_size_classes[size_class.value()])
+                return ptr;
+            void* new_ptr = kmalloc(new_size);
+            __builtin_memcpy(new_ptr, ptr, s_slab_size_classes[size_class.value()]);
+            slab_deallocate(ptr, size_class.value());
+            return new_ptr;
+        }
+    }
+
     ScopedSpinLock lock(s_lock);
     return g_kmalloc_global->m_heap.reallocate(ptr, new_size);
 }
@@ -302,4 +544,11 @@ void get_kmalloc_stats(kmalloc_stats& stats)
     stats.bytes_eternal = g_kmalloc_bytes_eternal;
     stats.kmalloc_call_count = g_kmalloc_call_count;
     stats.kfree_call_count = g_kfree_call_count;
+
+    for (auto& cache : s_slab_processor_caches) {
+        for (auto& magazine : cache.magazines) {
+            stats.kmalloc_call_count += magazine.allocation_count;
+            stats.kfree_call_count += magazine.free_count;
+        }
+    }
 }
@@ -55,6 +55,21 @@ struct kmalloc_stats {
 };
 void get_kmalloc_stats(kmalloc_stats&);
 
+static constexpr size_t kmalloc_size_class_count = 7;
+
+struct kmalloc_size_class_stats {
+    size_t size;
+    size_t span_count;
+    size_t total_objects;
+    size_t free_objects;
+    size_t cached_objects;
+    size_t allocation_count;
+    size_t free_count;
+    size_t refill_count;
+    size_t drain_count;
+};
+void get_kmalloc_size_class_stats(kmalloc_size_class_stats (&)[kmalloc_size_class_count]);
+
 extern bool g_dump_kmalloc_stacks;
 
 inline void* operator new(size_t, void* p) { return p; }
@@ -25,6 +25,7 @@
  */
 
 #include <AK/MACAddress.h>
+#include <Kernel/CommandLine.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Net/E1000NetworkAdapter.h>
 
@@ -55,6 +56,8 @@ namespace Kernel {
 #define REG_RADV 0x282C             // RX Int. Absolute Delay Timer
 #define REG_RSRPD 0x2C00            // RX Small Packet Detect Interrupt
 #define REG_TIPG 0x0410             // Transmit Inter Packet Gap
+#define REG_MPC 0x4010              // Missed Packets Count
+#define REG_RXCSUM 0x5000           // RX Checksum Control
 #define ECTRL_SLU 0x40              //set link up
 #define RCTL_EN (1 << 1)            // Receiver Enable
 #define RCTL_SBP (1 << 2)           // Store Bad Packets
@@ -111,6 +114,20 @@ namespace Kernel {
 #define TSTA_LC (1 << 2) // Late Collision
 #define LSTA_TU (1 << 3) // Transmit Underrun
 
+// Receive Descriptor Status and Errors
+
+#define RSTA_DD (1 << 0)    // Descriptor Done
+#define RSTA_IXSM (1 << 2)  // Ignore Checksum Indication
+#define RSTA_TCPCS (1 << 5) // TCP/UDP Checksum Calculated
+#define RSTA_IPCS (1 << 6)  // IPv4 Checksum Calculated
+#define RERR_TCPE (1 << 5)  // TCP/UDP Checksum Error
+#define RERR_IPE (1 << 6)   // IPv4 Checksum Error
+
+// RXCSUM Register
+
+#define RXCSUM_IPOFL (1 << 8) // IPv4 Checksum Offload Enable
+#define RXCSUM_TUOFL (1 << 9) // TCP/UDP Checksum Offload Enable
+
 // STATUS Register
 
 #define STATUS_FD 0x01
@@ -137,6 +154,12 @@ namespace Kernel {
 #define INTERRUPT_TXD_LOW (1 << 15)
 #define INTERRUPT_SRPD (1 << 16)
 
+// Everything that means there are received frames to pick up.
+#define RECEIVE_INTERRUPTS (INTERRUPT_RXT0 | INTERRUPT_RXO | INTERRUPT_RXDMT0)
+
+// Let the NIC coalesce interrupts so that we take at most this many per second.
+static constexpr u32 max_interrupts_per_second = 8000;
+
 // https://www.intel.com/content/dam/doc/manual/pci-pci-x-family-gbe-controllers-software-dev-manual.pdf Section 5.2
 static bool is_valid_device_id(u16 device_id)
 {
@@ -185,15 +208,22 @@ UNMAP_AFTER_INIT void E1000NetworkAdapter::detect()
         if (!is_valid_device_id(id.device_id))
             return;
         u8 irq = PCI::get_interrupt_line(address);
-        [[maybe_unused]] auto& unused = adopt(*new E1000NetworkAdapter(address, irq)).leak_ref();
+        auto adapter = adopt(*new E1000NetworkAdapter(address, irq));
+        if (!adapter->initialize()) {
+            dmesgln("E1000: Not enough memory for the descriptor rings of {}, ignoring it", address);
+            return;
+        }
+        [[maybe_unused]] auto& unused = adapter.leak_ref();
     });
 }
 
 UNMAP_AFTER_INIT E1000NetworkAdapter::E1000NetworkAdapter(PCI::Address address, u8 irq)
     : PCI::Device(address, irq)
     , m_io_base(PCI::get_BAR1(pci_address()) & ~1)
-    , m_rx_descriptors_region(MM.allocate_contiguous_kernel_region(page_round_up(sizeof(e1000_rx_desc) * number_of_rx_descriptors + 16), "E1000 RX", Region::Access::Read | Region::Access::Write))
-    , m_tx_descriptors_region(MM.allocate_contiguous_kernel_region(page_round_up(sizeof(e1000_tx_desc) * number_of_tx_descriptors + 16), "E1000 TX", Region::Access::Read | Region::Access::Write))
+    , m_rx_descriptor_count(kernel_command_line().e1000_rx_descriptor_count())
+    , m_tx_descriptor_count(kernel_command_line().e1000_tx_descriptor_count())
+    , m_rx_descriptors_region(MM.allocate_contiguous_kernel_region(page_round_up(sizeof(e1000_rx_desc) * m_rx_descriptor_count + 16), "E1000 RX", Region::Access::Read | Region::Access::Write))
+    , m_tx_descriptors_region(MM.allocate_contiguous_kernel_region(page_round_up(sizeof(e1000_tx_desc) * m_tx_descriptor_count + 16), "E1000 TX", Region::Access::Read | Region::Access::Write))
 {
     set_interface_name("e1k");
 
@@ -215,20 +245,32 @@ UNMAP_AFTER_INIT E1000NetworkAdapter::E1000NetworkAdapter(PCI::Address address,
     read_mac_address();
     const auto& mac = mac_address();
     dmesgln("E1000: MAC address: {}", mac.to_string());
+}
+
+UNMAP_AFTER_INIT bool E1000NetworkAdapter::initialize()
+{
+    dmesgln("E1000: {} RX descriptors, {} TX descriptors", m_rx_descriptor_count, m_tx_descriptor_count);
+    if (!m_rx_descriptors_region || !m_tx_descriptors_region)
+        return false;
 
     u32 flags = in32(REG_CTRL);
     out32(REG_CTRL, flags | ECTRL_SLU);
 
-    out32(REG_INTERRUPT_RATE, 6000); // Interrupt rate of 1.536 milliseconds
+    // The throttling interval is in units of 256 nanoseconds.
+    out32(REG_INTERRUPT_RATE, 1'000'000'000 / (max_interrupts_per_second * 256));
 
-    initialize_rx_descriptors();
-    initialize_tx_descriptors();
+    // Receiving is enabled last, so the NIC never DMAs into buffers we drop because we ran out of memory.
+    if (!initialize_tx_descriptors() || !initialize_rx_descriptors())
+        return false;
 
-    out32(REG_INTERRUPT_MASK_SET, 0x1f6dc);
-    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_RXT0);
+    out32(REG_RXCSUM, in32(REG_RXCSUM) | RXCSUM_IPOFL | RXCSUM_TUOFL);
+    set_offloads(Offload::TransmitChecksum | Offload::ReceiveChecksum);
+
+    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_TXDW | RECEIVE_INTERRUPTS);
     in32(REG_INTERRUPT_CAUSE_READ);
 
     enable_irq();
+    return true;
 }
 
 UNMAP_AFTER_INIT E1000NetworkAdapter::~E1000NetworkAdapter()
@@ -237,26 +279,27 @@ UNMAP_AFTER_INIT E1000NetworkAdapter::~E1000NetworkAdapter()
 
 void E1000NetworkAdapter::handle_irq(const RegisterState&)
 {
-    out32(REG_INTERRUPT_MASK_CLEAR, 0xffffffff);
-
     u32 status = in32(REG_INTERRUPT_CAUSE_READ);
+    did_handle_interrupt();
 
     m_entropy_source.add_random_event(status);
 
-    if (status & 4) {
+    if (status & INTERRUPT_LSC) {
         u32 flags = in32(REG_CTRL);
         out32(REG_CTRL, flags | ECTRL_SLU);
     }
-    if (status & 0x80) {
-        receive();
+    if (status & RECEIVE_INTERRUPTS) {
+        // Leave the receive ring to the network task until it has caught up with it.
+        out32(REG_INTERRUPT_MASK_CLEAR, RECEIVE_INTERRUPTS);
+        schedule_receive_poll();
     }
-    if (status & 0x10) {
-        // Threshold OK?
-    }
-
-    m_wait_queue.wake_all();
+    if (status & INTERRUPT_TXDW)
+        m_wait_queue.wake_all();
+}
 
-    out32(REG_INTERRUPT_MASK_SET, INTERRUPT_LSC | INTERRUPT_RXT0 | INTERRUPT_RXO);
+void E1000NetworkAdapter::enable_receive_interrupts()
+{
+    out32(REG_INTERRUPT_MASK_SET, RECEIVE_INTERRUPTS);
 }
 
 UNMAP_AFTER_INIT void E1000NetworkAdapter::detect_eeprom()
@@ -313,47 +356,61 @@ bool E1000NetworkAdapter::link_up()
     return (in32(REG_STATUS) & STATUS_LU);
 }
 
-UNMAP_AFTER_INIT void E1000NetworkAdapter::initialize_rx_descriptors()
+UNMAP_AFTER_INIT bool E1000NetworkAdapter::initialize_rx_descriptors()
 {
+    // Every descriptor holds on to a buffer, and about as many again can be on their way up the
+    // stack before poll_receive() has to fall back to copying frames out of the ring.
+    if (!PacketBuffer::try_grow_dma_pool(2 * m_rx_descriptor_count))
+        return false;
+
     auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
-    for (size_t i = 0; i < number_of_rx_descriptors; ++i) {
+    m_rx_buffers.ensure_capacity(m_rx_descriptor_count);
+    for (size_t i = 0; i < m_rx_descriptor_count; ++i) {
         auto& descriptor = rx_descriptors[i];
-        auto region = MM.allocate_contiguous_kernel_region(8192, "E1000 RX buffer", Region::Access::Read | Region::Access::Write);
-        VERIFY(region);
-        m_rx_buffers_regions.append(region.release_nonnull());
-        descriptor.addr = m_rx_buffers_regions[i].physical_page(0)->paddr().get();
+        auto buffer = PacketBuffer::try_create_for_dma();
+        if (!buffer)
+            return false;
+        descriptor.addr = buffer->physical_address().get();
         descriptor.status = 0;
+        m_rx_buffers.unchecked_append(move(buffer));
     }
 
     out32(REG_RXDESCLO, m_rx_descriptors_region->physical_page(0)->paddr().get());
     out32(REG_RXDESCHI, 0);
-    out32(REG_RXDESCLEN, number_of_rx_descriptors * sizeof(e1000_rx_desc));
+    out32(REG_RXDESCLEN, m_rx_descriptor_count * sizeof(e1000_rx_desc));
     out32(REG_RXDESCHEAD, 0);
-    out32(REG_RXDESCTAIL, number_of_rx_descriptors - 1);
+    out32(REG_RXDESCTAIL, m_rx_descriptor_count - 1);
 
-    out32(REG_RCTRL, RCTL_EN | RCTL_SBP | RCTL_UPE | RCTL_MPE | RCTL_LBM_NONE | RTCL_RDMTS_HALF | RCTL_BAM | RCTL_SECRC | RCTL_BSIZE_8192);
+    out32(REG_RCTRL, RCTL_EN | RCTL_SBP | RCTL_UPE | RCTL_MPE | RCTL_LBM_NONE | RTCL_RDMTS_HALF | RCTL_BAM | RCTL_SECRC | RCTL_BSIZE_2048);
+    return true;
 }
 
-UNMAP_AFTER_INIT void E1000NetworkAdapter::initialize_tx_descriptors()
+UNMAP_AFTER_INIT bool E1000NetworkAdapter::initialize_tx_descriptors()
 {
+    // A buffer never straddles a page boundary, so the pages don't have to be physically contiguous.
+    static_assert(PAGE_SIZE % tx_buffer_size == 0);
+    constexpr size_t tx_buffers_per_page = PAGE_SIZE / tx_buffer_size;
+
     auto* tx_descriptors = (e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr();
-    for (size_t i = 0; i < number_of_tx_descriptors; ++i) {
+    m_tx_buffers_region = MM.allocate_kernel_region(page_round_up(m_tx_descriptor_count * tx_buffer_size), "E1000 TX buffers", Region::Access::Read | Region::Access::Write, AllocationStrategy::AllocateNow);
+    if (!m_tx_buffers_region)
+        return false;
+    for (size_t i = 0; i < m_tx_descriptor_count; ++i) {
         auto& descriptor = tx_descriptors[i];
-        auto region = MM.allocate_contiguous_kernel_region(8192, "E1000 TX buffer", Region::Access::Read | Region::Access::Write);
-        VERIFY(region);
-        m_tx_buffers_regions.append(region.release_nonnull());
-        descriptor.addr = m_tx_buffers_regions[i].physical_page(0)->paddr().get();
+        auto page_address = m_tx_buffers_region->physical_page(i / tx_buffers_per_page)->paddr();
+        descriptor.addr = page_address.offset((i % tx_buffers_per_page) * tx_buffer_size).get();
         descriptor.cmd = 0;
     }
 
     out32(REG_TXDESCLO, m_tx_descriptors_region->physical_page(0)->paddr().get());
     out32(REG_TXDESCHI, 0);
-    out32(REG_TXDESCLEN, number_of_tx_descriptors * sizeof(e1000_tx_desc));
+    out32(REG_TXDESCLEN, m_tx_descriptor_count * sizeof(e1000_tx_desc));
     out32(REG_TXDESCHEAD, 0);
     out32(REG_TXDESCTAIL, 0);
 
     out32(REG_TCTRL, in32(REG_TCTRL) | TCTL_EN | TCTL_PSP);
     out32(REG_TIPG, 0x0060200A);
+    return true;
 }
 
 void E1000NetworkAdapter::out8(u16 address, u8 data)
@@ -415,51 +472,92 @@ u32 E1000NetworkAdapter::in32(u16 address)
 
 void E1000NetworkAdapter::send_raw(ReadonlyBytes payload)
 {
-    disable_irq();
-    size_t tx_current = in32(REG_TXDESCTAIL) % number_of_tx_descriptors;
+    transmit(payload, {});
+}
+
+void E1000NetworkAdapter::send_raw_with_checksum(ReadonlyBytes payload, size_t checksum_start, size_t checksum_offset)
+{
+    // The legacy descriptor format only has room for 8-bit offsets.
+    VERIFY(checksum_start <= NumericLimits<u8>::max() && checksum_offset <= NumericLimits<u8>::max());
+    transmit(payload, ChecksumOffload { (u8)checksum_start, (u8)checksum_offset });
+}
+
+void E1000NetworkAdapter::transmit(ReadonlyBytes payload, Optional<ChecksumOffload> checksum_offload)
+{
     dbgln_if(E1000_DEBUG, "E1000: Sending packet ({} bytes)", payload.size());
+    VERIFY(payload.size() <= tx_buffer_size);
     auto* tx_descriptors = (e1000_tx_desc*)m_tx_descriptors_region->vaddr().as_ptr();
-    auto& descriptor = tx_descriptors[tx_current];
-    VERIFY(payload.size() <= 8192);
-    auto* vptr = (void*)m_tx_buffers_regions[tx_current].vaddr().as_ptr();
-    memcpy(vptr, payload.data(), payload.size());
-    descriptor.length = payload.size();
-    descriptor.status = 0;
-    descriptor.cmd = CMD_EOP | CMD_IFCS | CMD_RS;
-    dbgln_if(E1000_DEBUG, "E1000: Using tx descriptor {} (head is at {})", tx_current, in32(REG_TXDESCHEAD));
-    tx_current = (tx_current + 1) % number_of_tx_descriptors;
-    cli();
-    enable_irq();
-    out32(REG_TXDESCTAIL, tx_current);
     for (;;) {
-        if (descriptor.status) {
-            sti();
-            break;
+        {
+            ScopedSpinLock lock(m_tx_lock);
+            // The NIC owns everything from the head up to the tail. If advancing the tail would
+            // make it catch up with the head, the ring is full.
+            size_t next = (m_tx_next + 1) % m_tx_descriptor_count;
+            if (next != in32(REG_TXDESCHEAD) % m_tx_descriptor_count) {
+                auto& descriptor = tx_descriptors[m_tx_next];
+                memcpy(m_tx_buffers_region->vaddr().offset(m_tx_next * tx_buffer_size).as_ptr(), payload.data(), payload.size());
+                descriptor.length = payload.size();
+                descriptor.status = 0;
+                u8 cmd = CMD_EOP | CMD_IFCS | CMD_RS;
+                if (checksum_offload.has_value()) {
+                    descriptor.css = checksum_offload->start;
+                    descriptor.cso = checksum_offload->offset;
+                    cmd |= CMD_IC;
+                } else {
+                    descriptor.css = 0;
+                    descriptor.cso = 0;
+                }
+                descriptor.cmd = cmd;
+                dbgln_if(E1000_DEBUG, "E1000: Using tx descriptor {} (head is at {})", m_tx_next, in32(REG_TXDESCHEAD));
+                m_tx_next = next;
+                out32(REG_TXDESCTAIL, m_tx_next);
+                return;
+            }
         }
+        // Wait for the NIC to signal that it's done with some descriptors.
         m_wait_queue.wait_forever("E1000NetworkAdapter");
     }
-    dbgln_if(E1000_DEBUG, "E1000: Sent packet, status is now {:#02x}!", (u8)descriptor.status);
 }
 
-void E1000NetworkAdapter::receive()
+size_t E1000NetworkAdapter::poll_receive(size_t budget)
 {
-    auto* rx_descriptors = (e1000_tx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
-    u32 rx_current;
-    for (;;) {
-        rx_current = in32(REG_RXDESCTAIL) % number_of_rx_descriptors;
-        if (rx_current == (in32(REG_RXDESCHEAD) % number_of_rx_descriptors))
-            return;
-        rx_current = (rx_current + 1) % number_of_rx_descriptors;
-        if (!(rx_descriptors[rx_current].status & 1))
+    // Frames the NIC had to drop because the ring was full.
+    if (u32 missed = in32(REG_MPC))
+        did_drop_packets(missed);
+
+    auto* rx_descriptors = (e1000_rx_desc*)m_rx_descriptors_region->vaddr().as_ptr();
+    size_t received = 0;
+    while (received < budget) {
+        u32 rx_current = in32(REG_RXDESCTAIL) % m_rx_descriptor_count;
+        if (rx_current == (in32(REG_RXDESCHEAD) % m_rx_descriptor_count))
+            break;
+        rx_current = (rx_current + 1) % m_rx_descriptor_count;
+        auto& descriptor = rx_descriptors[rx_current];
+        u8 status = descriptor.status;
+        if (!(status & RSTA_DD))
             break;
-        auto* buffer = m_rx_buffers_regions[rx_current].vaddr().as_ptr();
-        u16 length = rx_descriptors[rx_current].length;
-        VERIFY(length <= 8192);
-        dbgln_if(E1000_DEBUG, "E1000: Received 1 packet @ {:p} ({} bytes)", buffer, length);
-        did_receive({ buffer, length });
-        rx_descriptors[rx_current].status = 0;
+        auto& buffer = m_rx_buffers[rx_current];
+        u16 length = descriptor.length;
+        VERIFY(length <= 2048);
+        dbgln_if(E1000_DEBUG, "E1000: Received 1 packet @ {:p} ({} bytes)", buffer->data(), length);
+        buffer->set_size(length);
+        // Anything the NIC couldn't vouch for, including bad checksums, is left for the stack to check.
+        bool checksum_verified = !(status & RSTA_IXSM) && (status & RSTA_IPCS) && (status & RSTA_TCPCS) && !(descriptor.errors & (RERR_IPE | RERR_TCPE));
+        buffer->set_checksum_verified(checksum_verified);
+        // Hand the buffer the frame was received into up the stack and give the descriptor a fresh one.
+        // If the pool has run dry, fall back to copying the frame out so the descriptor keeps its buffer.
+        if (auto replacement = PacketBuffer::try_create_for_dma()) {
+            did_receive_packet(buffer.release_nonnull());
+            buffer = move(replacement);
+            descriptor.addr = buffer->physical_address().get();
+        } else {
+            did_receive(buffer->bytes());
+        }
+        descriptor.status = 0;
         out32(REG_RXDESCTAIL, rx_current);
+        ++received;
     }
+    return received;
 }
 
 }
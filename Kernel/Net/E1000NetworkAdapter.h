@@ -26,8 +26,8 @@
 
 #pragma once
 
-#include <AK/NonnullOwnPtrVector.h>
 #include <AK/OwnPtr.h>
+#include <AK/Vector.h>
 #include <Kernel/IO.h>
 #include <Kernel/Interrupts/IRQHandler.h>
 #include <Kernel/Net/NetworkAdapter.h>
@@ -46,6 +46,7 @@ public:
     virtual ~E1000NetworkAdapter() override;
 
     virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_checksum(ReadonlyBytes, size_t checksum_start, size_t checksum_offset) override;
     virtual bool link_up() override;
 
     virtual const char* purpose() const override { return class_name(); }
@@ -53,6 +54,8 @@ public:
 private:
     virtual void handle_irq(const RegisterState&) override;
     virtual const char* class_name() const override { return "E1000NetworkAdapter"; }
+    virtual size_t poll_receive(size_t budget) override;
+    virtual void enable_receive_interrupts() override;
 
     struct [[gnu::packed]] e1000_rx_desc {
         volatile uint64_t addr { 0 };
@@ -80,8 +83,9 @@ private:
     void write_command(u16 address, u32);
     u32 read_command(u16 address);
 
-    void initialize_rx_descriptors();
-    void initialize_tx_descriptors();
+    bool initialize();
+    bool initialize_rx_descriptors();
+    bool initialize_tx_descriptors();
 
     void out8(u16 address, u8);
     void out16(u16 address, u16);
@@ -90,23 +94,32 @@ private:
     u16 in16(u16 address);
     u32 in32(u16 address);
 
-    void receive();
+    struct ChecksumOffload {
+        u8 start { 0 };
+        u8 offset { 0 };
+    };
+    void transmit(ReadonlyBytes, Optional<ChecksumOffload>);
+
+    // Large enough for any frame we send, as we don't do jumbo frames.
+    static constexpr size_t tx_buffer_size = 2048;
 
     IOAddress m_io_base;
     VirtualAddress m_mmio_base;
+    size_t m_rx_descriptor_count { 0 };
+    size_t m_tx_descriptor_count { 0 };
     OwnPtr<Region> m_rx_descriptors_region;
     OwnPtr<Region> m_tx_descriptors_region;
-    NonnullOwnPtrVector<Region> m_rx_buffers_regions;
-    NonnullOwnPtrVector<Region> m_tx_buffers_regions;
+    // The NIC DMAs received frames straight into these, and they are handed up the stack as they are.
+    Vector<RefPtr<PacketBuffer>> m_rx_buffers;
+    OwnPtr<Region> m_tx_buffers_region;
+    SpinLock<u8> m_tx_lock;
+    size_t m_tx_next { 0 };
     OwnPtr<Region> m_mmio_region;
     u8 m_interrupt_line { 0 };
     bool m_has_eeprom { false };
     bool m_use_mmio { false };
     EntropySource m_entropy_source;
 
-    static const size_t number_of_rx_descriptors = 32;
-    static const size_t number_of_tx_descriptors = 8;
-
     WaitQueue m_wait_queue;
 };
 }
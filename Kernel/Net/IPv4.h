@@ -31,6 +31,7 @@
 #include <AK/IPv4Address.h>
 #include <AK/String.h>
 #include <AK/Types.h>
+#include <Kernel/Net/InternetChecksum.h>
 
 namespace Kernel {
 
@@ -126,17 +127,26 @@ static_assert(sizeof(IPv4Packet) == 20);
 
 inline NetworkOrdered<u16> internet_checksum(const void* ptr, size_t count)
 {
-    u32 checksum = 0;
-    auto* w = (const u16*)ptr;
-    while (count > 1) {
-        checksum += AK::convert_between_host_and_network_endian(*w++);
-        if (checksum & 0x80000000)
-            checksum = (checksum & 0xffff) | (checksum >> 16);
-        count -= 2;
-    }
-    while (checksum >> 16)
-        checksum = (checksum & 0xffff) + (checksum >> 16);
-    return ~checksum & 0xffff;
+    InternetChecksum checksum;
+    checksum.add(ptr, count);
+    return checksum.finish();
+}
+
+// Starts off a TCP or UDP checksum with the IPv4 pseudo-header (RFC 793, RFC 768).
+inline InternetChecksum ipv4_pseudo_header_checksum(const IPv4Address& source, const IPv4Address& destination, IPv4Protocol protocol, u16 length)
+{
+    struct [[gnu::packed]] PseudoHeader {
+        IPv4Address source;
+        IPv4Address destination;
+        u8 zero;
+        u8 protocol;
+        NetworkOrdered<u16> length;
+    };
+    PseudoHeader pseudo_header { source, destination, 0, (u8)protocol, length };
+
+    InternetChecksum checksum;
+    checksum.add(&pseudo_header, sizeof(pseudo_header));
+    return checksum;
 }
 
 }
@@ -70,9 +70,6 @@ IPv4Socket::IPv4Socket(int type, int protocol)
 {
     dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}) created with type={}, protocol={}", this, type, protocol);
     m_buffer_mode = type == SOCK_STREAM ? BufferMode::Bytes : BufferMode::Packets;
-    if (m_buffer_mode == BufferMode::Bytes) {
-        m_scratch_buffer = KBuffer::create_with_size(65536);
-    }
     LOCKER(all_sockets().lock());
     all_sockets().resource().set(this);
 }
@@ -261,9 +258,20 @@ KResultOr<size_t> IPv4Socket::receive_byte_buffered(FileDescription& description
     }
 
     VERIFY(!m_receive_buffer.is_empty());
-    int nreceived = m_receive_buffer.read(buffer, buffer_length);
+    size_t nreceived = 0;
+    while (nreceived < buffer_length && !m_receive_buffer.is_empty()) {
+        auto& packet = *m_receive_buffer.first();
+        size_t chunk_size = min(packet.size(), buffer_length - nreceived);
+        if (!buffer.write(packet.data(), nreceived, chunk_size))
+            return nreceived ? KResultOr<size_t>(nreceived) : KResult(EFAULT);
+        packet.pull(chunk_size);
+        nreceived += chunk_size;
+        m_receive_buffer_bytes -= chunk_size;
+        if (packet.size() == 0)
+            m_receive_buffer.take_first();
+    }
     if (nreceived > 0)
-        Thread::current()->did_ipv4_socket_read((size_t)nreceived);
+        Thread::current()->did_ipv4_socket_read(nreceived);
 
     set_can_read(!m_receive_buffer.is_empty());
     return nreceived;
@@ -289,11 +297,11 @@ KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& descripti
 
             dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}): recvfrom without blocking {} bytes, packets in queue: {}",
                 this,
-                packet.data.value().size(),
+                packet.data->size(),
                 m_receive_queue.size());
         }
     }
-    if (!packet.data.has_value()) {
+    if (!packet.data) {
         if (protocol_is_disconnected()) {
             dbgln("IPv4Socket({}) is protocol-disconnected, returning 0 in recvfrom!", this);
             return 0;
@@ -318,12 +326,12 @@ KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& descripti
 
         dbgln_if(IPV4_SOCKET_DEBUG, "IPv4Socket({}): recvfrom with blocking {} bytes, packets in queue: {}",
             this,
-            packet.data.value().size(),
+            packet.data->size(),
             m_receive_queue.size());
     }
-    VERIFY(packet.data.has_value());
+    VERIFY(packet.data);
 
-    packet_timestamp = packet.timestamp;
+    packet_timestamp = packet.data->timestamp();
 
     if (addr) {
         dbgln_if(IPV4_SOCKET_DEBUG, "Incoming packet is from: {}:{}", packet.peer_address, packet.peer_port);
@@ -343,13 +351,13 @@ KResultOr<size_t> IPv4Socket::receive_packet_buffered(FileDescription& descripti
     }
 
     if (type() == SOCK_RAW) {
-        size_t bytes_written = min(packet.data.value().size(), buffer_length);
-        if (!buffer.write(packet.data.value().data(), bytes_written))
+        size_t bytes_written = min(packet.data->size(), buffer_length);
+        if (!buffer.write(packet.data->data(), bytes_written))
             return EFAULT;
         return bytes_written;
     }
 
-    return protocol_receive(ReadonlyBytes { packet.data.value().data(), packet.data.value().size() }, buffer, buffer_length, flags);
+    return protocol_receive(packet.data->bytes(), buffer, buffer_length, flags);
 }
 
 KResultOr<size_t> IPv4Socket::recvfrom(FileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*> user_addr, Userspace<socklen_t*> user_addr_length, Time& packet_timestamp)
@@ -375,36 +383,39 @@ KResultOr<size_t> IPv4Socket::recvfrom(FileDescription& description, UserOrKerne
     return nreceived;
 }
 
-bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port, KBuffer&& packet, const Time& packet_timestamp)
+size_t IPv4Socket::receive_buffer_space() const
+{
+    if (m_receive_buffer.size() >= max_receive_buffer_packets)
+        return 0;
+    return receive_buffer_size - m_receive_buffer_bytes;
+}
+
+bool IPv4Socket::did_receive(const IPv4Address& source_address, u16 source_port, NonnullRefPtr<PacketBuffer> packet)
 {
     LOCKER(lock());
 
     if (is_shut_down_for_reading())
         return false;
 
-    auto packet_size = packet.size();
+    auto packet_size = packet->size();
 
     if (buffer_mode() == BufferMode::Bytes) {
-        size_t space_in_receive_buffer = m_receive_buffer.space_for_writing();
-        if (packet_size > space_in_receive_buffer) {
+        if (packet_size > receive_buffer_space()) {
             dbgln("IPv4Socket({}): did_receive refusing packet since buffer is full.", this);
             VERIFY(m_can_read);
             return false;
         }
-        auto scratch_buffer = UserOrKernelBuffer::for_kernel_buffer(m_scratch_buffer.value().data());
-        auto nreceived_or_error = protocol_receive(ReadonlyBytes { packet.data(), packet.size() }, scratch_buffer, m_scratch_buffer.value().size(), 0);
-        if (nreceived_or_error.is_error())
-            return false;
-        ssize_t nwritten = m_receive_buffer.write(scratch_buffer, nreceived_or_error.value());
-        if (nwritten < 0)
-            return false;
-        set_can_read(!m_receive_buffer.is_empty());
+        if (packet_size == 0)
+            return true;
+        m_receive_buffer.append(move(packet));
+        m_receive_buffer_bytes += packet_size;
+        set_can_read(true);
     } else {
         if (m_receive_queue.size() > 2000) {
             dbgln("IPv4Socket({}): did_receive refusing packet since queue is full.", this);
             return false;
         }
-        m_receive_queue.append({ source_address, source_port, packet_timestamp, move(packet) });
+        m_receive_queue.append({ source_address, source_port, move(packet) });
         set_can_read(true);
     }
     m_bytes_received += packet_size;
@@ -455,10 +466,10 @@ String IPv4Socket::absolute_path(const FileDescription&) const
     return builder.to_string();
 }
 
-KResult IPv4Socket::setsockopt(int level, int option, Userspace<const void*> user_value, socklen_t user_value_size)
+KResult IPv4Socket::setsockopt(FileDescription& description, int level, int option, Userspace<const void*> user_value, socklen_t user_value_size)
 {
     if (level != IPPROTO_IP)
-        return Socket::setsockopt(level, option, user_value, user_value_size);
+        return Socket::setsockopt(description, level, option, user_value, user_value_size);
 
     switch (option) {
     case IP_TTL: {
@@ -28,11 +28,11 @@
 
 #include <AK/HashMap.h>
 #include <AK/SinglyLinkedListWithCount.h>
-#include <Kernel/DoubleBuffer.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/Lock.h>
 #include <Kernel/Net/IPv4.h>
 #include <Kernel/Net/IPv4SocketTuple.h>
+#include <Kernel/Net/PacketBuffer.h>
 #include <Kernel/Net/Socket.h>
 
 namespace Kernel {
@@ -58,12 +58,14 @@ public:
     virtual bool can_write(const FileDescription&, size_t) const override;
     virtual KResultOr<size_t> sendto(FileDescription&, const UserOrKernelBuffer&, size_t, int, Userspace<const sockaddr*>, socklen_t) override;
     virtual KResultOr<size_t> recvfrom(FileDescription&, UserOrKernelBuffer&, size_t, int flags, Userspace<sockaddr*>, Userspace<socklen_t*>, Time&) override;
-    virtual KResult setsockopt(int level, int option, Userspace<const void*>, socklen_t) override;
+    virtual KResult setsockopt(FileDescription&, int level, int option, Userspace<const void*>, socklen_t) override;
     virtual KResult getsockopt(FileDescription&, int level, int option, Userspace<void*>, Userspace<socklen_t*>) override;
 
     virtual int ioctl(FileDescription&, unsigned request, FlatPtr arg) override;
 
-    bool did_receive(const IPv4Address& peer_address, u16 peer_port, KBuffer&&, const Time&);
+    // In packet mode, `packet` is the whole IPv4 packet; in byte mode, it is just the stream payload.
+    // Either way the buffer is queued by reference, so it must not be modified afterwards.
+    bool did_receive(const IPv4Address& peer_address, u16 peer_port, NonnullRefPtr<PacketBuffer> packet);
 
     const IPv4Address& local_address() const { return m_local_address; }
     u16 local_port() const { return m_local_port; }
@@ -105,6 +107,12 @@ protected:
     void set_local_address(IPv4Address address) { m_local_address = address; }
     void set_peer_address(IPv4Address address) { m_peer_address = address; }
 
+    static constexpr size_t receive_buffer_size = 64 * KiB;
+    static constexpr size_t max_receive_buffer_packets = 256;
+
+    size_t receive_buffer_space() const;
+    size_t receive_buffer_capacity() const { return receive_buffer_size; }
+
 private:
     virtual bool is_ipv4() const override { return true; }
 
@@ -119,13 +127,14 @@ private:
     struct ReceivedPacket {
         IPv4Address peer_address;
         u16 peer_port;
-        Time timestamp;
-        Optional<KBuffer> data;
+        RefPtr<PacketBuffer> data;
     };
 
     SinglyLinkedListWithCount<ReceivedPacket> m_receive_queue;
 
-    DoubleBuffer m_receive_buffer;
+    // Byte mode: payloads waiting to be read, with whatever has been read already pulled off the front.
+    SinglyLinkedListWithCount<NonnullRefPtr<PacketBuffer>> m_receive_buffer;
+    size_t m_receive_buffer_bytes { 0 };
 
     u16 m_local_port { 0 };
     u16 m_peer_port { 0 };
@@ -137,8 +146,6 @@ private:
     bool m_can_read { false };
 
     BufferMode m_buffer_mode { BufferMode::Packets };
-
-    Optional<KBuffer> m_scratch_buffer;
 };
 
 }
@@ -27,7 +27,6 @@
 #pragma once
 
 #include <AK/HashMap.h>
-#include <Kernel/DoubleBuffer.h>
 #include <Kernel/KBuffer.h>
 #include <Kernel/Lock.h>
 #include <Kernel/Net/IPv4.h>
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Endian.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// The ones' complement sum used by IPv4, ICMP, TCP and UDP (RFC 1071).
+//
+// Data is summed in 32-bit words into a 64-bit accumulator, which can't overflow for anything
+// packet-sized, so the carries are only folded back in once, at the very end. The sum is kept
+// in memory byte order, which RFC 1071 allows as long as the result goes back the same way.
+class InternetChecksum {
+public:
+    InternetChecksum() = default;
+
+    void add(ReadonlyBytes bytes)
+    {
+        static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "InternetChecksum assumes a little-endian host");
+
+        auto* data = bytes.data();
+        size_t size = bytes.size();
+        if (!size)
+            return;
+
+        // The previous chunk ended halfway through a 16-bit word, so this byte completes it.
+        if (m_odd_length) {
+            m_sum += (u64)*data++ << 8;
+            --size;
+            m_odd_length = false;
+        }
+
+        auto* words = (const u32*)data;
+        u64 sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+        for (; size >= 4 * sizeof(u32); size -= 4 * sizeof(u32), words += 4) {
+            sum0 += words[0];
+            sum1 += words[1];
+            sum2 += words[2];
+            sum3 += words[3];
+        }
+        for (; size >= sizeof(u32); size -= sizeof(u32))
+            sum0 += *words++;
+        m_sum += sum0 + sum1 + sum2 + sum3;
+
+        data = (const u8*)words;
+        if (size >= sizeof(u16)) {
+            m_sum += *(const u16*)data;
+            data += sizeof(u16);
+            size -= sizeof(u16);
+        }
+        if (size) {
+            m_sum += *data;
+            m_odd_length = true;
+        }
+    }
+
+    void add(const void* data, size_t size) { add(ReadonlyBytes { (const u8*)data, size }); }
+
+    // The sum folded into 16 bits, but not complemented. This is what goes into the checksum
+    // field when the rest of the sum is left to the network adapter.
+    NetworkOrdered<u16> folded() const { return from_memory_order(fold()); }
+
+    // The checksum as it goes on the wire. Summing data that includes a valid checksum gives 0.
+    NetworkOrdered<u16> finish() const { return from_memory_order(~fold()); }
+
+private:
+    u16 fold() const
+    {
+        u64 sum = m_sum;
+        sum = (sum & 0xffffffff) + (sum >> 32);
+        sum = (sum & 0xffffffff) + (sum >> 32);
+        sum = (sum & 0xffff) + (sum >> 16);
+        sum = (sum & 0xffff) + (sum >> 16);
+        return sum;
+    }
+
+    static NetworkOrdered<u16> from_memory_order(u16 value)
+    {
+        return AK::convert_between_host_and_network_endian(value);
+    }
+
+    u64 m_sum { 0 };
+    bool m_odd_length { false };
+};
+
+}
@@ -274,6 +274,18 @@ bool LocalSocket::can_write(const FileDescription& description, size_t) const
     return false;
 }
 
+size_t LocalSocket::space_for_writing(const FileDescription& description) const
+{
+    if (!has_attached_peer(description))
+        return 0;
+    auto role = this->role(description);
+    if (role == Role::Accepted)
+        return m_for_client.space_for_writing();
+    if (role == Role::Connected)
+        return m_for_server.space_for_writing();
+    return 0;
+}
+
 KResultOr<size_t> LocalSocket::sendto(FileDescription& description, const UserOrKernelBuffer& data, size_t data_size, int, Userspace<const sockaddr*>, socklen_t)
 {
     if (!has_attached_peer(description))
@@ -287,7 +299,7 @@ KResultOr<size_t> LocalSocket::sendto(FileDescription& description, const UserOr
     return nwritten;
 }
 
-DoubleBuffer* LocalSocket::receive_buffer_for(FileDescription& description)
+RingBuffer* LocalSocket::receive_buffer_for(FileDescription& description)
 {
     auto role = this->role(description);
     if (role == Role::Accepted)
@@ -297,7 +309,7 @@ DoubleBuffer* LocalSocket::receive_buffer_for(FileDescription& description)
     return nullptr;
 }
 
-DoubleBuffer* LocalSocket::send_buffer_for(FileDescription& description)
+RingBuffer* LocalSocket::send_buffer_for(FileDescription& description)
 {
     auto role = this->role(description);
     if (role == Role::Connected)
@@ -375,9 +387,20 @@ KResult LocalSocket::getsockopt(FileDescription& description, int level, int opt
 
     switch (option) {
     case SO_SNDBUF:
-        TODO();
-    case SO_RCVBUF:
-        TODO();
+    case SO_RCVBUF: {
+        if (size < sizeof(int))
+            return EINVAL;
+        auto* buffer = option == SO_SNDBUF ? send_buffer_for(description) : receive_buffer_for(description);
+        if (!buffer)
+            return ENOTCONN;
+        int capacity = buffer->capacity();
+        if (!copy_to_user(static_ptr_cast<int*>(value), &capacity))
+            return EFAULT;
+        size = sizeof(int);
+        if (!copy_to_user(value_size, &size))
+            return EFAULT;
+        return KSuccess;
+    }
     case SO_PEERCRED: {
         if (size < sizeof(ucred))
             return EINVAL;
@@ -408,6 +431,24 @@ KResult LocalSocket::getsockopt(FileDescription& description, int level, int opt
     }
 }
 
+KResult LocalSocket::setsockopt(FileDescription& description, int level, int option, Userspace<const void*> user_value, socklen_t user_value_size)
+{
+    if (level != SOL_SOCKET || (option != SO_SNDBUF && option != SO_RCVBUF))
+        return Socket::setsockopt(description, level, option, user_value, user_value_size);
+
+    if (user_value_size != sizeof(int))
+        return EINVAL;
+    int capacity;
+    if (!copy_from_user(&capacity, static_ptr_cast<const int*>(user_value)))
+        return EFAULT;
+    if (capacity < 0)
+        return EINVAL;
+    auto* buffer = option == SO_SNDBUF ? send_buffer_for(description) : receive_buffer_for(description);
+    if (!buffer)
+        return ENOTCONN;
+    return buffer->set_capacity(capacity);
+}
+
 KResult LocalSocket::chmod(FileDescription&, mode_t mode)
 {
     if (m_file)
@@ -39,6 +39,7 @@ public:
     virtual ~LoopbackAdapter() override;
 
     virtual void send_raw(ReadonlyBytes) override;
+    virtual void send_raw_with_checksum(ReadonlyBytes, size_t checksum_start, size_t checksum_offset) override;
     virtual const char* class_name() const override { return "LoopbackAdapter"; }
 };
 
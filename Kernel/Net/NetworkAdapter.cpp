@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/HashFunctions.h>
 #include <AK/HashTable.h>
 #include <AK/Singleton.h>
 #include <AK/StringBuilder.h>
@@ -107,28 +108,62 @@ KResult NetworkAdapter::send_ipv4(const MACAddress& destination_mac, const IPv4A
     if (ipv4_packet_size > mtu())
         return send_ipv4_fragmented(destination_mac, destination_ipv4, protocol, payload, payload_size, ttl);
 
-    size_t ethernet_frame_size = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet) + payload_size;
-    auto buffer = ByteBuffer::create_zeroed(ethernet_frame_size);
-    auto& eth = *(EthernetFrameHeader*)buffer.data();
-    eth.set_source(mac_address());
-    eth.set_destination(destination_mac);
-    eth.set_ether_type(EtherType::IPv4);
-    auto& ipv4 = *(IPv4Packet*)eth.payload();
+    auto packet = PacketBuffer::try_create(payload_size);
+    if (!packet)
+        return ENOMEM;
+    if (!payload.read(packet->data(), payload_size))
+        return EFAULT;
+    return send_ipv4(destination_mac, destination_ipv4, protocol, *packet, ttl);
+}
+
+KResult NetworkAdapter::send_ipv4(const MACAddress& destination_mac, const IPv4Address& destination_ipv4, IPv4Protocol protocol, PacketBuffer& packet, u8 ttl)
+{
+    size_t payload_size = packet.size();
+    size_t ipv4_packet_size = sizeof(IPv4Packet) + payload_size;
+    bool fits_in_one_frame = ipv4_packet_size <= mtu() && packet.headroom() >= sizeof(EthernetFrameHeader) + sizeof(IPv4Packet);
+
+    auto partial_checksum_offset = packet.partial_checksum_offset();
+    bool offload_checksum = partial_checksum_offset.has_value() && fits_in_one_frame && has_offload(Offload::TransmitChecksum);
+    if (partial_checksum_offset.has_value() && !offload_checksum) {
+        // The packet was prepared for an adapter that would finish the checksum, so do that here instead.
+        auto& checksum_field = *(NetworkOrdered<u16>*)(packet.data() + partial_checksum_offset.value());
+        InternetChecksum checksum;
+        checksum.add(packet.bytes());
+        checksum_field = checksum.finish();
+        packet.set_partial_checksum_offset({});
+    }
+
+    if (!fits_in_one_frame)
+        return send_ipv4_fragmented(destination_mac, destination_ipv4, protocol, UserOrKernelBuffer::for_kernel_buffer(packet.data()), payload_size, ttl);
+
+    auto* ipv4_header = packet.push(sizeof(IPv4Packet));
+    memset(ipv4_header, 0, sizeof(IPv4Packet));
+    auto& ipv4 = *(IPv4Packet*)ipv4_header;
     ipv4.set_version(4);
     ipv4.set_internet_header_length(5);
     ipv4.set_source(ipv4_address());
     ipv4.set_destination(destination_ipv4);
     ipv4.set_protocol((u8)protocol);
-    ipv4.set_length(sizeof(IPv4Packet) + payload_size);
+    ipv4.set_length(ipv4_packet_size);
     ipv4.set_ident(1);
     ipv4.set_ttl(ttl);
     ipv4.set_checksum(ipv4.compute_checksum());
+
+    auto& eth = *(EthernetFrameHeader*)packet.push(sizeof(EthernetFrameHeader));
+    eth.set_source(mac_address());
+    eth.set_destination(destination_mac);
+    eth.set_ether_type(EtherType::IPv4);
+
     m_packets_out++;
-    m_bytes_out += ethernet_frame_size;
+    m_bytes_out += packet.size();
+    if (offload_checksum) {
+        size_t checksum_start = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet);
+        send_raw_with_checksum(packet.bytes(), checksum_start, checksum_start + partial_checksum_offset.value());
+    } else {
+        send_raw(packet.bytes());
+    }
 
-    if (!payload.read(ipv4.payload(), payload_size))
-        return EFAULT;
-    send_raw({ (const u8*)&eth, ethernet_frame_size });
+    packet.pull(sizeof(EthernetFrameHeader) + sizeof(IPv4Packet));
     return KSuccess;
 }
 
@@ -172,49 +207,94 @@ KResult NetworkAdapter::send_ipv4_fragmented(const MACAddress& destination_mac,
     return KSuccess;
 }
 
-void NetworkAdapter::did_receive(ReadonlyBytes payload)
+void NetworkAdapter::set_receive_queue_count(size_t count)
+{
+    VERIFY(count > 0 && count <= max_receive_queues);
+    m_receive_queue_count = count;
+}
+
+size_t NetworkAdapter::receive_queue_for_frame(ReadonlyBytes frame) const
 {
-    InterruptDisabler disabler;
-    m_packets_in++;
-    m_bytes_in += payload.size();
+    if (m_receive_queue_count == 1 || frame.size() < sizeof(EthernetFrameHeader) + sizeof(IPv4Packet))
+        return 0;
+    auto& eth = *(const EthernetFrameHeader*)frame.data();
+    if (eth.ether_type() != EtherType::IPv4)
+        return 0;
 
-    Optional<KBuffer> buffer;
+    auto& ipv4 = *(const IPv4Packet*)eth.payload();
+    u32 hash = pair_int_hash(ipv4.source().to_u32(), ipv4.destination().to_u32()) ^ int_hash(ipv4.protocol());
 
-    if (m_unused_packet_buffers.is_empty()) {
-        buffer = KBuffer::copy(payload.data(), payload.size());
-    } else {
-        buffer = m_unused_packet_buffers.take_first();
-        --m_unused_packet_buffers_count;
-        if (payload.size() <= buffer.value().capacity()) {
-            memcpy(buffer.value().data(), payload.data(), payload.size());
-            buffer.value().set_size(payload.size());
-        } else {
-            buffer = KBuffer::copy(payload.data(), payload.size());
+    // Only the first fragment carries the ports, so fragments are steered by address alone.
+    bool has_ports = ipv4.protocol() == (u8)IPv4Protocol::TCP || ipv4.protocol() == (u8)IPv4Protocol::UDP;
+    size_t ports_offset = sizeof(EthernetFrameHeader) + ipv4.internet_header_length() * sizeof(u32);
+    if (has_ports && !ipv4.is_a_fragment() && frame.size() >= ports_offset + sizeof(u32)) {
+        auto* ports = frame.offset(ports_offset);
+        hash = pair_int_hash(hash, (u32)ports[0] << 24 | (u32)ports[1] << 16 | (u32)ports[2] << 8 | (u32)ports[3]);
+    }
+    return hash % m_receive_queue_count;
+}
+
+void NetworkAdapter::did_receive(ReadonlyBytes payload)
+{
+    auto packet = PacketBuffer::try_create_with_bytes(payload, 0);
+    if (!packet) {
+        dbgln("NetworkAdapter: Dropping a {} byte frame, could not allocate a packet buffer", payload.size());
+        did_drop_packets(1);
+        return;
+    }
+    did_receive_packet(packet.release_nonnull());
+}
+
+void NetworkAdapter::did_receive_packet(NonnullRefPtr<PacketBuffer> packet)
+{
+    packet->set_timestamp(kgettimeofday());
+    size_t queue_index = receive_queue_for_frame(packet->bytes());
+    auto& queue = m_receive_queues[queue_index];
+    {
+        ScopedSpinLock lock(queue.lock);
+        if (queue.packets.size() >= max_queued_packets) {
+            did_drop_packets(1);
+            return;
         }
+        m_packets_in++;
+        m_bytes_in += packet->size();
+        queue.packets.append(move(packet));
     }
 
-    m_packet_queue.append({ buffer.value(), kgettimeofday() });
+    if (on_receive)
+        on_receive(queue_index);
+}
 
+void NetworkAdapter::schedule_receive_poll()
+{
+    m_receive_poll_scheduled = true;
     if (on_receive)
-        on_receive();
+        on_receive(0);
 }
 
-size_t NetworkAdapter::dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp)
+void NetworkAdapter::poll_receive_ring()
 {
-    InterruptDisabler disabler;
-    if (m_packet_queue.is_empty())
-        return 0;
-    auto packet_with_timestamp = m_packet_queue.take_first();
-    packet_timestamp = packet_with_timestamp.timestamp;
-    auto packet = move(packet_with_timestamp.packet);
-    size_t packet_size = packet.size();
-    VERIFY(packet_size <= buffer_size);
-    memcpy(buffer, packet.data(), packet_size);
-    if (m_unused_packet_buffers_count < 100) {
-        m_unused_packet_buffers.append(packet);
-        ++m_unused_packet_buffers_count;
+    m_receive_polls++;
+    if (poll_receive(receive_poll_budget) < receive_poll_budget) {
+        m_receive_poll_scheduled = false;
+        enable_receive_interrupts();
     }
-    return packet_size;
+}
+
+bool NetworkAdapter::has_queued_packets(size_t queue_index) const
+{
+    auto& queue = m_receive_queues[queue_index];
+    ScopedSpinLock lock(queue.lock);
+    return !queue.packets.is_empty();
+}
+
+RefPtr<PacketBuffer> NetworkAdapter::dequeue_packet(size_t queue_index)
+{
+    auto& queue = m_receive_queues[queue_index];
+    ScopedSpinLock lock(queue.lock);
+    if (queue.packets.is_empty())
+        return {};
+    return queue.packets.take_first();
 }
 
 void NetworkAdapter::set_ipv4_address(const IPv4Address& address)
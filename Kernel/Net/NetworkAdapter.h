@@ -26,10 +26,12 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/ByteBuffer.h>
+#include <AK/EnumBits.h>
 #include <AK/Function.h>
 #include <AK/MACAddress.h>
-#include <AK/SinglyLinkedList.h>
+#include <AK/SinglyLinkedListWithCount.h>
 #include <AK/Types.h>
 #include <AK/WeakPtr.h>
 #include <AK/Weakable.h>
@@ -37,6 +39,8 @@
 #include <Kernel/Net/ARP.h>
 #include <Kernel/Net/ICMP.h>
 #include <Kernel/Net/IPv4.h>
+#include <Kernel/Net/PacketBuffer.h>
+#include <Kernel/SpinLock.h>
 #include <Kernel/UserOrKernelBuffer.h>
 
 namespace Kernel {
@@ -59,17 +63,42 @@ public:
     IPv4Address ipv4_gateway() const { return m_ipv4_gateway; }
     virtual bool link_up() { return false; }
 
+    // Work the hardware does on its own, so the stack can skip doing it in software.
+    enum class Offload : u8 {
+        None = 0,
+        TransmitChecksum = 1 << 0,
+        ReceiveChecksum = 1 << 1,
+    };
+    bool has_offload(Offload offload) const { return ((u8)m_offloads & (u8)offload) == (u8)offload; }
+
     void set_ipv4_address(const IPv4Address&);
     void set_ipv4_netmask(const IPv4Address&);
     void set_ipv4_gateway(const IPv4Address&);
 
     void send(const MACAddress&, const ARPPacket&);
     KResult send_ipv4(const MACAddress&, const IPv4Address&, IPv4Protocol, const UserOrKernelBuffer& payload, size_t payload_size, u8 ttl);
+    // Sends the payload in `packet`, prepending the IPv4 and Ethernet headers into its headroom.
+    // The headers are pulled off again afterwards, so the packet can be resent later.
+    KResult send_ipv4(const MACAddress&, const IPv4Address&, IPv4Protocol, PacketBuffer& packet, u8 ttl);
     KResult send_ipv4_fragmented(const MACAddress&, const IPv4Address&, IPv4Protocol, const UserOrKernelBuffer& payload, size_t payload_size, u8 ttl);
 
-    size_t dequeue_packet(u8* buffer, size_t buffer_size, Time& packet_timestamp);
+    // Received frames are spread over several queues by flow, so that each queue can be
+    // drained by its own worker while a given connection always sees its packets in order.
+    static constexpr size_t max_receive_queues = 8;
+    size_t receive_queue_count() const { return m_receive_queue_count; }
+    void set_receive_queue_count(size_t);
+
+    RefPtr<PacketBuffer> dequeue_packet(size_t queue_index);
+
+    bool has_queued_packets(size_t queue_index) const;
 
-    bool has_queued_packets() const { return !m_packet_queue.is_empty(); }
+    // Adapters that can poll their receive ring mask the receive interrupt and ask for a poll
+    // instead of handling frames in their interrupt handler. The poll runs on the worker for
+    // the first receive queue and handles up to a budget of frames at a time; only when the
+    // ring is drained does the adapter turn the interrupt back on.
+    static constexpr size_t receive_poll_budget = 64;
+    bool is_receive_poll_scheduled() const { return m_receive_poll_scheduled; }
+    void poll_receive_ring();
 
     u32 mtu() const { return m_mtu; }
     void set_mtu(u32 mtu) { m_mtu = mtu; }
@@ -78,15 +107,29 @@ public:
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    u32 packets_dropped() const { return m_packets_dropped; }
+    u32 interrupts() const { return m_interrupts; }
+    u32 receive_polls() const { return m_receive_polls; }
 
-    Function<void()> on_receive;
+    Function<void(size_t queue_index)> on_receive;
 
 protected:
     NetworkAdapter();
     void set_interface_name(const StringView& basename);
     void set_mac_address(const MACAddress& mac_address) { m_mac_address = mac_address; }
     virtual void send_raw(ReadonlyBytes) = 0;
+    // Only used with Offload::TransmitChecksum. The adapter sums everything from `checksum_start`
+    // to the end of the frame into the checksum field at `checksum_offset`.
+    virtual void send_raw_with_checksum(ReadonlyBytes, size_t /* checksum_start */, size_t /* checksum_offset */) { VERIFY_NOT_REACHED(); }
+    void set_offloads(Offload offloads) { m_offloads = offloads; }
     void did_receive(ReadonlyBytes);
+    void did_receive_packet(NonnullRefPtr<PacketBuffer>);
+    void did_drop_packets(u32 count) { m_packets_dropped += count; }
+    void did_handle_interrupt() { m_interrupts++; }
+
+    void schedule_receive_poll();
+    virtual size_t poll_receive(size_t /* budget */) { return 0; }
+    virtual void enable_receive_interrupts() { }
 
 private:
     MACAddress m_mac_address;
@@ -94,20 +137,31 @@ private:
     IPv4Address m_ipv4_netmask;
     IPv4Address m_ipv4_gateway;
 
-    struct PacketWithTimestamp {
-        KBuffer packet;
-        Time timestamp;
+    // Beyond this, frames are dropped rather than queued for a worker that can't keep up.
+    static constexpr size_t max_queued_packets = 1024;
+
+    struct ReceiveQueue {
+        mutable SpinLock<u8> lock;
+        SinglyLinkedListWithCount<NonnullRefPtr<PacketBuffer>> packets;
     };
 
-    SinglyLinkedList<PacketWithTimestamp> m_packet_queue;
-    SinglyLinkedList<KBuffer> m_unused_packet_buffers;
-    size_t m_unused_packet_buffers_count { 0 };
+    size_t receive_queue_for_frame(ReadonlyBytes) const;
+
+    ReceiveQueue m_receive_queues[max_receive_queues];
+    size_t m_receive_queue_count { 1 };
     String m_name;
     u32 m_packets_in { 0 };
     u32 m_bytes_in { 0 };
     u32 m_packets_out { 0 };
     u32 m_bytes_out { 0 };
+    Atomic<u32> m_packets_dropped { 0 };
+    Atomic<u32> m_interrupts { 0 };
+    Atomic<u32> m_receive_polls { 0 };
+    Atomic<bool> m_receive_poll_scheduled { false };
+    Offload m_offloads { Offload::None };
     u32 m_mtu { 1500 };
 };
 
+AK_ENUM_BITWISE_OPERATORS(NetworkAdapter::Offload);
+
 }
@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Singleton.h>
 #include <Kernel/Debug.h>
 #include <Kernel/Lock.h>
 #include <Kernel/Net/ARP.h>
@@ -44,12 +45,24 @@
 namespace Kernel {
 
 static void handle_arp(const EthernetFrameHeader&, size_t frame_size);
-static void handle_ipv4(const EthernetFrameHeader&, size_t frame_size, const Time& packet_timestamp);
-static void handle_icmp(const EthernetFrameHeader&, const IPv4Packet&, const Time& packet_timestamp);
-static void handle_udp(const IPv4Packet&, const Time& packet_timestamp);
-static void handle_tcp(const IPv4Packet&, const Time& packet_timestamp);
+static void handle_ipv4(PacketBuffer&);
+static void handle_icmp(const EthernetFrameHeader&, PacketBuffer&);
+static void handle_udp(PacketBuffer&);
+static void handle_tcp(PacketBuffer&);
 
 [[noreturn]] static void NetworkTask_main(void*);
+[[noreturn]] static void NetworkWorker_main(void*);
+
+// Each receive queue of each adapter is drained by its own worker thread.
+// Workers (like the adapters) live for as long as the kernel does.
+struct NetworkWorker {
+    NetworkAdapter& adapter;
+    size_t queue_index { 0 };
+    WaitQueue wait_queue;
+};
+
+static AK::Singleton<WaitQueue> s_timer_wait_queue;
+static Atomic<bool> s_tcp_timer_expired { false };
 
 void NetworkTask::spawn()
 {
@@ -57,12 +70,19 @@ void NetworkTask::spawn()
     Process::create_kernel_process(thread, "NetworkTask", NetworkTask_main, nullptr);
 }
 
+void NetworkTask::notify_tcp_timer_expired()
+{
+    s_tcp_timer_expired = true;
+    s_timer_wait_queue->wake_all();
+}
+
 void NetworkTask_main(void*)
 {
-    WaitQueue packet_wait_queue;
-    int pending_packets = 0;
+    // Spread the traffic of every adapter over as many workers as we have processors.
+    size_t queue_count = min((size_t)Processor::count(), NetworkAdapter::max_receive_queues);
+
     NetworkAdapter::for_each([&](auto& adapter) {
-        dmesgln("NetworkTask: {} network adapter found: hw={}", adapter.class_name(), adapter.mac_address().to_string());
+        dmesgln("NetworkTask: {} network adapter found: hw={}, {} receive queues", adapter.class_name(), adapter.mac_address().to_string(), queue_count);
 
         if (String(adapter.class_name()) == "LoopbackAdapter") {
             adapter.set_ipv4_address({ 127, 0, 0, 1 });
@@ -70,42 +90,51 @@ void NetworkTask_main(void*)
             adapter.set_ipv4_gateway({ 0, 0, 0, 0 });
         }
 
-        adapter.on_receive = [&]() {
-            pending_packets++;
-            packet_wait_queue.wake_all();
+        Vector<NetworkWorker*> workers;
+        for (size_t i = 0; i < queue_count; ++i)
+            workers.append(new NetworkWorker { adapter, i, {} });
+
+        adapter.on_receive = [workers](size_t queue_index) {
+            workers[queue_index]->wait_queue.wake_all();
         };
+        adapter.set_receive_queue_count(queue_count);
+
+        for (auto* worker : workers) {
+            RefPtr<Thread> thread;
+            Process::create_kernel_process(thread, String::formatted("NetworkTask: {}/{}", adapter.name(), worker->queue_index), NetworkWorker_main, worker, 1u << (worker->queue_index % Processor::count()));
+        }
     });
 
-    auto dequeue_packet = [&pending_packets](u8* buffer, size_t buffer_size, Time& packet_timestamp) -> size_t {
-        if (pending_packets == 0)
-            return 0;
-        size_t packet_size = 0;
-        NetworkAdapter::for_each([&](auto& adapter) {
-            if (packet_size || !adapter.has_queued_packets())
-                return;
-            packet_size = adapter.dequeue_packet(buffer, buffer_size, packet_timestamp);
-            pending_packets--;
-            dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {} ({} bytes)", adapter.name(), packet_size);
-        });
-        return packet_size;
-    };
-
-    size_t buffer_size = 64 * KiB;
-    auto buffer_region = MM.allocate_kernel_region(buffer_size, "Kernel Packet Buffer", Region::Access::Read | Region::Access::Write);
-    auto buffer = (u8*)buffer_region->vaddr().get();
-    Time packet_timestamp;
+    // The workers do all the packet processing; what's left here is anything driven by timers.
+    for (;;) {
+        s_timer_wait_queue->wait_forever("NetworkTask");
+        if (s_tcp_timer_expired.exchange(false))
+            TCPSocket::handle_expired_retransmit_timers();
+    }
+}
+
+void NetworkWorker_main(void* data)
+{
+    auto& worker = *static_cast<NetworkWorker*>(data);
 
     for (;;) {
-        size_t packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
-        if (!packet_size) {
-            packet_wait_queue.wait_forever("NetworkTask");
+        auto packet = worker.adapter.dequeue_packet(worker.queue_index);
+        if (!packet) {
+            // Only refill the queues from the adapter's receive ring once this one is drained,
+            // so a busy ring can't make the queue grow without bound.
+            if (worker.queue_index == 0 && worker.adapter.is_receive_poll_scheduled())
+                worker.adapter.poll_receive_ring();
+            else
+                worker.wait_queue.wait_forever("NetworkTask");
             continue;
         }
+        size_t packet_size = packet->size();
+        dbgln_if(NETWORK_TASK_DEBUG, "NetworkTask: Dequeued packet from {}/{} ({} bytes)", worker.adapter.name(), worker.queue_index, packet_size);
         if (packet_size < sizeof(EthernetFrameHeader)) {
             dbgln("NetworkTask: Packet is too small to be an Ethernet packet! ({})", packet_size);
             continue;
         }
-        auto& eth = *(const EthernetFrameHeader*)buffer;
+        auto& eth = *(const EthernetFrameHeader*)packet->data();
         dbgln_if(ETHERNET_DEBUG, "NetworkTask: From {} to {}, ether_type={:#04x}, packet_size={}", eth.source().to_string(), eth.destination().to_string(), eth.ether_type(), packet_size);
 
         switch (eth.ether_type()) {
@@ -113,7 +142,7 @@ void NetworkTask_main(void*)
             handle_arp(eth, packet_size);
             break;
         case EtherType::IPv4:
-            handle_ipv4(eth, packet_size, packet_timestamp);
+            handle_ipv4(*packet);
             break;
         case EtherType::IPv6:
             // ignore
@@ -173,8 +202,10 @@ void handle_arp(const EthernetFrameHeader& eth, size_t frame_size)
     }
 }
 
-void handle_ipv4(const EthernetFrameHeader& eth, size_t frame_size, const Time& packet_timestamp)
+void handle_ipv4(PacketBuffer& frame)
 {
+    size_t frame_size = frame.size();
+    auto& eth = *(const EthernetFrameHeader*)frame.data();
     constexpr size_t minimum_ipv4_frame_size = sizeof(EthernetFrameHeader) + sizeof(IPv4Packet);
     if (frame_size < minimum_ipv4_frame_size) {
         dbgln("handle_ipv4: Frame too small ({}, need {})", frame_size, minimum_ipv4_frame_size);
@@ -193,23 +224,40 @@ void handle_ipv4(const EthernetFrameHeader& eth, size_t frame_size, const Time&
         return;
     }
 
+    size_t header_size = packet.internet_header_length() * sizeof(u32);
+    if (header_size < sizeof(IPv4Packet) || header_size > packet.length()) {
+        dbgln("handle_ipv4: IPv4 header has invalid size {}", header_size);
+        return;
+    }
+
+    if (!frame.is_checksum_verified() && internet_checksum(&packet, header_size) != 0) {
+        dbgln("handle_ipv4: Dropping IPv4 packet with bad header checksum");
+        return;
+    }
+
     dbgln_if(IPV4_DEBUG, "handle_ipv4: source={}, destination={}", packet.source(), packet.destination());
 
+    // Leave just the IPv4 packet, without the Ethernet header in front or any padding behind it.
+    // The Ethernet header stays where it is in the headroom, so `eth` remains valid.
+    frame.pull(sizeof(EthernetFrameHeader));
+    frame.trim(packet.length());
+
     switch ((IPv4Protocol)packet.protocol()) {
     case IPv4Protocol::ICMP:
-        return handle_icmp(eth, packet, packet_timestamp);
+        return handle_icmp(eth, frame);
     case IPv4Protocol::UDP:
-        return handle_udp(packet, packet_timestamp);
+        return handle_udp(frame);
     case IPv4Protocol::TCP:
-        return handle_tcp(packet, packet_timestamp);
+        return handle_tcp(frame);
     default:
         dbgln("handle_ipv4: Unhandled protocol {:#02x}", packet.protocol());
         break;
     }
 }
 
-void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
+void handle_icmp(const EthernetFrameHeader& eth, PacketBuffer& packet)
 {
+    auto& ipv4_packet = *(const IPv4Packet*)packet.data();
     auto& icmp_header = *static_cast<const ICMPHeader*>(ipv4_packet.payload());
     dbgln_if(ICMP_DEBUG, "handle_icmp: source={}, destination={}, type={:#02x}, code={:#02x}", ipv4_packet.source().to_string(), ipv4_packet.destination().to_string(), icmp_header.type(), icmp_header.code());
 
@@ -224,7 +272,7 @@ void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet,
             }
         }
         for (auto& socket : icmp_sockets)
-            socket.did_receive(ipv4_packet.source(), 0, KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()), packet_timestamp);
+            socket.did_receive(ipv4_packet.source(), 0, packet);
     }
 
     auto adapter = NetworkAdapter::from_ipv4_address(ipv4_packet.destination());
@@ -254,8 +302,16 @@ void handle_icmp(const EthernetFrameHeader& eth, const IPv4Packet& ipv4_packet,
     }
 }
 
-void handle_udp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
+static bool has_valid_transport_checksum(const IPv4Packet& ipv4_packet, IPv4Protocol protocol)
 {
+    auto checksum = ipv4_pseudo_header_checksum(ipv4_packet.source(), ipv4_packet.destination(), protocol, ipv4_packet.payload_size());
+    checksum.add(ipv4_packet.payload(), ipv4_packet.payload_size());
+    return checksum.finish() == 0;
+}
+
+void handle_udp(PacketBuffer& packet)
+{
+    auto& ipv4_packet = *(const IPv4Packet*)packet.data();
     if (ipv4_packet.payload_size() < sizeof(UDPPacket)) {
         dbgln("handle_udp: Packet too small ({}, need {})", ipv4_packet.payload_size(), sizeof(UDPPacket));
         return;
@@ -268,6 +324,14 @@ void handle_udp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
     }
 
     auto& udp_packet = *static_cast<const UDPPacket*>(ipv4_packet.payload());
+
+    // A zero checksum means the sender didn't compute one.
+    if (!packet.is_checksum_verified() && udp_packet.checksum() != 0 && !ipv4_packet.is_a_fragment()
+        && !has_valid_transport_checksum(ipv4_packet, IPv4Protocol::UDP)) {
+        dbgln("handle_udp: Dropping UDP packet with bad checksum");
+        return;
+    }
+
     dbgln_if(UDP_DEBUG, "handle_udp: source={}:{}, destination={}:{}, length={}",
         ipv4_packet.source(), udp_packet.source_port(),
         ipv4_packet.destination(), udp_packet.destination_port(),
@@ -281,11 +345,12 @@ void handle_udp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
 
     VERIFY(socket->type() == SOCK_DGRAM);
     VERIFY(socket->local_port() == udp_packet.destination_port());
-    socket->did_receive(ipv4_packet.source(), udp_packet.source_port(), KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()), packet_timestamp);
+    socket->did_receive(ipv4_packet.source(), udp_packet.source_port(), packet);
 }
 
-void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
+void handle_tcp(PacketBuffer& packet)
 {
+    auto& ipv4_packet = *(const IPv4Packet*)packet.data();
     if (ipv4_packet.payload_size() < sizeof(TCPPacket)) {
         dbgln("handle_tcp: IPv4 payload is too small to be a TCP packet ({}, need {})", ipv4_packet.payload_size(), sizeof(TCPPacket));
         return;
@@ -297,6 +362,7 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
     size_t maximum_tcp_header_size = 15 * sizeof(u32);
     if (tcp_packet.header_size() < minimum_tcp_header_size || tcp_packet.header_size() > maximum_tcp_header_size) {
         dbgln("handle_tcp: TCP packet header has invalid size {}", tcp_packet.header_size());
+        return;
     }
 
     if (ipv4_packet.payload_size() < tcp_packet.header_size()) {
@@ -304,6 +370,11 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
         return;
     }
 
+    if (!packet.is_checksum_verified() && !ipv4_packet.is_a_fragment() && !has_valid_transport_checksum(ipv4_packet, IPv4Protocol::TCP)) {
+        dbgln("handle_tcp: Dropping TCP packet with bad checksum");
+        return;
+    }
+
     size_t payload_size = ipv4_packet.payload_size() - tcp_packet.header_size();
 
     dbgln_if(TCP_DEBUG, "handle_tcp: source={}:{}, destination={}:{}, seq_no={}, ack_no={}, flags={:#04x} ({}{}{}{}), window_size={}, payload_size={}",
@@ -385,6 +456,7 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            client->process_syn_options(tcp_packet, ipv4_packet.payload_size());
             [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             client->set_state(TCPSocket::State::SynReceived);
             return;
@@ -531,26 +603,24 @@ void handle_tcp(const IPv4Packet& ipv4_packet, const Time& packet_timestamp)
             return;
         }
     case TCPSocket::State::Established:
-        if (tcp_packet.has_fin()) {
-            if (payload_size != 0)
-                socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()), packet_timestamp);
+        if (payload_size)
+            socket->receive_tcp_payload(packet, tcp_packet, payload_size);
 
-            socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+        // A FIN only counts once everything before it has arrived.
+        if (tcp_packet.has_fin() && socket->ack_number() == (u32)(tcp_packet.sequence_number() + payload_size)) {
+            socket->set_ack_number(socket->ack_number() + 1);
             unused_rc = socket->send_tcp_packet(TCPFlags::ACK);
             socket->set_state(TCPSocket::State::CloseWait);
             socket->set_connected(false);
             return;
         }
 
-        socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
-
         dbgln_if(TCP_DEBUG, "Got packet with ack_no={}, seq_no={}, payload_size={}, acking it with new ack_no={}, seq_no={}",
             tcp_packet.ack_number(), tcp_packet.sequence_number(), payload_size, socket->ack_number(), socket->sequence_number());
 
-        if (payload_size) {
-            if (socket->did_receive(ipv4_packet.source(), tcp_packet.source_port(), KBuffer::copy(&ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size()), packet_timestamp))
-                unused_rc = socket->send_tcp_packet(TCPFlags::ACK);
-        }
+        // Out-of-order and duplicate segments get an ACK too, so the sender can detect the loss.
+        if (payload_size || tcp_packet.has_fin())
+            unused_rc = socket->send_tcp_packet(TCPFlags::ACK);
     }
 }
 
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Singleton.h>
+#include <Kernel/Heap/kmalloc.h>
+#include <Kernel/Net/PacketBuffer.h>
+#include <Kernel/SpinLock.h>
+#include <Kernel/StdLib.h>
+#include <Kernel/VM/MemoryManager.h>
+
+namespace Kernel {
+
+class PacketBufferPool {
+public:
+    bool try_grow(size_t page_count)
+    {
+        auto region = MM.allocate_kernel_region(page_count * PAGE_SIZE, "Packet Buffers", Region::Access::Read | Region::Access::Write, AllocationStrategy::AllocateNow);
+        if (!region)
+            return false;
+
+        ScopedSpinLock lock(m_lock);
+        m_slots.ensure_capacity(m_slots.size() + page_count);
+        m_free_slots.ensure_capacity(m_slots.size());
+        for (size_t i = 0; i < page_count; ++i) {
+            m_free_slots.unchecked_append(m_slots.size());
+            m_slots.unchecked_append({ region->vaddr().offset(i * PAGE_SIZE).as_ptr(), region->physical_page(i)->paddr() });
+        }
+        m_regions.append(region.release_nonnull());
+        return true;
+    }
+
+    Optional<size_t> take_slot()
+    {
+        ScopedSpinLock lock(m_lock);
+        if (m_free_slots.is_empty())
+            return {};
+        return m_free_slots.take_last();
+    }
+
+    void return_slot(size_t slot)
+    {
+        ScopedSpinLock lock(m_lock);
+        m_free_slots.unchecked_append(slot);
+    }
+
+    u8* slot_data(size_t slot)
+    {
+        ScopedSpinLock lock(m_lock);
+        return m_slots[slot].data;
+    }
+
+    PhysicalAddress slot_physical_address(size_t slot)
+    {
+        ScopedSpinLock lock(m_lock);
+        return m_slots[slot].physical_address;
+    }
+
+private:
+    struct Slot {
+        u8* data { nullptr };
+        PhysicalAddress physical_address;
+    };
+
+    // Adapters add pages as they come up, so the pool is as large as their receive rings need.
+    NonnullOwnPtrVector<Region> m_regions;
+    Vector<Slot> m_slots;
+    Vector<size_t> m_free_slots;
+    SpinLock<u8> m_lock;
+};
+
+static AK::Singleton<PacketBufferPool> s_pool;
+
+bool PacketBuffer::try_grow_dma_pool(size_t page_count)
+{
+    return s_pool->try_grow(page_count);
+}
+
+RefPtr<PacketBuffer> PacketBuffer::try_create_for_dma()
+{
+    auto slot = s_pool->take_slot();
+    if (!slot.has_value())
+        return {};
+    return adopt(*new PacketBuffer(s_pool->slot_data(slot.value()), PAGE_SIZE, 0, slot));
+}
+
+RefPtr<PacketBuffer> PacketBuffer::try_create(size_t size, size_t headroom)
+{
+    size_t capacity = headroom + size;
+    auto* storage = (u8*)kmalloc(capacity);
+    if (!storage)
+        return {};
+    auto buffer = adopt(*new PacketBuffer(storage, capacity, headroom, {}));
+    buffer->set_size(size);
+    return buffer;
+}
+
+RefPtr<PacketBuffer> PacketBuffer::try_create_with_bytes(ReadonlyBytes bytes, size_t headroom)
+{
+    auto buffer = try_create(bytes.size(), headroom);
+    if (!buffer)
+        return {};
+    memcpy(buffer->data(), bytes.data(), bytes.size());
+    return buffer;
+}
+
+PacketBuffer::PacketBuffer(u8* storage, size_t capacity, size_t headroom, Optional<size_t> pool_slot)
+    : m_storage(storage)
+    , m_capacity(capacity)
+    , m_offset(headroom)
+    , m_pool_slot(pool_slot)
+{
+    VERIFY(headroom <= capacity);
+}
+
+PacketBuffer::~PacketBuffer()
+{
+    if (m_pool_slot.has_value())
+        s_pool->return_slot(m_pool_slot.value());
+    else
+        kfree(m_storage);
+}
+
+PhysicalAddress PacketBuffer::physical_address() const
+{
+    VERIFY(is_dma_capable());
+    return s_pool->slot_physical_address(m_pool_slot.value()).offset(m_offset);
+}
+
+u8* PacketBuffer::push(size_t length)
+{
+    VERIFY(length <= m_offset);
+    m_offset -= length;
+    m_size += length;
+    return data();
+}
+
+void PacketBuffer::pull(size_t length)
+{
+    VERIFY(length <= m_size);
+    m_offset += length;
+    m_size -= length;
+}
+
+void PacketBuffer::trim(size_t size)
+{
+    VERIFY(size <= m_size);
+    m_size = size;
+}
+
+void PacketBuffer::set_size(size_t size)
+{
+    VERIFY(m_offset + size <= m_capacity);
+    m_size = size;
+}
+
+}
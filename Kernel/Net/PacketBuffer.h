@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <AK/Span.h>
+#include <AK/Time.h>
+#include <Kernel/PhysicalAddress.h>
+
+namespace Kernel {
+
+// A reference-counted network packet. The data sits somewhere inside the storage, so
+// headers can be stripped off the front (pull) on the way up the stack and prepended
+// in place (push) on the way down, without copying the payload around.
+class PacketBuffer : public RefCounted<PacketBuffer> {
+    AK_MAKE_NONCOPYABLE(PacketBuffer);
+    AK_MAKE_NONMOVABLE(PacketBuffer);
+
+public:
+    // Enough to prepend an Ethernet and an IPv4 header.
+    static constexpr size_t default_headroom = 64;
+
+    // One physical page from a preallocated pool, so a NIC can DMA straight into it.
+    static RefPtr<PacketBuffer> try_create_for_dma();
+    // Adds page_count pages to that pool. Network adapters call this for their receive rings.
+    static bool try_grow_dma_pool(size_t page_count);
+    static RefPtr<PacketBuffer> try_create(size_t size, size_t headroom = default_headroom);
+    static RefPtr<PacketBuffer> try_create_with_bytes(ReadonlyBytes, size_t headroom = default_headroom);
+    ~PacketBuffer();
+
+    u8* data() { return m_storage + m_offset; }
+    const u8* data() const { return m_storage + m_offset; }
+    size_t size() const { return m_size; }
+    Bytes bytes() { return { data(), m_size }; }
+    ReadonlyBytes bytes() const { return { data(), m_size }; }
+
+    size_t headroom() const { return m_offset; }
+    size_t tailroom() const { return m_capacity - m_offset - m_size; }
+
+    bool is_dma_capable() const { return m_pool_slot.has_value(); }
+    PhysicalAddress physical_address() const;
+
+    // Grows the packet at the front by `length` bytes and returns a pointer to them.
+    u8* push(size_t length);
+    // Drops `length` bytes of (already handled) headers from the front.
+    void pull(size_t length);
+    // Cuts the packet down to `size` bytes, e.g. to get rid of link layer padding.
+    void trim(size_t size);
+    // Sets the size after the data was written directly, e.g. by DMA.
+    void set_size(size_t size);
+
+    const Time& timestamp() const { return m_timestamp; }
+    void set_timestamp(const Time& timestamp) { m_timestamp = timestamp; }
+
+    // On transmit: the transport checksum is only partially filled in. The checksum field at this
+    // offset into the transport header holds the pseudo-header sum, and the rest of the sum is
+    // left to the network adapter.
+    Optional<size_t> partial_checksum_offset() const { return m_partial_checksum_offset; }
+    void set_partial_checksum_offset(Optional<size_t> offset) { m_partial_checksum_offset = offset; }
+
+    // On receive: the network adapter has already verified the IPv4 and transport checksums.
+    bool is_checksum_verified() const { return m_checksum_verified; }
+    void set_checksum_verified(bool verified) { m_checksum_verified = verified; }
+
+private:
+    PacketBuffer(u8* storage, size_t capacity, size_t headroom, Optional<size_t> pool_slot);
+
+    u8* m_storage { nullptr };
+    size_t m_capacity { 0 };
+    size_t m_offset { 0 };
+    size_t m_size { 0 };
+    Optional<size_t> m_pool_slot;
+    Time m_timestamp {};
+    Optional<size_t> m_partial_checksum_offset;
+    bool m_checksum_verified { false };
+};
+
+}
@@ -108,8 +108,10 @@ public:
     virtual bool is_ipv4() const { return false; }
     virtual KResultOr<size_t> sendto(FileDescription&, const UserOrKernelBuffer&, size_t, int flags, Userspace<const sockaddr*>, socklen_t) = 0;
     virtual KResultOr<size_t> recvfrom(FileDescription&, UserOrKernelBuffer&, size_t, int flags, Userspace<sockaddr*>, Userspace<socklen_t*>, Time&) = 0;
+    // Sends data read from another description without bouncing it through a separate buffer first.
+    virtual KResultOr<size_t> send_from(FileDescription&, FileDescription&, u64, size_t) { return ENOTSUP; }
 
-    virtual KResult setsockopt(int level, int option, Userspace<const void*>, socklen_t);
+    virtual KResult setsockopt(FileDescription&, int level, int option, Userspace<const void*>, socklen_t);
     virtual KResult getsockopt(FileDescription&, int level, int option, Userspace<void*>, Userspace<socklen_t*>);
 
     pid_t origin_pid() const { return m_origin.pid; }
@@ -41,11 +41,24 @@ struct TCPFlags {
     };
 };
 
+struct TCPOptionKind {
+    enum : u8 {
+        End = 0,
+        NOP = 1,
+        MSS = 2,
+        WindowScale = 3,
+        SACKPermitted = 4,
+        SACK = 5,
+    };
+};
+
 class [[gnu::packed]] TCPPacket {
 public:
     TCPPacket() = default;
     ~TCPPacket() = default;
 
+    static constexpr size_t checksum_offset = 16;
+
     size_t header_size() const { return data_offset() * sizeof(u32); }
 
     u16 source_port() const { return m_source_port; }
@@ -83,6 +96,36 @@ public:
     const void* payload() const { return ((const u8*)this) + header_size(); }
     void* payload() { return ((u8*)this) + header_size(); }
 
+    const u8* options() const { return ((const u8*)this) + sizeof(TCPPacket); }
+    u8* options() { return ((u8*)this) + sizeof(TCPPacket); }
+    size_t options_size() const { return header_size() - sizeof(TCPPacket); }
+
+    // segment_size is the number of bytes actually received, i.e. the IPv4 payload size.
+    template<typename Callback>
+    void for_each_option(size_t segment_size, Callback callback) const
+    {
+        if (header_size() < sizeof(TCPPacket) || header_size() > segment_size)
+            return;
+        auto* options = this->options();
+        size_t options_size = this->options_size();
+        for (size_t offset = 0; offset < options_size;) {
+            u8 kind = options[offset];
+            if (kind == TCPOptionKind::End)
+                break;
+            if (kind == TCPOptionKind::NOP) {
+                ++offset;
+                continue;
+            }
+            if (offset + 1 >= options_size)
+                break;
+            u8 length = options[offset + 1];
+            if (length < 2 || offset + length > options_size)
+                break;
+            callback(kind, ReadonlyBytes { options + offset + 2, length - 2u });
+            offset += length;
+        }
+    }
+
 private:
     NetworkOrdered<u16> m_source_port;
     NetworkOrdered<u16> m_destination_port;
@@ -97,4 +140,6 @@ private:
 
 static_assert(sizeof(TCPPacket) == 20);
 
+static constexpr size_t max_tcp_options_size = 40;
+
 }
@@ -30,6 +30,7 @@
 #include <Kernel/Devices/RandomDevice.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/Net/NetworkAdapter.h>
+#include <Kernel/Net/NetworkTask.h>
 #include <Kernel/Net/Routing.h>
 #include <Kernel/Net/TCP.h>
 #include <Kernel/Net/TCPSocket.h>
@@ -138,8 +139,12 @@ void TCPSocket::release_to_originator()
 
 void TCPSocket::release_for_accept(RefPtr<TCPSocket> socket)
 {
-    VERIFY(m_pending_release_for_accept.contains(socket->tuple()));
-    m_pending_release_for_accept.remove(socket->tuple());
+    {
+        // Connections to a listening socket are handled by whichever network worker their flow hashes to.
+        LOCKER(sockets_by_tuple().lock());
+        VERIFY(m_pending_release_for_accept.contains(socket->tuple()));
+        m_pending_release_for_accept.remove(socket->tuple());
+    }
     // FIXME: Should we observe this error somehow?
     [[maybe_unused]] auto rc = queue_connection_from(*socket);
 }
@@ -151,6 +156,8 @@ TCPSocket::TCPSocket(int protocol)
 
 TCPSocket::~TCPSocket()
 {
+    stop_retransmit_timer();
+
     LOCKER(sockets_by_tuple().lock());
     sockets_by_tuple().resource().remove(tuple());
 
@@ -162,44 +169,220 @@ NonnullRefPtr<TCPSocket> TCPSocket::create(int protocol)
     return adopt(*new TCPSocket(protocol));
 }
 
-KResultOr<size_t> TCPSocket::protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, [[maybe_unused]] int flags)
+template<typename ReadChunk>
+KResultOr<size_t> TCPSocket::send_segments(size_t data_length, ReadChunk read_chunk)
 {
-    auto& ipv4_packet = *reinterpret_cast<const IPv4Packet*>(raw_ipv4_packet.data());
-    auto& tcp_packet = *static_cast<const TCPPacket*>(ipv4_packet.payload());
-    size_t payload_size = raw_ipv4_packet.size() - sizeof(IPv4Packet) - tcp_packet.header_size();
-    dbgln_if(TCP_SOCKET_DEBUG, "payload_size {}, will it fit in {}?", payload_size, buffer_size);
-    VERIFY(buffer_size >= payload_size);
-    if (!buffer.write(tcp_packet.payload(), payload_size))
-        return EFAULT;
-    return payload_size;
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    if (routing_decision.is_zero())
+        return EHOSTUNREACH;
+    size_t segment_size = min((size_t)m_send_mss, routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket));
+
+    // Don't queue up more than a send buffer's worth, but always take at least one segment so the caller makes progress.
+    size_t queued_bytes = m_sequence_number - m_send_unacknowledged;
+    size_t send_buffer_space = queued_bytes < send_buffer_size ? send_buffer_size - queued_bytes : 0;
+    data_length = min(data_length, max(send_buffer_space, segment_size));
+
+    size_t nsent = 0;
+    while (nsent < data_length) {
+        size_t chunk_size = min(segment_size, data_length - nsent);
+        auto result = send_tcp_packet_with_payload(TCPFlags::PUSH | TCPFlags::ACK, chunk_size, [&](u8* destination, size_t size) {
+            return read_chunk(destination, nsent, size);
+        });
+        if (result.is_error()) {
+            if (nsent)
+                break;
+            return result.error();
+        }
+        // The source ran dry, e.g. an empty pipe.
+        if (result.value() == 0)
+            break;
+        nsent += result.value();
+    }
+    return nsent;
 }
 
 KResultOr<size_t> TCPSocket::protocol_send(const UserOrKernelBuffer& data, size_t data_length)
 {
-    int err = send_tcp_packet(TCPFlags::PUSH | TCPFlags::ACK, &data, data_length);
-    if (err < 0)
-        return KResult((ErrnoCode)-err);
-    return data_length;
+    return send_segments(data_length, [&](u8* destination, size_t offset, size_t size) -> KResultOr<size_t> {
+        if (!data.read(destination, offset, size))
+            return EFAULT;
+        return size;
+    });
+}
+
+KResultOr<size_t> TCPSocket::send_from(FileDescription&, FileDescription& source, u64 source_offset, size_t count)
+{
+    LOCKER(lock());
+    if (is_shut_down_for_writing())
+        return EPIPE;
+    if (!is_connected())
+        return ENOTCONN;
+
+    // The source is read straight into the segments' payload, so the data is copied only once on its way out.
+    auto nsent_or_error = send_segments(count, [&](u8* destination, size_t offset, size_t size) {
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(destination);
+        return source.read(buffer, source_offset + offset, size);
+    });
+    if (!nsent_or_error.is_error())
+        Thread::current()->did_ipv4_socket_write(nsent_or_error.value());
+    return nsent_or_error;
+}
+
+static bool sequence_after(u32 a, u32 b)
+{
+    return (i32)(a - b) > 0;
+}
+
+static u32 initial_congestion_window(u32 mss)
+{
+    // RFC 6928
+    return min(10 * mss, max(2 * mss, 14600u));
+}
+
+static u8 window_scale_for_buffer(size_t capacity)
+{
+    u8 scale = 0;
+    while ((capacity >> scale) > NumericLimits<u16>::max() && scale < 14)
+        ++scale;
+    return scale;
+}
+
+u16 TCPSocket::window_to_advertise(bool is_syn)
+{
+    // The window field of a SYN segment is never scaled.
+    u8 scale = is_syn ? 0 : receive_window_scale();
+    size_t window = min(receive_buffer_space() >> scale, (size_t)NumericLimits<u16>::max());
+    m_last_advertised_window = window << scale;
+    return window;
+}
+
+void TCPSocket::maybe_send_window_update()
+{
+    // Receiver side silly window syndrome avoidance (RFC 1122, 4.2.3.3): only announce a
+    // bigger window once it has grown by a full segment or by half the receive buffer.
+    size_t max_window = (size_t)NumericLimits<u16>::max() << receive_window_scale();
+    size_t window = min(receive_buffer_space(), max_window);
+    size_t threshold = min((size_t)m_receive_mss, receive_buffer_capacity() / 2);
+    if (window < m_last_advertised_window + threshold)
+        return;
+    [[maybe_unused]] auto rc = send_tcp_packet(TCPFlags::ACK);
+}
+
+size_t TCPSocket::write_options(u16 flags, Bytes options)
+{
+    size_t offset = 0;
+    auto append = [&](std::initializer_list<u8> bytes) {
+        for (auto byte : bytes)
+            options[offset++] = byte;
+    };
+
+    if (flags & TCPFlags::SYN) {
+        // When answering a SYN, only echo the options the peer offered.
+        bool is_answer = flags & TCPFlags::ACK;
+        append({ TCPOptionKind::MSS, 4, (u8)(m_receive_mss >> 8), (u8)(m_receive_mss & 0xff) });
+        if (!is_answer || m_sack_enabled)
+            append({ TCPOptionKind::NOP, TCPOptionKind::NOP, TCPOptionKind::SACKPermitted, 2 });
+        if (!is_answer || m_window_scaling_enabled)
+            append({ TCPOptionKind::NOP, TCPOptionKind::WindowScale, 3, m_receive_window_scale });
+        return offset;
+    }
+
+    if (!(flags & TCPFlags::ACK) || !m_sack_enabled || m_out_of_order_segments.is_empty())
+        return offset;
+
+    // Collapse the out-of-order queue into contiguous blocks. The block holding the most
+    // recently received segment has to come first (RFC 2018, section 4).
+    static constexpr size_t max_sack_blocks = 3;
+    Vector<Array<u32, 2>, 16> blocks;
+    for (auto& segment : m_out_of_order_segments) {
+        u32 left = segment.sequence_number;
+        u32 right = segment.sequence_number + segment.payload->size();
+        if (!blocks.is_empty() && !sequence_after(left, blocks.last()[1])) {
+            if (sequence_after(right, blocks.last()[1]))
+                blocks.last()[1] = right;
+            continue;
+        }
+        blocks.append({ left, right });
+    }
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (!sequence_after(blocks[i][0], m_last_out_of_order_sequence) && sequence_after(blocks[i][1], m_last_out_of_order_sequence)) {
+            auto block = blocks.take(i);
+            blocks.prepend(block);
+            break;
+        }
+    }
+
+    size_t block_count = min(blocks.size(), max_sack_blocks);
+    append({ TCPOptionKind::NOP, TCPOptionKind::NOP, TCPOptionKind::SACK, (u8)(2 + block_count * 8) });
+    for (size_t i = 0; i < block_count; ++i) {
+        for (auto edge : blocks[i])
+            append({ (u8)(edge >> 24), (u8)(edge >> 16), (u8)(edge >> 8), (u8)edge });
+    }
+    return offset;
 }
 
 KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload, size_t payload_size)
 {
-    const size_t buffer_size = sizeof(TCPPacket) + payload_size;
-    auto buffer = ByteBuffer::create_zeroed(buffer_size);
-    auto& tcp_packet = *(TCPPacket*)(buffer.data());
+    auto result = send_tcp_packet_with_payload(flags, payload_size, [&](u8* destination, size_t size) -> KResultOr<size_t> {
+        if (payload && !payload->read(destination, size))
+            return EFAULT;
+        return size;
+    });
+    if (result.is_error())
+        return result.error();
+    return KSuccess;
+}
+
+template<typename ReadPayload>
+KResultOr<size_t> TCPSocket::send_tcp_packet_with_payload(u16 flags, size_t payload_size, ReadPayload read_payload)
+{
+    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
+    VERIFY(!routing_decision.is_zero());
+
+    const bool is_syn = flags & TCPFlags::SYN;
+    if (is_syn) {
+        m_receive_mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
+        m_receive_window_scale = window_scale_for_buffer(receive_buffer_capacity());
+        m_send_unacknowledged = m_sequence_number;
+        m_send_next = m_sequence_number;
+        m_recover = m_sequence_number;
+    }
+
+    u8 options[max_tcp_options_size];
+    const size_t options_size = write_options(flags, { options, sizeof(options) });
+    VERIFY(options_size % sizeof(u32) == 0);
+
+    const size_t header_size = sizeof(TCPPacket) + options_size;
+    size_t buffer_size = header_size + payload_size;
+    auto buffer = PacketBuffer::try_create(buffer_size);
+    if (!buffer)
+        return ENOMEM;
+    memset(buffer->data(), 0, header_size);
+    auto& tcp_packet = *(TCPPacket*)(buffer->data());
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(1024);
+    tcp_packet.set_window_size(window_to_advertise(is_syn));
     tcp_packet.set_sequence_number(m_sequence_number);
-    tcp_packet.set_data_offset(sizeof(TCPPacket) / sizeof(u32));
+    tcp_packet.set_data_offset(header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
+    memcpy(tcp_packet.options(), options, options_size);
 
     if (flags & TCPFlags::ACK)
         tcp_packet.set_ack_number(m_ack_number);
 
-    if (payload && !payload->read(tcp_packet.payload(), payload_size))
-        return EFAULT;
+    if (payload_size > 0) {
+        auto nread_or_error = read_payload((u8*)tcp_packet.payload(), payload_size);
+        if (nread_or_error.is_error())
+            return nread_or_error.error();
+        if (nread_or_error.value() == 0)
+            return 0;
+        if (nread_or_error.value() < payload_size) {
+            payload_size = nread_or_error.value();
+            buffer_size = header_size + payload_size;
+            buffer->trim(buffer_size);
+        }
+    }
 
     if (flags & TCPFlags::SYN) {
         ++m_sequence_number;
@@ -207,47 +390,60 @@ KResult TCPSocket::send_tcp_packet(u16 flags, const UserOrKernelBuffer* payload,
         m_sequence_number += payload_size;
     }
 
-    tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    if (routing_decision.adapter->has_offload(NetworkAdapter::Offload::TransmitChecksum)) {
+        auto checksum = ipv4_pseudo_header_checksum(local_address(), peer_address(), IPv4Protocol::TCP, buffer_size);
+        tcp_packet.set_checksum(checksum.folded());
+        buffer->set_partial_checksum_offset(TCPPacket::checksum_offset);
+    } else {
+        tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
+    }
 
     if (tcp_packet.has_syn() || payload_size > 0) {
         LOCKER(m_not_acked_lock);
-        m_not_acked.append({ m_sequence_number, move(buffer) });
+        m_not_acked.append({ m_sequence_number, buffer.release_nonnull() });
         send_outgoing_packets();
-        return KSuccess;
+        return payload_size;
     }
 
-    auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
-    VERIFY(!routing_decision.is_zero());
-
-    auto packet_buffer = UserOrKernelBuffer::for_kernel_buffer(buffer.data());
     auto result = routing_decision.adapter->send_ipv4(
         routing_decision.next_hop, peer_address(), IPv4Protocol::TCP,
-        packet_buffer, buffer_size, ttl());
+        *buffer, ttl());
     if (result.is_error())
         return result;
 
     m_packets_out++;
     m_bytes_out += buffer_size;
-    return KSuccess;
+    return payload_size;
 }
 
 void TCPSocket::send_outgoing_packets()
 {
     auto routing_decision = route_to(peer_address(), local_address(), bound_interface());
-    VERIFY(!routing_decision.is_zero());
+    if (routing_decision.is_zero())
+        return;
 
-    auto now = kgettimeofday();
+    auto now = TimeManagement::the().monotonic_time();
 
-    LOCKER(m_not_acked_lock, Lock::Mode::Shared);
+    LOCKER(m_not_acked_lock);
+    bool is_first_packet = true;
     for (auto& packet : m_not_acked) {
-        auto diff = now - packet.tx_time;
-        if (diff <= Time::from_nanoseconds(500'000'000))
+        // The oldest unacknowledged segment may always go out, which doubles as a zero window probe.
+        if (!is_first_packet && packet.ack_number - m_send_unacknowledged > usable_send_window())
+            break;
+        is_first_packet = false;
+
+        // Everything else already on the wire is covered by the retransmission timer.
+        if (packet.sacked || (packet.tx_counter > 0 && !packet.needs_retransmit))
             continue;
+
         packet.tx_time = now;
         packet.tx_counter++;
+        packet.needs_retransmit = false;
+        if (sequence_after(packet.ack_number, m_send_next))
+            m_send_next = packet.ack_number;
 
         if constexpr (TCP_SOCKET_DEBUG) {
-            auto& tcp_packet = *(const TCPPacket*)(packet.buffer.data());
+            auto& tcp_packet = *(const TCPPacket*)(packet.buffer->data());
             dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
                 local_address(), local_port(),
                 peer_address(), peer_port(),
@@ -260,12 +456,11 @@ void TCPSocket::send_outgoing_packets()
                 packet.tx_counter);
         }
 
-        auto packet_buffer = UserOrKernelBuffer::for_kernel_buffer(packet.buffer.data());
         int err = routing_decision.adapter->send_ipv4(
             routing_decision.next_hop, peer_address(), IPv4Protocol::TCP,
-            packet_buffer, packet.buffer.size(), ttl());
+            *packet.buffer, ttl());
         if (err < 0) {
-            auto& tcp_packet = *(const TCPPacket*)(packet.buffer.data());
+            auto& tcp_packet = *(const TCPPacket*)(packet.buffer->data());
             dmesgln("Error ({}) sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
                 err,
                 local_address(),
@@ -281,79 +476,383 @@ void TCPSocket::send_outgoing_packets()
                 packet.tx_counter);
         } else {
             m_packets_out++;
-            m_bytes_out += packet.buffer.size();
+            m_bytes_out += packet.buffer->size();
+        }
+    }
+
+    if (!m_not_acked.is_empty() && !m_retransmit_timer)
+        start_retransmit_timer();
+}
+
+void TCPSocket::start_retransmit_timer()
+{
+    VERIFY(m_not_acked_lock.is_locked());
+    stop_retransmit_timer();
+    auto deadline = TimeManagement::the().monotonic_time() + Time::from_microseconds(m_retransmission_timeout);
+    u32 generation = ++m_retransmit_timer_generation;
+    // The timer fires in a deferred call, so all it can do is hand the socket over to the network task.
+    m_retransmit_timer = TimerQueue::the().add_timer_without_id(CLOCK_MONOTONIC_COARSE, deadline, [this, generation] {
+        m_expired_retransmit_timer = generation;
+        NetworkTask::notify_tcp_timer_expired();
+    });
+}
+
+void TCPSocket::stop_retransmit_timer()
+{
+    if (auto timer = move(m_retransmit_timer))
+        TimerQueue::the().cancel_timer(timer.release_nonnull());
+}
+
+void TCPSocket::handle_expired_retransmit_timers()
+{
+    Vector<NonnullRefPtr<TCPSocket>> expired_sockets;
+    {
+        LOCKER(sockets_by_tuple().lock(), Lock::Mode::Shared);
+        for (auto& it : sockets_by_tuple().resource()) {
+            if (it.value->m_expired_retransmit_timer != 0)
+                expired_sockets.append(*it.value);
         }
     }
+    for (auto& socket : expired_sockets)
+        socket->retransmit_timer_expired();
+}
+
+void TCPSocket::retransmit_timer_expired()
+{
+    LOCKER(m_not_acked_lock);
+    // The timer may have been restarted after this expiry was already on its way.
+    if (m_expired_retransmit_timer.exchange(0) != m_retransmit_timer_generation || !m_retransmit_timer)
+        return;
+    m_retransmit_timer = nullptr;
+
+    if (m_not_acked.is_empty())
+        return;
+    if (state() == State::Closed) {
+        m_not_acked.clear();
+        return;
+    }
+
+    // Segments sent before the last loss was detected don't count as another congestion signal.
+    if (sequence_after(m_send_next, m_recover))
+        on_retransmission_timeout();
+
+    // Back off (RFC 6298, 5.5) and go back to the oldest unacknowledged segment.
+    m_retransmission_timeout = min(m_retransmission_timeout * 2, maximum_rto);
+    for (auto& packet : m_not_acked) {
+        if (!packet.sacked)
+            packet.needs_retransmit = true;
+    }
+    send_outgoing_packets();
+}
+
+void TCPSocket::update_rtt_estimate(Time sample)
+{
+    // Jacobson/Karels, as specified in RFC 6298, section 2.
+    i64 rtt = sample.to_microseconds();
+    if (!m_have_rtt_sample) {
+        m_smoothed_rtt = rtt;
+        m_rtt_variance = rtt / 2;
+        m_have_rtt_sample = true;
+    } else {
+        i64 error = m_smoothed_rtt - rtt;
+        m_rtt_variance = (3 * m_rtt_variance + (error < 0 ? -error : error)) / 4;
+        m_smoothed_rtt = (7 * m_smoothed_rtt + rtt) / 8;
+    }
+    m_retransmission_timeout = clamp(m_smoothed_rtt + 4 * m_rtt_variance, minimum_rto, maximum_rto);
+}
+
+void TCPSocket::on_new_ack(u32 acked_bytes)
+{
+    VERIFY(m_not_acked_lock.is_locked());
+    m_duplicate_ack_count = 0;
+
+    if (m_in_fast_recovery) {
+        if (!sequence_after(m_recover, m_send_unacknowledged)) {
+            // Full acknowledgement: everything outstanding at the time of the loss made it.
+            m_congestion_window = min(m_slow_start_threshold, bytes_in_flight() + m_send_mss);
+            m_in_fast_recovery = false;
+            return;
+        }
+        // Partial acknowledgement: the next hole is lost too, so resend it right away
+        // and deflate the window by the amount that left the network.
+        if (!m_not_acked.is_empty())
+            m_not_acked.first().needs_retransmit = true;
+        m_congestion_window -= min(acked_bytes, m_congestion_window);
+        m_congestion_window += m_send_mss;
+        return;
+    }
+
+    if (m_congestion_window < m_slow_start_threshold)
+        m_congestion_window += min(acked_bytes, m_send_mss);
+    else
+        m_congestion_window += max(1u, m_send_mss * m_send_mss / m_congestion_window);
+}
+
+void TCPSocket::on_duplicate_ack()
+{
+    VERIFY(m_not_acked_lock.is_locked());
+    if (m_in_fast_recovery) {
+        // Every duplicate ACK means a segment has left the network.
+        m_congestion_window += m_send_mss;
+        return;
+    }
+
+    if (++m_duplicate_ack_count < 3)
+        return;
+    m_duplicate_ack_count = 0;
+
+    // Don't react to a loss twice for data that was already in flight when we last backed off.
+    if (!sequence_after(m_send_unacknowledged, m_recover))
+        return;
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}): entering fast recovery at {}", this, m_send_unacknowledged);
+    m_recover = m_send_next;
+    m_slow_start_threshold = max(bytes_in_flight() / 2, 2 * m_send_mss);
+    m_congestion_window = m_slow_start_threshold + 3 * m_send_mss;
+    m_in_fast_recovery = true;
+    if (!m_not_acked.is_empty())
+        m_not_acked.first().needs_retransmit = true;
+
+    // With SACK we know more: anything the peer hasn't seen below its highest SACKed byte is gone too.
+    if (m_sack_enabled) {
+        for (auto& packet : m_not_acked) {
+            if (sequence_after(packet.ack_number, m_highest_sacked))
+                break;
+            if (!packet.sacked)
+                packet.needs_retransmit = true;
+        }
+    }
+}
+
+void TCPSocket::process_sack_blocks(ReadonlyBytes blocks)
+{
+    VERIFY(m_not_acked_lock.is_locked());
+    auto read_u32 = [](const u8* data) {
+        return (u32)data[0] << 24 | (u32)data[1] << 16 | (u32)data[2] << 8 | (u32)data[3];
+    };
+
+    for (size_t offset = 0; offset + 8 <= blocks.size(); offset += 8) {
+        u32 left = read_u32(blocks.offset(offset));
+        u32 right = read_u32(blocks.offset(offset + 4));
+        if (!sequence_after(right, m_send_unacknowledged) || sequence_after(right, m_send_next))
+            continue;
+        for (auto& packet : m_not_acked) {
+            u32 start = ((const TCPPacket*)packet.buffer->data())->sequence_number();
+            if (sequence_after(packet.ack_number, right))
+                break;
+            if (!sequence_after(left, start))
+                packet.sacked = true;
+        }
+        if (sequence_after(right, m_highest_sacked))
+            m_highest_sacked = right;
+    }
+}
+
+void TCPSocket::on_retransmission_timeout()
+{
+    VERIFY(m_not_acked_lock.is_locked());
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}): retransmission timeout at {}", this, m_send_unacknowledged);
+    m_slow_start_threshold = max(bytes_in_flight() / 2, 2 * m_send_mss);
+    m_congestion_window = m_send_mss;
+    m_recover = m_send_next;
+    m_duplicate_ack_count = 0;
+    m_in_fast_recovery = false;
+}
+
+void TCPSocket::process_syn_options(const TCPPacket& packet, size_t segment_size)
+{
+    u32 peer_mss = default_mss;
+    Optional<u8> peer_window_scale;
+    bool peer_sack_permitted = false;
+    packet.for_each_option(segment_size, [&](u8 kind, ReadonlyBytes data) {
+        if (kind == TCPOptionKind::MSS && data.size() == 2)
+            peer_mss = (data[0] << 8) | data[1];
+        else if (kind == TCPOptionKind::WindowScale && data.size() == 1)
+            peer_window_scale = min(data[0], (u8)14);
+        else if (kind == TCPOptionKind::SACKPermitted && data.is_empty())
+            peer_sack_permitted = true;
+    });
+
+    LOCKER(m_not_acked_lock);
+    // A peer advertising a tiny (or zero) MSS would have us send almost nothing but headers.
+    m_send_mss = max(peer_mss, minimum_mss);
+    m_window_scaling_enabled = peer_window_scale.has_value();
+    m_send_window_scale = peer_window_scale.value_or(0);
+    m_sack_enabled = peer_sack_permitted;
+    m_congestion_window = initial_congestion_window(m_send_mss);
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}): peer mss={}, window scaling {} (send scale {}, receive scale {}), SACK {}",
+        this, m_send_mss, m_window_scaling_enabled ? "enabled" : "disabled", m_send_window_scale, receive_window_scale(),
+        m_sack_enabled ? "enabled" : "disabled");
 }
 
 void TCPSocket::receive_tcp_packet(const TCPPacket& packet, u16 size)
 {
+    if (packet.has_syn())
+        process_syn_options(packet, size);
+
     if (packet.has_ack()) {
         u32 ack_number = packet.ack_number();
+        size_t payload_size = size - packet.header_size();
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
 
-        int removed = 0;
         LOCKER(m_not_acked_lock);
-        while (!m_not_acked.is_empty()) {
-            auto& packet = m_not_acked.first();
-
-            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
+        u32 previous_send_window = m_send_window;
+        // The window field of a SYN segment is never scaled.
+        m_send_window = (u32)packet.window_size() << (packet.has_syn() ? 0 : m_send_window_scale);
+
+        if (m_sack_enabled && !packet.has_syn()) {
+            packet.for_each_option(size, [&](u8 kind, ReadonlyBytes data) {
+                if (kind == TCPOptionKind::SACK)
+                    process_sack_blocks(data);
+            });
+        }
 
-            if (packet.ack_number <= ack_number) {
-                m_not_acked.take_first();
-                removed++;
-            } else {
-                break;
+        if (sequence_after(ack_number, m_send_unacknowledged) && !sequence_after(ack_number, m_send_next)) {
+            u32 acked_bytes = ack_number - m_send_unacknowledged;
+            m_send_unacknowledged = ack_number;
+
+            auto now = TimeManagement::the().monotonic_time();
+            Optional<Time> rtt_sample;
+            int removed = 0;
+            while (!m_not_acked.is_empty()) {
+                auto& packet = m_not_acked.first();
+
+                dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
+
+                if (!sequence_after(packet.ack_number, ack_number)) {
+                    // Karn's algorithm: retransmitted segments give ambiguous samples.
+                    if (packet.tx_counter == 1 && !packet.sacked)
+                        rtt_sample = now - packet.tx_time;
+                    m_not_acked.take_first();
+                    removed++;
+                } else {
+                    break;
+                }
             }
+
+            dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
+
+            if (rtt_sample.has_value())
+                update_rtt_estimate(rtt_sample.value());
+            on_new_ack(acked_bytes);
+
+            // RFC 6298, 5.2 and 5.3
+            if (m_not_acked.is_empty())
+                stop_retransmit_timer();
+            else
+                start_retransmit_timer();
+
+            // There's room in the send buffer again.
+            evaluate_block_conditions();
+        } else if (ack_number == m_send_unacknowledged && payload_size == 0 && !packet.has_syn() && !packet.has_fin()
+            && m_send_window == previous_send_window && bytes_in_flight() > 0) {
+            on_duplicate_ack();
         }
 
-        dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
+        // The window may have opened up, or a segment may be due for retransmission.
+        if (!m_not_acked.is_empty())
+            send_outgoing_packets();
     }
 
     m_packets_in++;
     m_bytes_in += packet.header_size() + size;
 }
 
-NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
+void TCPSocket::receive_tcp_payload(NonnullRefPtr<PacketBuffer> raw_ipv4_packet, const TCPPacket& tcp_packet, size_t payload_size)
 {
-    struct [[gnu::packed]] PseudoHeader {
-        IPv4Address source;
-        IPv4Address destination;
-        u8 zero;
-        u8 protocol;
-        NetworkOrdered<u16> payload_size;
-    };
+    u32 sequence_number = tcp_packet.sequence_number();
+    u32 end = sequence_number + payload_size;
 
-    PseudoHeader pseudo_header { source, destination, 0, (u8)IPv4Protocol::TCP, sizeof(TCPPacket) + payload_size };
+    // Nothing new, probably a retransmission of something whose ACK got lost.
+    if (!sequence_after(end, m_ack_number))
+        return;
 
-    u32 checksum = 0;
-    auto* w = (const NetworkOrdered<u16>*)&pseudo_header;
-    for (size_t i = 0; i < sizeof(pseudo_header) / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
-    }
-    w = (const NetworkOrdered<u16>*)&packet;
-    for (size_t i = 0; i < sizeof(packet) / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
+    // From here on, only the payload is of interest.
+    auto& payload = raw_ipv4_packet;
+    payload->pull(payload->size() - payload_size);
+
+    if (sequence_after(sequence_number, m_ack_number)) {
+        queue_out_of_order_segment(move(payload), sequence_number);
+        return;
     }
-    VERIFY(packet.data_offset() * 4 == sizeof(TCPPacket));
-    w = (const NetworkOrdered<u16>*)packet.payload();
-    for (size_t i = 0; i < payload_size / sizeof(u16); ++i) {
-        checksum += w[i];
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
+
+    if (!deliver_segment(move(payload), m_ack_number - sequence_number))
+        return;
+    m_ack_number = end;
+    deliver_queued_segments();
+}
+
+bool TCPSocket::deliver_segment(NonnullRefPtr<PacketBuffer> payload, size_t bytes_to_skip)
+{
+    // The start of this segment may overlap data we already have.
+    payload->pull(bytes_to_skip);
+    return did_receive(peer_address(), peer_port(), move(payload));
+}
+
+void TCPSocket::queue_out_of_order_segment(NonnullRefPtr<PacketBuffer> payload, u32 sequence_number)
+{
+    size_t payload_size = payload->size();
+
+    // Never hold on to more than the receive window would let the peer send.
+    if (m_out_of_order_segments.size() >= max_out_of_order_segments || m_out_of_order_bytes + payload_size > receive_buffer_space())
+        return;
+
+    size_t index = 0;
+    for (; index < m_out_of_order_segments.size(); ++index) {
+        auto& segment = m_out_of_order_segments[index];
+        if (segment.sequence_number == sequence_number && segment.payload->size() >= payload_size)
+            return;
+        if (sequence_after(segment.sequence_number, sequence_number))
+            break;
     }
-    if (payload_size & 1) {
-        u16 expanded_byte = ((const u8*)packet.payload())[payload_size - 1] << 8;
-        checksum += expanded_byte;
-        if (checksum > 0xffff)
-            checksum = (checksum >> 16) + (checksum & 0xffff);
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}): queueing out-of-order segment {}, expected {}", this, sequence_number, m_ack_number);
+    m_out_of_order_segments.insert(index, { sequence_number, move(payload) });
+    m_out_of_order_bytes += payload_size;
+    m_last_out_of_order_sequence = sequence_number;
+}
+
+void TCPSocket::deliver_queued_segments()
+{
+    while (!m_out_of_order_segments.is_empty()) {
+        auto& first = m_out_of_order_segments.first();
+        if (sequence_after(first.sequence_number, m_ack_number))
+            break;
+
+        auto segment = m_out_of_order_segments.take_first();
+        m_out_of_order_bytes -= segment.payload->size();
+        u32 end = segment.sequence_number + segment.payload->size();
+        if (!sequence_after(end, m_ack_number))
+            continue;
+        if (!deliver_segment(move(segment.payload), m_ack_number - segment.sequence_number))
+            break;
+        m_ack_number = end;
     }
-    return ~(checksum & 0xffff);
+}
+
+bool TCPSocket::can_write(const FileDescription& description, size_t size) const
+{
+    if (!IPv4Socket::can_write(description, size))
+        return false;
+    return m_sequence_number - m_send_unacknowledged < send_buffer_size;
+}
+
+KResultOr<size_t> TCPSocket::recvfrom(FileDescription& description, UserOrKernelBuffer& buffer, size_t buffer_length, int flags, Userspace<sockaddr*> addr, Userspace<socklen_t*> addr_length, Time& packet_timestamp)
+{
+    auto result = IPv4Socket::recvfrom(description, buffer, buffer_length, flags, addr, addr_length, packet_timestamp);
+    if (!result.is_error() && result.value() > 0 && state() == State::Established)
+        maybe_send_window_update();
+    return result;
+}
+
+NetworkOrdered<u16> TCPSocket::compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket& packet, u16 payload_size)
+{
+    size_t segment_size = packet.header_size() + payload_size;
+    auto checksum = ipv4_pseudo_header_checksum(source, destination, IPv4Protocol::TCP, segment_size);
+    checksum.add(&packet, segment_size);
+    return checksum.finish();
 }
 
 KResult TCPSocket::protocol_bind()
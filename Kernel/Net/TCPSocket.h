@@ -28,9 +28,11 @@
 
 #include <AK/Function.h>
 #include <AK/HashMap.h>
+#include <AK/NumericLimits.h>
 #include <AK/SinglyLinkedList.h>
 #include <AK/WeakPtr.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/TimerQueue.h>
 
 namespace Kernel {
 
@@ -147,10 +149,21 @@ public:
     u32 bytes_in() const { return m_bytes_in; }
     u32 packets_out() const { return m_packets_out; }
     u32 bytes_out() const { return m_bytes_out; }
+    u32 congestion_window() const { return m_congestion_window; }
+    u32 send_window() const { return m_send_window; }
+    u32 receive_window() const { return m_last_advertised_window; }
 
     KResult send_tcp_packet(u16 flags, const UserOrKernelBuffer* = nullptr, size_t = 0);
     void send_outgoing_packets();
     void receive_tcp_packet(const TCPPacket&, u16 size);
+    void receive_tcp_payload(NonnullRefPtr<PacketBuffer> raw_ipv4_packet, const TCPPacket&, size_t payload_size);
+    void process_syn_options(const TCPPacket&, size_t segment_size);
+
+    static void handle_expired_retransmit_timers();
+
+    virtual bool can_write(const FileDescription&, size_t) const override;
+    virtual KResultOr<size_t> send_from(FileDescription&, FileDescription& source, u64 source_offset, size_t) override;
+    virtual KResultOr<size_t> recvfrom(FileDescription&, UserOrKernelBuffer&, size_t, int flags, Userspace<sockaddr*>, Userspace<socklen_t*>, Time&) override;
 
     static Lockable<HashMap<IPv4SocketTuple, TCPSocket*>>& sockets_by_tuple();
     static RefPtr<TCPSocket> from_tuple(const IPv4SocketTuple& tuple);
@@ -175,9 +188,32 @@ private:
 
     static NetworkOrdered<u16> compute_tcp_checksum(const IPv4Address& source, const IPv4Address& destination, const TCPPacket&, u16 payload_size);
 
+    template<typename ReadPayload>
+    KResultOr<size_t> send_tcp_packet_with_payload(u16 flags, size_t payload_size, ReadPayload);
+    template<typename ReadChunk>
+    KResultOr<size_t> send_segments(size_t data_length, ReadChunk);
+
+    size_t write_options(u16 flags, Bytes options);
+    u16 window_to_advertise(bool is_syn);
+    void maybe_send_window_update();
+    u32 bytes_in_flight() const { return m_send_next - m_send_unacknowledged; }
+    u32 usable_send_window() const { return min(m_congestion_window, m_send_window); }
+    u8 receive_window_scale() const { return m_window_scaling_enabled ? m_receive_window_scale : 0; }
+    void on_new_ack(u32 acked_bytes);
+    void on_duplicate_ack();
+    void on_retransmission_timeout();
+    void process_sack_blocks(ReadonlyBytes);
+    void update_rtt_estimate(Time sample);
+    void start_retransmit_timer();
+    void stop_retransmit_timer();
+    void retransmit_timer_expired();
+
+    bool deliver_segment(NonnullRefPtr<PacketBuffer> payload, size_t bytes_to_skip);
+    void queue_out_of_order_segment(NonnullRefPtr<PacketBuffer> payload, u32 sequence_number);
+    void deliver_queued_segments();
+
     virtual void shut_down_for_writing() override;
 
-    virtual KResultOr<size_t> protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, int flags) override;
     virtual KResultOr<size_t> protocol_send(const UserOrKernelBuffer&, size_t) override;
     virtual KResult protocol_connect(FileDescription&, ShouldBlock) override;
     virtual int protocol_allocate_local_port() override;
@@ -200,13 +236,67 @@ private:
 
     struct OutgoingPacket {
         u32 ack_number { 0 };
-        ByteBuffer buffer;
+        NonnullRefPtr<PacketBuffer> buffer;
         int tx_counter { 0 };
         Time tx_time {};
+        bool needs_retransmit { false };
+        bool sacked { false };
     };
 
     Lock m_not_acked_lock { "TCPSocket unacked packets" };
     SinglyLinkedList<OutgoingPacket> m_not_acked;
+
+    static constexpr size_t send_buffer_size = 64 * KiB;
+    static constexpr u32 default_mss = 536;
+    static constexpr u32 minimum_mss = 88;
+
+    // Send sequence space (RFC 793): everything before m_send_unacknowledged has been
+    // acknowledged, everything before m_send_next has been transmitted at least once.
+    u32 m_send_unacknowledged { 0 };
+    u32 m_send_next { 0 };
+
+    // Window scaling (RFC 7323) only applies if both sides sent the option in their SYN.
+    bool m_window_scaling_enabled { false };
+    u8 m_send_window_scale { 0 };
+    u8 m_receive_window_scale { 0 };
+    u32 m_send_window { default_mss };
+    u32 m_last_advertised_window { 0 };
+    u32 m_send_mss { default_mss };
+    u32 m_receive_mss { default_mss };
+
+    // NewReno congestion control (RFC 5681, RFC 6582).
+    u32 m_congestion_window { default_mss };
+    u32 m_slow_start_threshold { NumericLimits<u32>::max() };
+    u32 m_recover { 0 };
+    u32 m_duplicate_ack_count { 0 };
+    bool m_in_fast_recovery { false };
+
+    // Selective acknowledgements (RFC 2018), if both sides sent SACK-permitted in their SYN.
+    bool m_sack_enabled { false };
+    u32 m_highest_sacked { 0 };
+
+    // Retransmission timer (RFC 6298), in microseconds.
+    static constexpr i64 initial_rto = 1'000'000;
+    static constexpr i64 minimum_rto = 200'000;
+    static constexpr i64 maximum_rto = 60'000'000;
+    bool m_have_rtt_sample { false };
+    i64 m_smoothed_rtt { 0 };
+    i64 m_rtt_variance { 0 };
+    i64 m_retransmission_timeout { initial_rto };
+    RefPtr<Timer> m_retransmit_timer;
+    u32 m_retransmit_timer_generation { 0 };
+    Atomic<u32> m_expired_retransmit_timer { 0 };
+
+    // Segments that arrived ahead of m_ack_number, sorted by sequence number.
+    // Only touched by the network task.
+    struct OutOfOrderSegment {
+        u32 sequence_number { 0 };
+        NonnullRefPtr<PacketBuffer> payload;
+    };
+    static constexpr size_t max_out_of_order_segments = 256;
+    Vector<OutOfOrderSegment> m_out_of_order_segments;
+    size_t m_out_of_order_bytes { 0 };
+    u32 m_last_out_of_order_sequence { 0 };
 };
 
 }
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/StringView.h>
+#include <Kernel/RingBuffer.h>
+
+namespace Kernel {
+
+size_t RingBuffer::round_up_capacity(size_t capacity)
+{
+    size_t rounded = PAGE_SIZE;
+    while (rounded < capacity)
+        rounded *= 2;
+    return rounded;
+}
+
+RingBuffer::RingBuffer(size_t capacity)
+    : m_storage(KBuffer::create_with_size(round_up_capacity(capacity), Region::Access::Read | Region::Access::Write, "RingBuffer"))
+    , m_capacity(round_up_capacity(capacity))
+{
+}
+
+ssize_t RingBuffer::write(const UserOrKernelBuffer& data, size_t size)
+{
+    if (!size || m_storage.is_null())
+        return 0;
+    LOCKER(m_write_lock);
+    // The reader only ever frees up space, so we can't overwrite anything it hasn't consumed yet.
+    size_t head = m_head.load(AK::MemoryOrder::memory_order_acquire);
+    size_t tail = m_tail.load(AK::MemoryOrder::memory_order_relaxed);
+    size_t bytes_to_write = min(size, m_capacity - (tail - head));
+    if (!bytes_to_write)
+        return 0;
+
+    size_t offset = tail & (m_capacity - 1);
+    size_t first_chunk_size = min(bytes_to_write, m_capacity - offset);
+    if (!data.read(m_storage.data() + offset, 0, first_chunk_size))
+        return -EFAULT;
+    if (first_chunk_size < bytes_to_write && !data.read(m_storage.data(), first_chunk_size, bytes_to_write - first_chunk_size))
+        return -EFAULT;
+
+    m_tail.store(tail + bytes_to_write, AK::MemoryOrder::memory_order_release);
+    if (m_unblock_callback)
+        m_unblock_callback();
+    return (ssize_t)bytes_to_write;
+}
+
+ssize_t RingBuffer::read(UserOrKernelBuffer& data, size_t size)
+{
+    if (!size || m_storage.is_null())
+        return 0;
+    LOCKER(m_read_lock);
+    // Likewise, the writer only ever adds data, so everything up to the tail we see is ours to read.
+    size_t tail = m_tail.load(AK::MemoryOrder::memory_order_acquire);
+    size_t head = m_head.load(AK::MemoryOrder::memory_order_relaxed);
+    size_t nread = min(size, tail - head);
+    if (!nread)
+        return 0;
+
+    size_t offset = head & (m_capacity - 1);
+    size_t first_chunk_size = min(nread, m_capacity - offset);
+    if (!data.write(m_storage.data() + offset, 0, first_chunk_size))
+        return -EFAULT;
+    if (first_chunk_size < nread && !data.write(m_storage.data(), first_chunk_size, nread - first_chunk_size))
+        return -EFAULT;
+
+    m_head.store(head + nread, AK::MemoryOrder::memory_order_release);
+    if (m_unblock_callback)
+        m_unblock_callback();
+    return (ssize_t)nread;
+}
+
+KResult RingBuffer::set_capacity(size_t capacity)
+{
+    if (capacity > max_capacity)
+        return EINVAL;
+    capacity = round_up_capacity(capacity);
+
+    Locker write_locker(m_write_lock);
+    Locker read_locker(m_read_lock);
+    if (capacity == m_capacity)
+        return KSuccess;
+
+    size_t head = m_head.load(AK::MemoryOrder::memory_order_relaxed);
+    size_t used = m_tail.load(AK::MemoryOrder::memory_order_relaxed) - head;
+    if (used > capacity)
+        return EBUSY;
+
+    auto new_storage = KBuffer::try_create_with_size(capacity, Region::Access::Read | Region::Access::Write, "RingBuffer");
+    if (!new_storage)
+        return ENOMEM;
+
+    // Move whatever is still buffered to the start of the new storage.
+    size_t offset = head & (m_capacity - 1);
+    size_t first_chunk_size = min(used, m_capacity - offset);
+    memcpy(new_storage->data(), m_storage.data() + offset, first_chunk_size);
+    memcpy(new_storage->data() + first_chunk_size, m_storage.data(), used - first_chunk_size);
+
+    m_storage = move(*new_storage);
+    m_capacity = capacity;
+    m_head.store(0, AK::MemoryOrder::memory_order_relaxed);
+    m_tail.store(used, AK::MemoryOrder::memory_order_release);
+    if (m_unblock_callback)
+        m_unblock_callback();
+    return KSuccess;
+}
+
+}
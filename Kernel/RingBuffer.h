@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020, Andreas Kling <kling@serenityos.org>
+ * Copyright (c) 2021, the SerenityOS developers.
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -26,17 +26,25 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
+#include <AK/Function.h>
 #include <AK/Types.h>
 #include <Kernel/KBuffer.h>
+#include <Kernel/KResult.h>
 #include <Kernel/Lock.h>
-#include <Kernel/Thread.h>
 #include <Kernel/UserOrKernelBuffer.h>
 
 namespace Kernel {
 
-class DoubleBuffer {
+// A byte ring for pipes, local sockets and PTYs. Readers and writers each have their own lock,
+// so a single producer and a single consumer never wait on each other; they only meet through
+// the head and tail counters.
+class RingBuffer {
 public:
-    explicit DoubleBuffer(size_t capacity = 65536);
+    static constexpr size_t default_capacity = 128 * KiB;
+    static constexpr size_t max_capacity = 4 * MiB;
+
+    explicit RingBuffer(size_t capacity = default_capacity);
 
     [[nodiscard]] ssize_t write(const UserOrKernelBuffer&, size_t);
     [[nodiscard]] ssize_t write(const u8* data, size_t size)
@@ -50,9 +58,14 @@ public:
         return read(buffer, size);
     }
 
-    bool is_empty() const { return m_empty; }
+    bool is_empty() const { return used_bytes() == 0; }
+
+    size_t space_for_writing() const { return m_capacity - used_bytes(); }
+    size_t capacity() const { return m_capacity; }
 
-    size_t space_for_writing() const { return m_space_for_writing; }
+    // Rounds the capacity up to a power of two number of pages. Fails with EBUSY if the data
+    // that's currently buffered wouldn't fit.
+    KResult set_capacity(size_t);
 
     void set_unblock_callback(Function<void()> callback)
     {
@@ -61,26 +74,20 @@ public:
     }
 
 private:
-    void flip();
-    void compute_lockfree_metadata();
-
-    struct InnerBuffer {
-        u8* data { nullptr };
-        size_t size;
-    };
+    static size_t round_up_capacity(size_t);
 
-    InnerBuffer* m_write_buffer { nullptr };
-    InnerBuffer* m_read_buffer { nullptr };
-    InnerBuffer m_buffer1;
-    InnerBuffer m_buffer2;
+    size_t used_bytes() const { return m_tail.load(AK::MemoryOrder::memory_order_acquire) - m_head.load(AK::MemoryOrder::memory_order_acquire); }
 
     KBuffer m_storage;
     Function<void()> m_unblock_callback;
     size_t m_capacity { 0 };
-    size_t m_read_buffer_index { 0 };
-    size_t m_space_for_writing { 0 };
-    bool m_empty { true };
-    mutable Lock m_lock { "DoubleBuffer" };
+
+    // Both only ever grow; their difference is the number of buffered bytes.
+    Atomic<size_t> m_head { 0 };
+    Atomic<size_t> m_tail { 0 };
+
+    Lock m_read_lock { "RingBuffer read" };
+    Lock m_write_lock { "RingBuffer write" };
 };
 
 }
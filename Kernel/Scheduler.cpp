@@ -24,6 +24,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/NumericLimits.h>
 #include <AK/QuickSort.h>
 #include <AK/ScopeGuard.h>
 #include <AK/TemporaryChange.h>
@@ -36,6 +37,7 @@
 #include <Kernel/Scheduler.h>
 #include <Kernel/Time/TimeManagement.h>
 #include <Kernel/TimerQueue.h>
+#include <Kernel/VM/MemoryManager.h>
 
 // Remove this once SMP is stable and can be enabled by default
 #define SCHEDULE_ON_ALL_PROCESSORS 0
@@ -75,15 +77,28 @@ READONLY_AFTER_INIT static Process* s_colonel_process;
 struct ThreadReadyQueue {
     IntrusiveList<Thread, RawPtr<Thread>, &Thread::m_ready_queue_node> thread_list;
 };
-static SpinLock<u8> g_ready_queues_lock;
-static u32 g_ready_queues_mask;
-static constexpr u32 g_ready_queue_buckets = sizeof(g_ready_queues_mask) * 8;
-READONLY_AFTER_INIT static ThreadReadyQueue* g_ready_queues; // g_ready_queue_buckets entries
+static constexpr u32 g_ready_queue_buckets = sizeof(u32) * 8;
+
+// Each processor owns one set of ready queues. A thread is placed on exactly
+// one processor's queues, and idle processors steal from their peers.
+struct ProcessorReadyQueues {
+    SpinLock<u8> lock;
+    u32 mask { 0 };
+    Atomic<u32, AK::MemoryOrder::memory_order_relaxed> thread_count { 0 };
+    ThreadReadyQueue queues[g_ready_queue_buckets];
+};
+static constexpr u32 g_max_ready_queue_processors = sizeof(u32) * 8; // Thread affinity masks are 32 bits wide
+READONLY_AFTER_INIT static ProcessorReadyQueues* g_ready_queues; // g_max_ready_queue_processors entries
+
+// Don't move a thread away from the processor it last ran on (and whose caches
+// are likely still warm) unless that processor has this many more threads
+// waiting than the least loaded one.
+static constexpr u32 g_cache_affinity_imbalance = 2;
 
 static inline u32 thread_priority_to_priority_index(u32 thread_priority)
 {
     // Converts the priority in the range of THREAD_PRIORITY_MIN...THREAD_PRIORITY_MAX
-    // to a index into g_ready_queues where 0 is the highest priority bucket
+    // to a index into ProcessorReadyQueues::queues where 0 is the highest priority bucket
     VERIFY(thread_priority >= THREAD_PRIORITY_MIN && thread_priority <= THREAD_PRIORITY_MAX);
     constexpr u32 thread_priority_count = THREAD_PRIORITY_MAX - THREAD_PRIORITY_MIN + 1;
     static_assert(thread_priority_count > 0);
@@ -92,41 +107,109 @@ static inline u32 thread_priority_to_priority_index(u32 thread_priority)
     return priority_bucket;
 }
 
+static ProcessorReadyQueues& ready_queues_for(u32 cpu)
+{
+    VERIFY(cpu < g_max_ready_queue_processors);
+    return g_ready_queues[cpu];
+}
+
+static u32 ready_queue_processor_count()
+{
+    return min(Processor::count(), g_max_ready_queue_processors);
+}
+
+static u32 select_processor_for([[maybe_unused]] const Thread& thread)
+{
+#if SCHEDULE_ON_ALL_PROCESSORS
+    auto affinity = thread.affinity();
+    auto last_cpu = thread.cpu();
+    auto processor_count = ready_queue_processor_count();
+
+    u32 least_loaded_cpu = 0;
+    u32 least_load = NumericLimits<u32>::max();
+    for (u32 cpu = 0; cpu < processor_count; cpu++) {
+        if (!(affinity & (1u << cpu)))
+            continue;
+        auto load = ready_queues_for(cpu).thread_count.load();
+        if (load < least_load) {
+            least_load = load;
+            least_loaded_cpu = cpu;
+        }
+    }
+    VERIFY(least_load != NumericLimits<u32>::max());
+
+    if (last_cpu < processor_count && (affinity & (1u << last_cpu))) {
+        if (ready_queues_for(last_cpu).thread_count.load() < least_load + g_cache_affinity_imbalance)
+            return last_cpu;
+    }
+    return least_loaded_cpu;
+#else
+    // Only the BSP runs the scheduler, keep everything on its queues.
+    return 0;
+#endif
+}
+
 Thread& Scheduler::pull_next_runnable_thread()
 {
-    auto affinity_mask = 1u << Processor::current().id();
-
-    ScopedSpinLock lock(g_ready_queues_lock);
-    auto priority_mask = g_ready_queues_mask;
-    while (priority_mask != 0) {
-        auto priority = __builtin_ffsl(priority_mask);
-        VERIFY(priority > 0);
-        auto& ready_queue = g_ready_queues[--priority];
-        for (auto& thread : ready_queue.thread_list) {
-            VERIFY(thread.m_runnable_priority == (int)priority);
-            if (thread.is_active())
-                continue;
-            if (!(thread.affinity() & affinity_mask))
-                continue;
-            thread.m_runnable_priority = -1;
-            ready_queue.thread_list.remove(thread);
-            if (ready_queue.thread_list.is_empty())
-                g_ready_queues_mask &= ~(1u << priority);
-            // Mark it as active because we are using this thread. This is similar
-            // to comparing it with Processor::current_thread, but when there are
-            // multiple processors there's no easy way to check whether the thread
-            // is actually still needed. This prevents accidental finalization when
-            // a thread is no longer in Running state, but running on another core.
-
-            // We need to mark it active here so that this thread won't be
-            // scheduled on another core if it were to be queued before actually
-            // switching to it.
-            // FIXME: Figure out a better way maybe?
-            thread.set_active(true);
-            return thread;
+    auto cpu = Processor::current().id();
+    auto affinity_mask = 1u << cpu;
+
+    auto take_next_runnable_thread = [&](ProcessorReadyQueues& ready_queues) -> Thread* {
+        ScopedSpinLock lock(ready_queues.lock);
+        auto priority_mask = ready_queues.mask;
+        while (priority_mask != 0) {
+            auto priority = __builtin_ffsl(priority_mask);
+            VERIFY(priority > 0);
+            auto& ready_queue = ready_queues.queues[--priority];
+            for (auto& thread : ready_queue.thread_list) {
+                VERIFY(thread.m_runnable_priority == (int)priority);
+                if (thread.is_active())
+                    continue;
+                if (!(thread.affinity() & affinity_mask))
+                    continue;
+                thread.m_runnable_priority = -1;
+                ready_queue.thread_list.remove(thread);
+                if (ready_queue.thread_list.is_empty())
+                    ready_queues.mask &= ~(1u << priority);
+                ready_queues.thread_count--;
+                // Mark it as active because we are using this thread. This is similar
+                // to comparing it with Processor::current_thread, but when there are
+                // multiple processors there's no easy way to check whether the thread
+                // is actually still needed. This prevents accidental finalization when
+                // a thread is no longer in Running state, but running on another core.
+
+                // We need to mark it active here so that this thread won't be
+                // scheduled on another core if it were to be queued before actually
+                // switching to it.
+                // FIXME: Figure out a better way maybe?
+                thread.set_active(true);
+                return &thread;
+            }
+            priority_mask &= ~(1u << priority);
+        }
+        return nullptr;
+    };
+
+    if (auto* thread = take_next_runnable_thread(ready_queues_for(cpu)))
+        return *thread;
+
+#if SCHEDULE_ON_ALL_PROCESSORS
+    // Our own queues are empty, try to steal work from the other processors.
+    // Start with our neighbor so that idle processors don't all pile onto
+    // the same victim.
+    auto processor_count = ready_queue_processor_count();
+    for (u32 i = 1; i < processor_count; i++) {
+        auto victim_cpu = (cpu + i) % processor_count;
+        auto& victim = ready_queues_for(victim_cpu);
+        if (victim.thread_count.load() == 0)
+            continue;
+        if (auto* thread = take_next_runnable_thread(victim)) {
+            dbgln_if(SCHEDULER_DEBUG, "Scheduler[{}]: Stole {} from processor {}", cpu, *thread, victim_cpu);
+            return *thread;
         }
-        priority_mask &= ~(1u << priority);
     }
+#endif
+
     return *Processor::current().idle_thread();
 }
 
@@ -134,23 +217,32 @@ bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
 {
     if (&thread == Processor::current().idle_thread())
         return true;
-    ScopedSpinLock lock(g_ready_queues_lock);
-    auto priority = thread.m_runnable_priority;
-    if (priority < 0) {
-        VERIFY(!thread.m_ready_queue_node.is_in_list());
-        return false;
-    }
 
-    if (check_affinity && !(thread.affinity() & (1 << Processor::current().id())))
-        return false;
+    for (;;) {
+        auto cpu = thread.m_runnable_cpu;
+        auto& ready_queues = ready_queues_for(cpu);
+        ScopedSpinLock lock(ready_queues.lock);
+        if (thread.m_runnable_cpu != cpu)
+            continue; // The thread moved to a different processor's queues, try again
+
+        auto priority = thread.m_runnable_priority;
+        if (priority < 0) {
+            VERIFY(!thread.m_ready_queue_node.is_in_list());
+            return false;
+        }
 
-    VERIFY(g_ready_queues_mask & (1u << priority));
-    auto& ready_queue = g_ready_queues[priority];
-    thread.m_runnable_priority = -1;
-    ready_queue.thread_list.remove(thread);
-    if (ready_queue.thread_list.is_empty())
-        g_ready_queues_mask &= ~(1u << priority);
-    return true;
+        if (check_affinity && !(thread.affinity() & (1 << Processor::current().id())))
+            return false;
+
+        VERIFY(ready_queues.mask & (1u << priority));
+        auto& ready_queue = ready_queues.queues[priority];
+        thread.m_runnable_priority = -1;
+        ready_queue.thread_list.remove(thread);
+        if (ready_queue.thread_list.is_empty())
+            ready_queues.mask &= ~(1u << priority);
+        ready_queues.thread_count--;
+        return true;
+    }
 }
 
 void Scheduler::queue_runnable_thread(Thread& thread)
@@ -159,16 +251,20 @@ void Scheduler::queue_runnable_thread(Thread& thread)
     if (&thread == Processor::current().idle_thread())
         return;
     auto priority = thread_priority_to_priority_index(thread.priority());
+    auto cpu = select_processor_for(thread);
 
-    ScopedSpinLock lock(g_ready_queues_lock);
+    auto& ready_queues = ready_queues_for(cpu);
+    ScopedSpinLock lock(ready_queues.lock);
     VERIFY(thread.m_runnable_priority < 0);
     thread.m_runnable_priority = (int)priority;
+    thread.m_runnable_cpu = cpu;
     VERIFY(!thread.m_ready_queue_node.is_in_list());
-    auto& ready_queue = g_ready_queues[priority];
+    auto& ready_queue = ready_queues.queues[priority];
     bool was_empty = ready_queue.thread_list.is_empty();
     ready_queue.thread_list.append(thread);
     if (was_empty)
-        g_ready_queues_mask |= (1u << priority);
+        ready_queues.mask |= (1u << priority);
+    ready_queues.thread_count++;
 }
 
 UNMAP_AFTER_INIT void Scheduler::start()
@@ -497,7 +593,7 @@ UNMAP_AFTER_INIT void Scheduler::initialize()
 
     RefPtr<Thread> idle_thread;
     g_finalizer_wait_queue = new WaitQueue;
-    g_ready_queues = new ThreadReadyQueue[g_ready_queue_buckets];
+    g_ready_queues = new ProcessorReadyQueues[g_max_ready_queue_processors];
 
     g_finalizer_has_work.store(false, AK::MemoryOrder::memory_order_release);
     s_colonel_process = Process::create_kernel_process(idle_thread, "colonel", idle_loop, nullptr, 1).leak_ref();
@@ -619,6 +715,9 @@ void Scheduler::idle_loop(void*)
     VERIFY(are_interrupts_enabled());
 
     for (;;) {
+        // Nothing else wants this CPU, so use it to zero some pages ahead of time.
+        MM.refill_zeroed_page_pool();
+
         proc.idle_begin();
         asm("hlt");
 
@@ -25,6 +25,7 @@
  */
 
 #include <Kernel/Debug.h>
+#include <Kernel/FileSystem/FIFO.h>
 #include <Kernel/FileSystem/FileDescription.h>
 #include <Kernel/Process.h>
 
@@ -62,6 +63,21 @@ KResultOr<int> Process::sys$fcntl(int fd, int cmd, u32 arg)
         break;
     case F_ISTTY:
         return description->is_tty();
+    case F_GETPIPE_SZ: {
+        auto* fifo = description->fifo();
+        if (!fifo)
+            return EBADF;
+        return fifo->buffer_capacity();
+    }
+    case F_SETPIPE_SZ: {
+        auto* fifo = description->fifo();
+        if (!fifo)
+            return EBADF;
+        auto result = fifo->set_buffer_capacity(arg);
+        if (result.is_error())
+            return result;
+        return fifo->buffer_capacity();
+    }
     default:
         return EINVAL;
     }
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/NumericLimits.h>
+#include <Kernel/FileSystem/FileDescription.h>
+#include <Kernel/FileSystem/Inode.h>
+#include <Kernel/KBuffer.h>
+#include <Kernel/Net/Socket.h>
+#include <Kernel/Process.h>
+
+namespace Kernel {
+
+using BlockFlags = Thread::FileBlocker::BlockFlags;
+
+// Anything that isn't going out through a socket bounces through a kernel buffer of this size.
+static constexpr size_t splice_buffer_size = 64 * KiB;
+
+KResultOr<ssize_t> Process::do_splice(FileDescription& out, Optional<u64> out_offset, FileDescription& in, u64 in_offset, size_t count, bool may_block)
+{
+    OwnPtr<KBuffer> bounce_buffer;
+    bool may_block_on_output = may_block && out.is_blocking();
+    size_t total_nwritten = 0;
+    while (total_nwritten < count) {
+        if (!in.can_read()) {
+            if (total_nwritten > 0)
+                break;
+            if (!may_block || !in.is_blocking())
+                return EAGAIN;
+            auto unblock_flags = BlockFlags::None;
+            if (Thread::current()->block<Thread::ReadBlocker>({}, in, unblock_flags).was_interrupted())
+                return EINTR;
+            if (!has_flag(unblock_flags, BlockFlags::Read))
+                return EAGAIN;
+        }
+        if (!out.can_write()) {
+            if (!may_block_on_output) {
+                if (total_nwritten > 0)
+                    break;
+                return EAGAIN;
+            }
+            auto unblock_flags = BlockFlags::None;
+            if (Thread::current()->block<Thread::WriteBlocker>({}, out, unblock_flags).was_interrupted()) {
+                if (total_nwritten > 0)
+                    break;
+                return EINTR;
+            }
+        }
+
+        size_t remaining = count - total_nwritten;
+        if (out.is_socket() && !out_offset.has_value()) {
+            auto nsent_or_error = out.socket()->send_from(out, in, in_offset + total_nwritten, remaining);
+            if (!nsent_or_error.is_error()) {
+                if (nsent_or_error.value() == 0)
+                    break;
+                total_nwritten += nsent_or_error.value();
+                continue;
+            }
+            if (nsent_or_error.error() != -ENOTSUP) {
+                if (total_nwritten > 0)
+                    break;
+                return nsent_or_error.error();
+            }
+        }
+
+        if (!bounce_buffer) {
+            bounce_buffer = KBuffer::try_create_with_size(splice_buffer_size, Region::Access::Read | Region::Access::Write, "splice");
+            if (!bounce_buffer)
+                return ENOMEM;
+        }
+        auto buffer = UserOrKernelBuffer::for_kernel_buffer(bounce_buffer->data());
+        size_t chunk_size = min(remaining, splice_buffer_size);
+        // Whatever is read from a pipe or socket can't be put back, so only take out
+        // as much as the output can take right now. Nothing is left over that way.
+        bool consumes_input = !in.file().is_seekable();
+        if (consumes_input) {
+            chunk_size = min(chunk_size, out.space_for_writing());
+            if (chunk_size == 0) {
+                if (total_nwritten > 0)
+                    break;
+                // An output that is ready but has no room, like a pipe without readers,
+                // is going to fail the write. Let it say why.
+                if (out.can_write()) {
+                    auto result = out.write(buffer, 0);
+                    if (result.is_error())
+                        return result.error();
+                }
+                if (!may_block_on_output)
+                    return EAGAIN;
+                continue;
+            }
+        }
+        auto nread_or_error = in.read(buffer, in_offset + total_nwritten, chunk_size);
+        if (nread_or_error.is_error()) {
+            if (total_nwritten > 0)
+                break;
+            return nread_or_error.error();
+        }
+        size_t nread = nread_or_error.value();
+        if (nread == 0)
+            break;
+
+        // Once input has been consumed, stopping early must report what made it out
+        // rather than EAGAIN or EINTR, which would claim that nothing happened.
+        size_t nwritten = 0;
+        while (nwritten < nread) {
+            if (!out.can_write()) {
+                bool may_fail = !consumes_input && total_nwritten + nwritten == 0;
+                if (!may_block_on_output) {
+                    if (may_fail)
+                        return EAGAIN;
+                    break;
+                }
+                auto unblock_flags = BlockFlags::None;
+                if (Thread::current()->block<Thread::WriteBlocker>({}, out, unblock_flags).was_interrupted()) {
+                    if (may_fail)
+                        return EINTR;
+                    break;
+                }
+            }
+            auto data = buffer.offset(nwritten);
+            auto result = out_offset.has_value()
+                ? out.write(data, out_offset.value() + total_nwritten + nwritten, nread - nwritten)
+                : out.write(data, nread - nwritten);
+            if (result.is_error()) {
+                if (total_nwritten + nwritten > 0)
+                    break;
+                return result.error();
+            }
+            if (result.value() == 0)
+                break;
+            nwritten += result.value();
+        }
+        total_nwritten += nwritten;
+        if (nwritten < nread)
+            break;
+    }
+    return total_nwritten;
+}
+
+KResultOr<ssize_t> Process::sys$sendfile(Userspace<const Syscall::SC_sendfile_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_sendfile_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    auto in_description = file_description(params.in_fd);
+    if (!in_description)
+        return EBADF;
+    if (!in_description->is_readable())
+        return EBADF;
+    auto out_description = file_description(params.out_fd);
+    if (!out_description)
+        return EBADF;
+    if (!out_description->is_writable())
+        return EBADF;
+
+    // The input has to be something we can read at an arbitrary offset, like on other systems.
+    if (!in_description->file().is_seekable() || in_description->is_directory())
+        return EINVAL;
+
+    off_t offset;
+    if (params.offset) {
+        if (!copy_from_user(&offset, params.offset))
+            return EFAULT;
+        if (offset < 0)
+            return EINVAL;
+    } else {
+        offset = in_description->offset();
+    }
+
+    size_t count = min(params.count, (size_t)NumericLimits<i32>::max());
+    if (in_description->file().is_inode()) {
+        off_t size = in_description->inode()->size();
+        count = offset < size ? min(count, (size_t)(size - offset)) : 0;
+    }
+    if (count == 0)
+        return 0;
+
+    auto nwritten_or_error = do_splice(*out_description, {}, *in_description, offset, count, true);
+    if (nwritten_or_error.is_error())
+        return nwritten_or_error.error();
+
+    offset += nwritten_or_error.value();
+    if (params.offset) {
+        if (!copy_to_user(params.offset, &offset))
+            return EFAULT;
+    } else {
+        auto seek_result = in_description->seek(offset, SEEK_SET);
+        if (seek_result.is_error())
+            return seek_result.error();
+    }
+    return nwritten_or_error.value();
+}
+
+KResultOr<ssize_t> Process::sys$splice(Userspace<const Syscall::SC_splice_params*> user_params)
+{
+    REQUIRE_PROMISE(stdio);
+
+    Syscall::SC_splice_params params;
+    if (!copy_from_user(&params, user_params))
+        return EFAULT;
+
+    if (params.flags & ~(SPLICE_F_MOVE | SPLICE_F_NONBLOCK | SPLICE_F_MORE))
+        return EINVAL;
+
+    auto in_description = file_description(params.fd_in);
+    if (!in_description)
+        return EBADF;
+    if (!in_description->is_readable())
+        return EBADF;
+    auto out_description = file_description(params.fd_out);
+    if (!out_description)
+        return EBADF;
+    if (!out_description->is_writable())
+        return EBADF;
+
+    // One end has to be a pipe.
+    if (!in_description->is_fifo() && !out_description->is_fifo())
+        return EINVAL;
+    if (in_description->is_directory() || out_description->is_directory())
+        return EINVAL;
+
+    bool in_is_seekable = in_description->file().is_seekable();
+    u64 in_offset = 0;
+    if (params.off_in) {
+        if (!in_is_seekable)
+            return ESPIPE;
+        off_t offset;
+        if (!copy_from_user(&offset, params.off_in))
+            return EFAULT;
+        if (offset < 0)
+            return EINVAL;
+        in_offset = offset;
+    } else if (in_is_seekable) {
+        in_offset = in_description->offset();
+    }
+
+    Optional<u64> out_offset;
+    if (params.off_out) {
+        if (!out_description->file().is_seekable())
+            return ESPIPE;
+        off_t offset;
+        if (!copy_from_user(&offset, params.off_out))
+            return EFAULT;
+        if (offset < 0)
+            return EINVAL;
+        out_offset = offset;
+    } else if (out_description->should_append() && out_description->file().is_seekable()) {
+        auto seek_result = out_description->seek(0, SEEK_END);
+        if (seek_result.is_error())
+            return seek_result.error();
+    }
+
+    size_t count = min(params.length, (size_t)NumericLimits<i32>::max());
+    if (count == 0)
+        return 0;
+
+    auto nwritten_or_error = do_splice(*out_description, out_offset, *in_description, in_offset, count, !(params.flags & SPLICE_F_NONBLOCK));
+    if (nwritten_or_error.is_error())
+        return nwritten_or_error.error();
+    size_t nwritten = nwritten_or_error.value();
+
+    if (params.off_in) {
+        off_t offset = in_offset + nwritten;
+        if (!copy_to_user(params.off_in, &offset))
+            return EFAULT;
+    } else if (in_is_seekable) {
+        auto seek_result = in_description->seek(in_offset + nwritten, SEEK_SET);
+        if (seek_result.is_error())
+            return seek_result.error();
+    }
+    if (params.off_out) {
+        off_t offset = out_offset.value() + nwritten;
+        if (!copy_to_user(params.off_out, &offset))
+            return EFAULT;
+    }
+    return nwritten;
+}
+
+}
@@ -41,7 +41,8 @@ KResultOr<int> Process::sys$reboot()
     dbgln("acquiring FS locks...");
     FS::lock_all();
     dbgln("syncing mounted filesystems...");
-    FS::sync();
+    if (FS::sync().is_error())
+        dbgln("failed to sync some filesystems, data may be lost");
     dbgln("attempting reboot via ACPI");
     if (ACPI::is_enabled())
         ACPI::Parser::the()->try_acpi_reboot();
@@ -61,7 +62,8 @@ KResultOr<int> Process::sys$halt()
     dbgln("acquiring FS locks...");
     FS::lock_all();
     dbgln("syncing mounted filesystems...");
-    FS::sync();
+    if (FS::sync().is_error())
+        dbgln("failed to sync some filesystems, data may be lost");
     dbgln("attempting system shutdown...");
     // QEMU Shutdown
     IO::out16(0x604, 0x2000);
@@ -32,7 +32,8 @@ namespace Kernel {
 KResultOr<int> Process::sys$sync()
 {
     REQUIRE_PROMISE(stdio);
-    VFS::the().sync();
+    if (auto result = VFS::the().sync(); result.is_error())
+        return result;
     return 0;
 }
 
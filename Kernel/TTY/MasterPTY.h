@@ -28,7 +28,7 @@
 
 #include <AK/Badge.h>
 #include <Kernel/Devices/CharacterDevice.h>
-#include <Kernel/DoubleBuffer.h>
+#include <Kernel/RingBuffer.h>
 
 namespace Kernel {
 
@@ -66,7 +66,7 @@ private:
     RefPtr<SlavePTY> m_slave;
     unsigned m_index;
     bool m_closed { false };
-    DoubleBuffer m_buffer;
+    RingBuffer m_buffer;
     String m_pts_name;
 };
 
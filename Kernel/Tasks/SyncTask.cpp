@@ -24,23 +24,39 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <Kernel/FileSystem/VirtualFileSystem.h>
+#include <Kernel/FileSystem/FileSystem.h>
 #include <Kernel/Process.h>
 #include <Kernel/Tasks/SyncTask.h>
 #include <Kernel/Time/TimeManagement.h>
+#include <Kernel/VM/SharedInodeVMObject.h>
+#include <Kernel/WaitQueue.h>
 
 namespace Kernel {
 
+static constexpr Time writeback_interval = Time::from_milliseconds(500);
+
+static WaitQueue* s_writeback_wait_queue;
+
 void SyncTask::spawn()
 {
+    s_writeback_wait_queue = new WaitQueue;
+
     RefPtr<Thread> syncd_thread;
     Process::create_kernel_process(syncd_thread, "SyncTask", [] {
         dbgln("SyncTask is running");
         for (;;) {
-            VFS::the().sync();
-            (void)Thread::current()->sleep(Time::from_seconds(1));
+            FS::write_back_all();
+            SharedInodeVMObject::trim_page_cache();
+            auto timeout = Thread::BlockTimeout(false, &writeback_interval);
+            (void)Thread::current()->wait_on(*s_writeback_wait_queue, timeout, "SyncTask");
         }
     });
 }
 
+void SyncTask::request_writeback()
+{
+    if (s_writeback_wait_queue)
+        s_writeback_wait_queue->wake_all();
+}
+
 }
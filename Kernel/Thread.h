@@ -1131,6 +1131,7 @@ private:
 
     IntrusiveListNode<Thread> m_process_thread_list_node;
     int m_runnable_priority { -1 };
+    u32 m_runnable_cpu { 0 };
 
     friend class WaitQueue;
 
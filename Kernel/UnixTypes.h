@@ -114,9 +114,15 @@ enum {
 #define F_GETFL 3
 #define F_SETFL 4
 #define F_ISTTY 5
+#define F_GETPIPE_SZ 8
+#define F_SETPIPE_SZ 9
 
 #define FD_CLOEXEC 1
 
+#define SPLICE_F_MOVE (1 << 0)
+#define SPLICE_F_NONBLOCK (1 << 1)
+#define SPLICE_F_MORE (1 << 2)
+
 #define _FUTEX_OP_SHIFT_OP 28
 #define _FUTEX_OP_MASK_OP 0xf
 #define _FUTEX_OP_SHIFT_CMP 24
@@ -486,6 +492,31 @@ struct pollfd {
     short revents;
 };
 
+#define EPOLLIN (1u << 0)
+#define EPOLLPRI (1u << 1)
+#define EPOLLOUT (1u << 2)
+#define EPOLLERR (1u << 3)
+#define EPOLLHUP (1u << 4)
+#define EPOLLRDHUP (1u << 13)
+#define EPOLLONESHOT (1u << 30)
+#define EPOLLET (1u << 31)
+
+#define EPOLL_CTL_ADD 1
+#define EPOLL_CTL_DEL 2
+#define EPOLL_CTL_MOD 3
+
+typedef union epoll_data {
+    void* ptr;
+    int fd;
+    ::u32 u32;
+    ::u64 u64;
+} epoll_data_t;
+
+struct epoll_event {
+    u32 events;
+    epoll_data_t data;
+};
+
 #define AF_MASK 0xff
 #define AF_UNSPEC 0
 #define AF_LOCAL 1
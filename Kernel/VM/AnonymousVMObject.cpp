@@ -106,8 +106,7 @@ AnonymousVMObject::AnonymousVMObject(size_t size, AllocationStrategy strategy)
 {
     if (strategy == AllocationStrategy::AllocateNow) {
         // Allocate all pages right now. We know we can get all because we committed the amount needed
-        for (size_t i = 0; i < page_count(); ++i)
-            physical_pages()[i] = MM.allocate_committed_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
+        MM.allocate_committed_user_physical_pages(physical_pages().span(), MemoryManager::ShouldZeroFill::Yes);
     } else {
         auto& initial_page = (strategy == AllocationStrategy::Reserve) ? MM.lazy_committed_page() : MM.shared_zero_page();
         for (size_t i = 0; i < page_count(); ++i)
@@ -412,6 +411,16 @@ RefPtr<PhysicalPage> AnonymousVMObject::allocate_committed_page(size_t page_inde
     return MM.allocate_committed_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
 }
 
+void AnonymousVMObject::allocate_committed_pages(Span<RefPtr<PhysicalPage>> pages)
+{
+    {
+        ScopedSpinLock lock(m_lock);
+        VERIFY(m_unused_committed_pages >= pages.size());
+        m_unused_committed_pages -= pages.size();
+    }
+    MM.allocate_committed_user_physical_pages(pages, MemoryManager::ShouldZeroFill::Yes);
+}
+
 Bitmap& AnonymousVMObject::ensure_cow_map()
 {
     if (m_cow_map.is_null())
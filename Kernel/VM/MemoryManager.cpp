@@ -29,6 +29,7 @@
 #include <AK/StringView.h>
 #include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/CMOS.h>
+#include <Kernel/CommandLine.h>
 #include <Kernel/FileSystem/Inode.h>
 #include <Kernel/Heap/kmalloc.h>
 #include <Kernel/Multiboot.h>
@@ -66,6 +67,9 @@ namespace Kernel {
 static MemoryManager* s_the;
 RecursiveSpinLock s_mm_lock;
 
+// How many pages to take back from the inode page caches when we run out of memory.
+static constexpr size_t page_cache_reclaim_batch_size = 64;
+
 MemoryManager& MM
 {
     return *s_the;
@@ -80,6 +84,8 @@ UNMAP_AFTER_INIT MemoryManager::MemoryManager()
 {
     ScopedSpinLock lock(s_mm_lock);
     m_kernel_page_directory = PageDirectory::create_kernel_page_directory();
+    m_fault_around_page_count = max(kernel_command_line().fault_around_page_count(), static_cast<size_t>(1));
+    VERIFY(m_fault_around_page_count <= max_fault_around_page_count);
     parse_memory_map();
     write_cr3(kernel_page_directory().cr3());
     protect_kernel_image();
@@ -567,31 +573,104 @@ void MemoryManager::uncommit_user_physical_pages(size_t page_count)
     m_user_physical_pages_committed -= page_count;
 }
 
+void MemoryManager::return_user_physical_page_to_region(PhysicalAddress paddr)
+{
+    VERIFY(s_mm_lock.own_lock());
+    for (auto& region : m_user_physical_regions) {
+        if (!region.contains(paddr))
+            continue;
+        region.return_page(paddr);
+        return;
+    }
+
+    dmesgln("MM: deallocate_user_physical_page couldn't figure out region for user page @ {}", paddr);
+    VERIFY_NOT_REACHED();
+}
+
 void MemoryManager::deallocate_user_physical_page(const PhysicalPage& page)
 {
     ScopedSpinLock lock(s_mm_lock);
+    --m_user_physical_pages_used;
+
+    // Always return pages to the uncommitted pool. Pages that were
+    // committed and allocated are only freed upon request. Once
+    // returned there is no guarantee being able to get them back.
+    ++m_user_physical_pages_uncommitted;
+
+    auto& mm_data = get_data();
+    if (mm_data.m_hot_page_count == MemoryManagerData::hot_page_cache_size) {
+        // The cache is full, hand the oldest batch back to the buddy allocator so it can coalesce them.
+        for (size_t i = 0; i < MemoryManagerData::hot_page_cache_batch_size; ++i)
+            return_user_physical_page_to_region(mm_data.m_hot_pages[i]);
+        mm_data.m_hot_page_count -= MemoryManagerData::hot_page_cache_batch_size;
+        memmove(mm_data.m_hot_pages, mm_data.m_hot_pages + MemoryManagerData::hot_page_cache_batch_size, mm_data.m_hot_page_count * sizeof(PhysicalAddress));
+    }
+    mm_data.m_hot_pages[mm_data.m_hot_page_count++] = page.paddr();
+}
+
+void MemoryManager::drain_hot_page_caches()
+{
+    VERIFY(s_mm_lock.own_lock());
+    Processor::for_each([&](Processor& processor) {
+        if (!processor.has_mm_data())
+            return IterationDecision::Continue;
+        auto& mm_data = processor.get_mm_data();
+        for (size_t i = 0; i < mm_data.m_hot_page_count; ++i)
+            return_user_physical_page_to_region(mm_data.m_hot_pages[i]);
+        mm_data.m_hot_page_count = 0;
+        return IterationDecision::Continue;
+    });
+}
+
+size_t MemoryManager::take_free_user_physical_pages(Span<PhysicalAddress> addresses)
+{
+    VERIFY(s_mm_lock.own_lock());
+    size_t taken = 0;
     for (auto& region : m_user_physical_regions) {
-        if (!region.contains(page))
-            continue;
+        if (taken == addresses.size())
+            break;
+        taken += region.take_free_pages(addresses.slice(taken));
+    }
+    return taken;
+}
 
-        region.return_page(page);
-        --m_user_physical_pages_used;
+Optional<PhysicalAddress> MemoryManager::take_free_user_physical_page_address(ShouldZeroFill should_zero_fill, bool& is_zeroed)
+{
+    VERIFY(s_mm_lock.own_lock());
+    is_zeroed = false;
+    if (should_zero_fill == ShouldZeroFill::Yes) {
+        if (m_zeroed_page_count > 0) {
+            ++m_zeroed_page_pool_hits;
+            is_zeroed = true;
+            return m_zeroed_pages[--m_zeroed_page_count];
+        }
+        ++m_zeroed_page_pool_misses;
+    }
 
-        // Always return pages to the uncommitted pool. Pages that were
-        // committed and allocated are only freed upon request. Once
-        // returned there is no guarantee being able to get them back.
-        ++m_user_physical_pages_uncommitted;
-        return;
+    auto& mm_data = get_data();
+    if (mm_data.m_hot_page_count == 0)
+        mm_data.m_hot_page_count = take_free_user_physical_pages({ mm_data.m_hot_pages, MemoryManagerData::hot_page_cache_batch_size });
+    if (mm_data.m_hot_page_count == 0) {
+        // The physical regions are exhausted, but other processors may still be sitting on
+        // free pages in their caches. Those pages are counted as available by the commit
+        // accounting, so pull them back before giving up.
+        drain_hot_page_caches();
+        mm_data.m_hot_page_count = take_free_user_physical_pages({ mm_data.m_hot_pages, MemoryManagerData::hot_page_cache_batch_size });
     }
+    if (mm_data.m_hot_page_count > 0)
+        return mm_data.m_hot_pages[--mm_data.m_hot_page_count];
 
-    dmesgln("MM: deallocate_user_physical_page couldn't figure out region for user page @ {}", page.paddr());
-    VERIFY_NOT_REACHED();
+    // The zeroed pages are free memory too, so they're the last resort for everyone else.
+    if (m_zeroed_page_count > 0) {
+        is_zeroed = true;
+        return m_zeroed_pages[--m_zeroed_page_count];
+    }
+    return {};
 }
 
-RefPtr<PhysicalPage> MemoryManager::find_free_user_physical_page(bool committed)
+RefPtr<PhysicalPage> MemoryManager::find_free_user_physical_page(bool committed, ShouldZeroFill should_zero_fill)
 {
     VERIFY(s_mm_lock.is_locked());
-    RefPtr<PhysicalPage> page;
     if (committed) {
         // Draw from the committed pages pool. We should always have these pages available
         VERIFY(m_user_physical_pages_committed > 0);
@@ -602,33 +681,81 @@ RefPtr<PhysicalPage> MemoryManager::find_free_user_physical_page(bool committed)
             return {};
         m_user_physical_pages_uncommitted--;
     }
-    for (auto& region : m_user_physical_regions) {
-        page = region.take_free_page(false);
-        if (!page.is_null()) {
-            ++m_user_physical_pages_used;
-            break;
-        }
+
+    bool is_zeroed = false;
+    auto paddr = take_free_user_physical_page_address(should_zero_fill, is_zeroed);
+    VERIFY(!committed || paddr.has_value());
+    if (!paddr.has_value())
+        return {};
+
+    auto page = PhysicalPage::create(paddr.value(), false);
+    ++m_user_physical_pages_used;
+    if (should_zero_fill == ShouldZeroFill::Yes && !is_zeroed) {
+        auto* ptr = quickmap_page(*page);
+        memset(ptr, 0, PAGE_SIZE);
+        unquickmap_page();
     }
-    VERIFY(!committed || !page.is_null());
     return page;
 }
 
+void MemoryManager::allocate_committed_user_physical_pages(Span<RefPtr<PhysicalPage>> pages, ShouldZeroFill should_zero_fill)
+{
+    // Everything happens in one lock hold; the hot page cache refills itself
+    // from the physical regions in batches of whole buddy blocks.
+    ScopedSpinLock lock(s_mm_lock);
+    for (auto& page : pages)
+        page = find_free_user_physical_page(true, should_zero_fill);
+}
+
 NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_user_physical_page(ShouldZeroFill should_zero_fill)
 {
     ScopedSpinLock lock(s_mm_lock);
-    auto page = find_free_user_physical_page(true);
-    if (should_zero_fill == ShouldZeroFill::Yes) {
-        auto* ptr = quickmap_page(*page);
-        memset(ptr, 0, PAGE_SIZE);
+    return find_free_user_physical_page(true, should_zero_fill).release_nonnull();
+}
+
+// Zeroes a page with non-temporal stores, so that filling the pool doesn't
+// evict everybody else's working set from the caches.
+static void zero_page_non_temporal(u8* page)
+{
+    if (!Processor::current().has_feature(CPUFeature::SSE2)) {
+        memset(page, 0, PAGE_SIZE);
+        return;
+    }
+    for (size_t offset = 0; offset < PAGE_SIZE; offset += 16) {
+        asm volatile(
+            "movnti %1, (%0)\n"
+            "movnti %1, 4(%0)\n"
+            "movnti %1, 8(%0)\n"
+            "movnti %1, 12(%0)\n" ::"r"(page + offset),
+            "r"(0)
+            : "memory");
+    }
+    asm volatile("sfence" ::
+                     : "memory");
+}
+
+void MemoryManager::refill_zeroed_page_pool()
+{
+    // This runs from the idle loop, so only do a few pages at a time and let
+    // interrupts in between, in case someone has real work to do.
+    for (size_t i = 0; i < zeroed_page_pool_refill_batch_size; ++i) {
+        ScopedSpinLock lock(s_mm_lock);
+        if (m_zeroed_page_count >= zeroed_page_pool_size)
+            return;
+        PhysicalAddress paddr;
+        if (!take_free_user_physical_pages({ &paddr, 1 }))
+            return;
+        auto page = PhysicalPage::create(paddr, false, false);
+        zero_page_non_temporal(quickmap_page(*page));
         unquickmap_page();
+        m_zeroed_pages[m_zeroed_page_count++] = paddr;
     }
-    return page.release_nonnull();
 }
 
 RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill should_zero_fill, bool* did_purge)
 {
     ScopedSpinLock lock(s_mm_lock);
-    auto page = find_free_user_physical_page(false);
+    auto page = find_free_user_physical_page(false, should_zero_fill);
     bool purged_pages = false;
 
     if (!page) {
@@ -640,25 +767,24 @@ RefPtr<PhysicalPage> MemoryManager::allocate_user_physical_page(ShouldZeroFill s
             int purged_page_count = static_cast<AnonymousVMObject&>(vmobject).purge_with_interrupts_disabled({});
             if (purged_page_count) {
                 dbgln("MM: Purge saved the day! Purged {} pages from AnonymousVMObject", purged_page_count);
-                page = find_free_user_physical_page(false);
+                page = find_free_user_physical_page(false, should_zero_fill);
                 purged_pages = true;
                 VERIFY(page);
                 return IterationDecision::Break;
             }
             return IterationDecision::Continue;
         });
+        if (!page) {
+            // Next, drop clean pages from the least recently used inode page caches.
+            if (SharedInodeVMObject::reclaim_cached_pages(page_cache_reclaim_batch_size))
+                page = find_free_user_physical_page(false, should_zero_fill);
+        }
         if (!page) {
             dmesgln("MM: no user physical pages available");
             return {};
         }
     }
 
-    if (should_zero_fill == ShouldZeroFill::Yes) {
-        auto* ptr = quickmap_page(*page);
-        memset(ptr, 0, PAGE_SIZE);
-        unquickmap_page();
-    }
-
     if (did_purge)
         *did_purge = purged_pages;
     return page;
@@ -692,7 +818,7 @@ NonnullRefPtrVector<PhysicalPage> MemoryManager::allocate_contiguous_supervisor_
     for (auto& region : m_super_physical_regions) {
         physical_pages = region.take_contiguous_free_pages(count, true, physical_alignment);
         if (!physical_pages.is_empty())
-            continue;
+            break;
     }
 
     if (physical_pages.is_empty()) {
@@ -859,6 +985,23 @@ bool MemoryManager::validate_user_stack(const Process& process, VirtualAddress v
     return region && region->is_user() && region->is_stack();
 }
 
+bool MemoryManager::is_range_mapped(VirtualAddress vaddr, size_t size, bool writable)
+{
+    VERIFY(s_mm_lock.own_lock());
+    auto page_directory = PageDirectory::find_by_cr3(read_cr3());
+    if (!page_directory)
+        return false;
+    ScopedSpinLock page_lock(page_directory->get_lock());
+    for (auto page_vaddr = vaddr.page_base(); page_vaddr < vaddr.offset(size); page_vaddr = page_vaddr.offset(PAGE_SIZE)) {
+        auto* pte = this->pte(*page_directory, page_vaddr);
+        if (!pte || !pte->is_present())
+            return false;
+        if (writable && !pte->is_writable())
+            return false;
+    }
+    return true;
+}
+
 void MemoryManager::register_vmobject(VMObject& vmobject)
 {
     ScopedSpinLock lock(s_mm_lock);
@@ -28,6 +28,7 @@
 
 #include <AK/HashTable.h>
 #include <AK/NonnullRefPtrVector.h>
+#include <AK/Span.h>
 #include <AK/String.h>
 #include <Kernel/Arch/x86/CPU.h>
 #include <Kernel/Forward.h>
@@ -108,11 +109,20 @@ struct PhysicalMemoryRange {
 #define MM Kernel::MemoryManager::the()
 
 struct MemoryManagerData {
+    static constexpr size_t hot_page_cache_size = 64;
+    static constexpr size_t hot_page_cache_batch_size = 32;
+
     SpinLock<u8> m_quickmap_in_use;
     u32 m_quickmap_prev_flags;
 
     PhysicalAddress m_last_quickmap_pd;
     PhysicalAddress m_last_quickmap_pt;
+
+    // Recently freed user pages that are handed out again (LIFO, so they are likely
+    // still cache-hot) before we go back to the physical regions. Only touched with
+    // s_mm_lock held, so an allocating processor can drain other processors' caches.
+    PhysicalAddress m_hot_pages[hot_page_cache_size];
+    size_t m_hot_page_count { 0 };
 };
 
 extern RecursiveSpinLock s_mm_lock;
@@ -125,6 +135,7 @@ class MemoryManager {
     friend class AnonymousVMObject;
     friend class Region;
     friend class ScatterGatherList;
+    friend class SharedInodeVMObject;
     friend class VMObject;
 
 public:
@@ -150,6 +161,10 @@ public:
 
     bool validate_user_stack(const Process&, VirtualAddress) const;
 
+    // Whether the range is mapped in the current page directory, so that accessing it can't fault.
+    // Only stays true while the caller holds the MM lock.
+    bool is_range_mapped(VirtualAddress, size_t, bool writable);
+
     enum class ShouldZeroFill {
         No,
         Yes
@@ -158,6 +173,7 @@ public:
     bool commit_user_physical_pages(size_t);
     void uncommit_user_physical_pages(size_t);
     NonnullRefPtr<PhysicalPage> allocate_committed_user_physical_page(ShouldZeroFill = ShouldZeroFill::Yes);
+    void allocate_committed_user_physical_pages(Span<RefPtr<PhysicalPage>>, ShouldZeroFill = ShouldZeroFill::Yes);
     RefPtr<PhysicalPage> allocate_user_physical_page(ShouldZeroFill = ShouldZeroFill::Yes, bool* did_purge = nullptr);
     RefPtr<PhysicalPage> allocate_supervisor_physical_page();
     NonnullRefPtrVector<PhysicalPage> allocate_contiguous_supervisor_physical_pages(size_t size, size_t physical_alignment = PAGE_SIZE);
@@ -178,6 +194,16 @@ public:
     unsigned super_physical_pages() const { return m_super_physical_pages; }
     unsigned super_physical_pages_used() const { return m_super_physical_pages_used; }
 
+    // Pages zeroed ahead of time by the idle loop, so zero-fill allocations don't have to.
+    void refill_zeroed_page_pool();
+    size_t zeroed_page_pool_count() const { return m_zeroed_page_count; }
+    u32 zeroed_page_pool_hits() const { return m_zeroed_page_pool_hits; }
+    u32 zeroed_page_pool_misses() const { return m_zeroed_page_pool_misses; }
+
+    // How many pages around a faulting page we try to map in on the same fault.
+    static constexpr size_t max_fault_around_page_count = 64;
+    size_t fault_around_page_count() const { return m_fault_around_page_count; }
+
     template<typename Callback>
     static void for_each_vmobject(Callback callback)
     {
@@ -220,7 +246,11 @@ private:
 
     static Region* find_region_from_vaddr(VirtualAddress);
 
-    RefPtr<PhysicalPage> find_free_user_physical_page(bool);
+    RefPtr<PhysicalPage> find_free_user_physical_page(bool committed, ShouldZeroFill = ShouldZeroFill::No);
+    Optional<PhysicalAddress> take_free_user_physical_page_address(ShouldZeroFill, bool& is_zeroed);
+    size_t take_free_user_physical_pages(Span<PhysicalAddress>);
+    void return_user_physical_page_to_region(PhysicalAddress);
+    void drain_hot_page_caches();
     u8* quickmap_page(PhysicalPage&);
     void unquickmap_page();
 
@@ -243,6 +273,15 @@ private:
     Atomic<unsigned, AK::MemoryOrder::memory_order_relaxed> m_super_physical_pages { 0 };
     Atomic<unsigned, AK::MemoryOrder::memory_order_relaxed> m_super_physical_pages_used { 0 };
 
+    size_t m_fault_around_page_count { 1 };
+
+    static constexpr size_t zeroed_page_pool_size = 256;
+    static constexpr size_t zeroed_page_pool_refill_batch_size = 8;
+    PhysicalAddress m_zeroed_pages[zeroed_page_pool_size];
+    size_t m_zeroed_page_count { 0 };
+    Atomic<u32, AK::MemoryOrder::memory_order_relaxed> m_zeroed_page_pool_hits { 0 };
+    Atomic<u32, AK::MemoryOrder::memory_order_relaxed> m_zeroed_page_pool_misses { 0 };
+
     NonnullRefPtrVector<PhysicalRegion> m_user_physical_regions;
     NonnullRefPtrVector<PhysicalRegion> m_super_physical_regions;
 
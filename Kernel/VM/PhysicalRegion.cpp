@@ -29,12 +29,32 @@
 #include <AK/RefPtr.h>
 #include <AK/Vector.h>
 #include <Kernel/Assertions.h>
-#include <Kernel/Random.h>
 #include <Kernel/VM/PhysicalPage.h>
 #include <Kernel/VM/PhysicalRegion.h>
 
 namespace Kernel {
 
+static inline size_t floor_log2(size_t value)
+{
+    VERIFY(value);
+    return sizeof(size_t) * 8 - 1 - __builtin_clzl(value);
+}
+
+static inline size_t ceil_log2(size_t value)
+{
+    VERIFY(value);
+    return value == 1 ? 0 : floor_log2(value - 1) + 1;
+}
+
+// The largest order of a block starting at pfn that fits into count pages.
+static inline size_t largest_block_order(u32 pfn, size_t count)
+{
+    size_t order = min(floor_log2(count), PhysicalRegion::max_order);
+    if (pfn)
+        order = min(order, static_cast<size_t>(count_trailing_zeroes_32(pfn)));
+    return order;
+}
+
 NonnullRefPtr<PhysicalRegion> PhysicalRegion::create(PhysicalAddress lower, PhysicalAddress upper)
 {
     return adopt(*new PhysicalRegion(lower, upper));
@@ -59,133 +79,186 @@ unsigned PhysicalRegion::finalize_capacity()
     VERIFY(!m_pages);
 
     m_pages = (m_upper.get() - m_lower.get()) / PAGE_SIZE;
-    m_bitmap.grow(m_pages, false);
+    m_first_pfn = m_lower.get() / PAGE_SIZE;
+
+    if (m_pages) {
+        u32 last_pfn = m_first_pfn + m_pages - 1;
+        for (size_t order = 0; order <= max_order; ++order)
+            m_free_areas[order].blocks.grow(block_index(last_pfn, order) + 1, false);
+        free_range(m_first_pfn, m_pages);
+    }
 
     return size();
 }
 
-NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count, bool supervisor, size_t physical_alignment)
+bool PhysicalRegion::is_valid_block(u32 pfn, size_t order) const
 {
-    VERIFY(m_pages);
-    VERIFY(m_used != m_pages);
+    return pfn >= m_first_pfn && pfn + (1u << order) <= m_first_pfn + m_pages;
+}
 
-    NonnullRefPtrVector<PhysicalPage> physical_pages;
-    physical_pages.ensure_capacity(count);
+bool PhysicalRegion::is_free_block(u32 pfn, size_t order) const
+{
+    return m_free_areas[order].blocks.get(block_index(pfn, order));
+}
 
-    auto first_contiguous_page = find_contiguous_free_pages(count, physical_alignment);
+void PhysicalRegion::push_free_block(u32 pfn, size_t order)
+{
+    auto& area = m_free_areas[order];
+    area.blocks.set(block_index(pfn, order), true);
+    ++area.free_count;
+    if (area.recently_freed.size() < area.recently_freed.capacity())
+        area.recently_freed.unchecked_append(pfn);
+}
 
-    for (size_t index = 0; index < count; index++)
-        physical_pages.append(PhysicalPage::create(m_lower.offset(PAGE_SIZE * (index + first_contiguous_page)), supervisor));
-    return physical_pages;
+void PhysicalRegion::remove_free_block(u32 pfn, size_t order)
+{
+    // Any stack entry for this block goes stale; take_free_block() skips those.
+    auto& area = m_free_areas[order];
+    area.blocks.set(block_index(pfn, order), false);
+    --area.free_count;
 }
 
-unsigned PhysicalRegion::find_contiguous_free_pages(size_t count, size_t physical_alignment)
+Optional<u32> PhysicalRegion::take_free_block(size_t order)
 {
-    VERIFY(count != 0);
-    VERIFY(physical_alignment % PAGE_SIZE == 0);
-    // search from the last page we allocated
-    auto range = find_and_allocate_contiguous_range(count, physical_alignment / PAGE_SIZE);
-    VERIFY(range.has_value());
-    return range.value();
-}
-
-Optional<unsigned> PhysicalRegion::find_one_free_page()
-{
-    if (m_used == m_pages) {
-        // We know we don't have any free pages, no need to check the bitmap
-        // Check if we can draw one from the return queue
-        if (m_recently_returned.size() > 0) {
-            u8 index = get_fast_random<u8>() % m_recently_returned.size();
-            Checked<FlatPtr> local_offset = m_recently_returned[index].get();
-            local_offset -= m_lower.get();
-            m_recently_returned.remove(index);
-            VERIFY(!local_offset.has_overflow());
-            VERIFY(local_offset.value() < (FlatPtr)(m_pages * PAGE_SIZE));
-            return local_offset.value() / PAGE_SIZE;
-        }
+    auto& area = m_free_areas[order];
+    if (!area.free_count)
         return {};
+
+    while (!area.recently_freed.is_empty()) {
+        auto pfn = area.recently_freed.take_last();
+        if (is_free_block(pfn, order)) {
+            remove_free_block(pfn, order);
+            return pfn;
+        }
     }
-    auto free_index = m_bitmap.find_one_anywhere_unset(m_free_hint);
-    if (!free_index.has_value())
-        return {};
 
-    auto page_index = free_index.value();
-    m_bitmap.set(page_index, true);
-    m_used++;
-    m_free_hint = free_index.value() + 1; // Just a guess
-    if (m_free_hint >= m_bitmap.size())
-        m_free_hint = 0;
-    return page_index;
+    // The stack overflowed at some point, so there are free blocks that only the bitmap knows about.
+    auto index = area.blocks.find_one_anywhere_set(area.scan_hint);
+    VERIFY(index.has_value());
+    area.scan_hint = index.value();
+    u32 pfn = ((m_first_pfn >> order) + index.value()) << order;
+    remove_free_block(pfn, order);
+    return pfn;
 }
 
-Optional<unsigned> PhysicalRegion::find_and_allocate_contiguous_range(size_t count, unsigned alignment)
+Optional<u32> PhysicalRegion::allocate_block(size_t order)
 {
+    for (size_t current_order = order; current_order <= max_order; ++current_order) {
+        auto pfn = take_free_block(current_order);
+        if (!pfn.has_value())
+            continue;
+        // Split the block, handing the upper halves back until it has the requested size.
+        while (current_order > order) {
+            --current_order;
+            push_free_block(pfn.value() + (1u << current_order), current_order);
+        }
+        return pfn;
+    }
+    return {};
+}
+
+void PhysicalRegion::free_block(u32 pfn, size_t order)
+{
+    VERIFY(is_valid_block(pfn, order));
+    while (order < max_order) {
+        u32 buddy_pfn = pfn ^ (1u << order);
+        if (!is_valid_block(buddy_pfn, order) || !is_free_block(buddy_pfn, order))
+            break;
+        remove_free_block(buddy_pfn, order);
+        pfn &= ~(1u << order);
+        ++order;
+    }
+    push_free_block(pfn, order);
+}
+
+void PhysicalRegion::free_range(u32 pfn, size_t count)
+{
+    while (count) {
+        auto order = largest_block_order(pfn, count);
+        free_block(pfn, order);
+        pfn += 1u << order;
+        count -= 1u << order;
+    }
+}
+
+NonnullRefPtrVector<PhysicalPage> PhysicalRegion::take_contiguous_free_pages(size_t count, bool supervisor, size_t physical_alignment)
+{
+    VERIFY(m_pages);
     VERIFY(count != 0);
-    size_t found_pages_count = 0;
-    // TODO: Improve how we deal with alignment != 1
-    auto first_index = m_bitmap.find_longest_range_of_unset_bits(count + alignment - 1, found_pages_count);
-    if (!first_index.has_value())
+    VERIFY(physical_alignment % PAGE_SIZE == 0);
+
+    // Blocks are naturally aligned, so a large enough block satisfies the alignment too.
+    size_t order = max(ceil_log2(count), ceil_log2(physical_alignment / PAGE_SIZE));
+    if (order > max_order)
         return {};
 
-    auto page = first_index.value();
-    if (alignment != 1) {
-        auto lower_page = m_lower.get() / PAGE_SIZE;
-        page = ((lower_page + page + alignment - 1) & ~(alignment - 1)) - lower_page;
-    }
-    if (found_pages_count >= count) {
-        m_bitmap.set_range<true>(page, count);
-        m_used += count;
-        m_free_hint = first_index.value() + count + 1; // Just a guess
-        if (m_free_hint >= m_bitmap.size())
-            m_free_hint = 0;
-        return page;
+    auto pfn = allocate_block(order);
+    if (!pfn.has_value())
+        return {};
+
+    // Give back the part of the block that we don't need.
+    size_t block_size = 1u << order;
+    if (count < block_size)
+        free_range(pfn.value() + count, block_size - count);
+    m_used += count;
+
+    NonnullRefPtrVector<PhysicalPage> physical_pages;
+    physical_pages.ensure_capacity(count);
+    for (size_t index = 0; index < count; index++)
+        physical_pages.append(PhysicalPage::create(PhysicalAddress((pfn.value() + index) * PAGE_SIZE), supervisor));
+    return physical_pages;
+}
+
+size_t PhysicalRegion::take_free_pages(Span<PhysicalAddress> addresses)
+{
+    VERIFY(m_pages);
+    size_t taken = 0;
+    while (taken < addresses.size()) {
+        // Grab the largest block that doesn't overshoot, falling back to smaller ones.
+        Optional<u32> pfn;
+        size_t order = min(floor_log2(addresses.size() - taken), max_order);
+        for (;;) {
+            pfn = allocate_block(order);
+            if (pfn.has_value() || order == 0)
+                break;
+            --order;
+        }
+        if (!pfn.has_value())
+            break;
+        for (size_t i = 0; i < (1u << order); ++i)
+            addresses[taken++] = PhysicalAddress((pfn.value() + i) * PAGE_SIZE);
     }
-    return {};
+    m_used += taken;
+    return taken;
 }
 
 RefPtr<PhysicalPage> PhysicalRegion::take_free_page(bool supervisor)
 {
     VERIFY(m_pages);
 
-    auto free_index = find_one_free_page();
-    if (!free_index.has_value())
+    auto pfn = allocate_block(0);
+    if (!pfn.has_value())
         return nullptr;
 
-    return PhysicalPage::create(m_lower.offset(free_index.value() * PAGE_SIZE), supervisor);
+    ++m_used;
+    return PhysicalPage::create(PhysicalAddress(pfn.value() * PAGE_SIZE), supervisor);
 }
 
-void PhysicalRegion::free_page_at(PhysicalAddress addr)
+void PhysicalRegion::return_page(PhysicalAddress paddr)
 {
     VERIFY(m_pages);
+    VERIFY(m_used);
+    VERIFY(contains(paddr));
 
-    if (m_used == 0) {
-        VERIFY_NOT_REACHED();
-    }
-
-    Checked<FlatPtr> local_offset = addr.get();
-    local_offset -= m_lower.get();
-    VERIFY(!local_offset.has_overflow());
-    VERIFY(local_offset.value() < (FlatPtr)(m_pages * PAGE_SIZE));
-
-    auto page = local_offset.value() / PAGE_SIZE;
-    m_bitmap.set(page, false);
-    m_free_hint = page; // We know we can find one here for sure
-    m_used--;
+    u32 pfn = paddr.get() / PAGE_SIZE;
+    VERIFY(!is_free_block(pfn, 0));
+    free_block(pfn, 0);
+    --m_used;
 }
 
 void PhysicalRegion::return_page(const PhysicalPage& page)
 {
-    auto returned_count = m_recently_returned.size();
-    if (returned_count >= m_recently_returned.capacity()) {
-        // Return queue is full, pick a random entry and free that page
-        // and replace the entry with this page
-        auto& entry = m_recently_returned[get_fast_random<u8>()];
-        free_page_at(entry);
-        entry = page.paddr();
-    } else {
-        // Still filling the return queue, just append it
-        m_recently_returned.append(page.paddr());
-    }
+    return_page(page.paddr());
 }
 
 }
@@ -30,14 +30,22 @@
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/Optional.h>
 #include <AK/RefCounted.h>
+#include <AK/Span.h>
+#include <AK/Vector.h>
 #include <Kernel/VM/PhysicalPage.h>
 
 namespace Kernel {
 
+// A binary buddy allocator over one physically contiguous range of pages.
+// Free blocks of each order are tracked in a bitmap, which is the source of truth,
+// and a bounded stack of recently freed blocks, so that allocation and freeing
+// don't have to search the bitmap in the common case.
 class PhysicalRegion : public RefCounted<PhysicalRegion> {
     AK_MAKE_ETERNAL
 
 public:
+    static constexpr size_t max_order = 10;
+
     static NonnullRefPtr<PhysicalRegion> create(PhysicalAddress lower, PhysicalAddress upper);
     ~PhysicalRegion() = default;
 
@@ -47,19 +55,37 @@ public:
     PhysicalAddress lower() const { return m_lower; }
     PhysicalAddress upper() const { return m_upper; }
     unsigned size() const { return m_pages; }
-    unsigned used() const { return m_used - m_recently_returned.size(); }
-    unsigned free() const { return m_pages - m_used + m_recently_returned.size(); }
-    bool contains(const PhysicalPage& page) const { return page.paddr() >= m_lower && page.paddr() <= m_upper; }
+    unsigned used() const { return m_used; }
+    unsigned free() const { return m_pages - m_used; }
+    bool contains(const PhysicalPage& page) const { return contains(page.paddr()); }
+    bool contains(PhysicalAddress paddr) const { return paddr >= m_lower && paddr <= m_upper; }
 
     RefPtr<PhysicalPage> take_free_page(bool supervisor);
     NonnullRefPtrVector<PhysicalPage> take_contiguous_free_pages(size_t count, bool supervisor, size_t physical_alignment = PAGE_SIZE);
     void return_page(const PhysicalPage& page);
 
+    // Batched variants that work on bare addresses, for callers that create the PhysicalPages themselves.
+    size_t take_free_pages(Span<PhysicalAddress>);
+    void return_page(PhysicalAddress);
+
 private:
-    unsigned find_contiguous_free_pages(size_t count, size_t physical_alignment = PAGE_SIZE);
-    Optional<unsigned> find_and_allocate_contiguous_range(size_t count, unsigned alignment = 1);
-    Optional<unsigned> find_one_free_page();
-    void free_page_at(PhysicalAddress addr);
+    struct FreeArea {
+        Bitmap blocks;
+        size_t free_count { 0 };
+        size_t scan_hint { 0 };
+        Vector<u32, 64> recently_freed;
+    };
+
+    Optional<u32> allocate_block(size_t order);
+    void free_block(u32 pfn, size_t order);
+    void free_range(u32 pfn, size_t count);
+
+    Optional<u32> take_free_block(size_t order);
+    void push_free_block(u32 pfn, size_t order);
+    void remove_free_block(u32 pfn, size_t order);
+    bool is_free_block(u32 pfn, size_t order) const;
+    bool is_valid_block(u32 pfn, size_t order) const;
+    size_t block_index(u32 pfn, size_t order) const { return (pfn >> order) - (m_first_pfn >> order); }
 
     PhysicalRegion(PhysicalAddress lower, PhysicalAddress upper);
 
@@ -67,9 +93,8 @@ private:
     PhysicalAddress m_upper;
     unsigned m_pages { 0 };
     unsigned m_used { 0 };
-    Bitmap m_bitmap;
-    size_t m_free_hint { 0 };
-    Vector<PhysicalAddress, 256> m_recently_returned;
+    u32 m_first_pfn { 0 };
+    FreeArea m_free_areas[max_order + 1];
 };
 
 }
@@ -492,6 +492,17 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
     if (page_slot->is_lazy_committed_page()) {
         page_slot = static_cast<AnonymousVMObject&>(*m_vmobject).allocate_committed_page(page_index_in_vmobject);
         dbgln_if(PAGE_FAULT_DEBUG, "      >> ALLOCATED COMMITTED {}", page_slot->paddr());
+
+        // The neighbouring pages are most likely about to be touched too, and
+        // they're already committed, so hand them out now in one go.
+        if (zero_fault_around(page_index_in_region)) {
+            auto window = fault_around_window(page_index_in_region);
+            if (!remap_vmobject_page_range(translate_to_vmobject_page(window.first_page_index), window.page_count)) {
+                dmesgln("MM: handle_zero_fault was unable to allocate a page table to map {}", page_slot);
+                return PageFaultResponse::OutOfMemory;
+            }
+            return PageFaultResponse::Continue;
+        }
     } else {
         page_slot = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::Yes);
         if (page_slot.is_null()) {
@@ -508,6 +519,69 @@ PageFaultResponse Region::handle_zero_fault(size_t page_index_in_region)
     return PageFaultResponse::Continue;
 }
 
+Region::FaultAroundWindow Region::fault_around_window(size_t page_index_in_region) const
+{
+    size_t window_size = MM.fault_around_page_count();
+    if (window_size <= 1)
+        return { page_index_in_region, 1 };
+    size_t first_page_index = page_index_in_region & ~(window_size - 1);
+    return { first_page_index, min(window_size, page_count() - first_page_index) };
+}
+
+size_t Region::zero_fault_around(size_t page_index_in_region)
+{
+    VERIFY(vmobject().is_anonymous());
+    VERIFY(vmobject().m_paging_lock.is_locked());
+
+    auto window = fault_around_window(page_index_in_region);
+    size_t page_indices[MemoryManager::max_fault_around_page_count];
+    size_t count = 0;
+    for (size_t i = window.first_page_index; i < window.first_page_index + window.page_count; ++i) {
+        if (i == page_index_in_region || should_cow(i))
+            continue;
+        auto& page_slot = physical_page_slot(i);
+        if (page_slot && page_slot->is_lazy_committed_page())
+            page_indices[count++] = i;
+    }
+    if (!count)
+        return 0;
+
+    RefPtr<PhysicalPage> pages[MemoryManager::max_fault_around_page_count];
+    static_cast<AnonymousVMObject&>(vmobject()).allocate_committed_pages({ pages, count });
+    for (size_t i = 0; i < count; ++i)
+        physical_page_slot(page_indices[i]) = move(pages[i]);
+
+    m_pages_mapped_ahead += count;
+    return count;
+}
+
+size_t Region::map_resident_pages_around(size_t page_index_in_region)
+{
+    VERIFY(vmobject().m_paging_lock.is_locked());
+    ScopedSpinLock lock(s_mm_lock);
+    if (!m_page_directory)
+        return 0;
+
+    auto window = fault_around_window(page_index_in_region);
+    ScopedSpinLock page_lock(m_page_directory->get_lock());
+    size_t mapped_count = 0;
+    for (size_t i = window.first_page_index; i < window.first_page_index + window.page_count; ++i) {
+        if (i == page_index_in_region || !physical_page(i))
+            continue;
+        auto* pte = MM.pte(*m_page_directory, vaddr_from_page_index(i));
+        if (pte && pte->is_present())
+            continue;
+        if (!map_individual_page_impl(i))
+            break;
+        ++mapped_count;
+    }
+    if (mapped_count)
+        MM.flush_tlb(m_page_directory, vaddr_from_page_index(window.first_page_index), window.page_count);
+
+    m_pages_mapped_ahead += mapped_count;
+    return mapped_count;
+}
+
 PageFaultResponse Region::handle_cow_fault(size_t page_index_in_region)
 {
     VERIFY_INTERRUPTS_DISABLED();
@@ -549,6 +623,7 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region, Scoped
         dbgln_if(PAGE_FAULT_DEBUG, "MM: page_in_from_inode() but page already present. Fine with me!");
         if (!remap_vmobject_page(page_index_in_vmobject))
             return PageFaultResponse::OutOfMemory;
+        map_resident_pages_around(page_index_in_region);
         return PageFaultResponse::Continue;
     }
 
@@ -595,7 +670,11 @@ PageFaultResponse Region::handle_inode_fault(size_t page_index_in_region, Scoped
     }
     MM.unquickmap_page();
 
+    if (inode_vmobject.is_shared_inode())
+        static_cast<SharedInodeVMObject&>(inode_vmobject).touch_page_cache();
+
     remap_vmobject_page(page_index_in_vmobject);
+    map_resident_pages_around(page_index_in_region);
     return PageFaultResponse::Continue;
 }
 
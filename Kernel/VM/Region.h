@@ -217,6 +217,10 @@ public:
 
     size_t cow_pages() const;
 
+    // Pages that fault-around mapped in ahead of the access that faulted. Not every one of them
+    // ends up being touched, so this is an upper bound on the page faults that were avoided.
+    size_t pages_mapped_ahead() const { return m_pages_mapped_ahead; }
+
     void set_readable(bool b) { set_access_bit(Access::Read, b); }
     void set_writable(bool b) { set_access_bit(Access::Write, b); }
     void set_executable(bool b) { set_access_bit(Access::Execute, b); }
@@ -270,6 +274,14 @@ private:
     PageFaultResponse handle_inode_fault(size_t page_index, ScopedSpinLock<RecursiveSpinLock>&);
     PageFaultResponse handle_zero_fault(size_t page_index);
 
+    struct FaultAroundWindow {
+        size_t first_page_index { 0 };
+        size_t page_count { 0 };
+    };
+    FaultAroundWindow fault_around_window(size_t page_index) const;
+    size_t zero_fault_around(size_t page_index);
+    size_t map_resident_pages_around(size_t page_index);
+
     bool map_individual_page_impl(size_t page_index);
 
     void register_purgeable_page_ranges();
@@ -286,6 +298,7 @@ private:
     bool m_stack : 1 { false };
     bool m_mmap : 1 { false };
     bool m_syscall_region : 1 { false };
+    size_t m_pages_mapped_ahead { 0 };
     WeakPtr<Process> m_owner;
 };
 
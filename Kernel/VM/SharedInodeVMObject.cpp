@@ -24,11 +24,19 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <AK/Singleton.h>
 #include <Kernel/FileSystem/Inode.h>
+#include <Kernel/VM/MemoryManager.h>
 #include <Kernel/VM/SharedInodeVMObject.h>
 
 namespace Kernel {
 
+// Start reclaiming in the background once fewer than 1/32 of all user pages are free.
+static constexpr size_t page_cache_low_watermark_divisor = 32;
+
+static SpinLock<u8> s_page_cache_lock;
+static AK::Singleton<SharedInodeVMObject::PageCacheList> s_page_cache_list;
+
 NonnullRefPtr<SharedInodeVMObject> SharedInodeVMObject::create_with_inode(Inode& inode)
 {
     size_t size = inode.size();
@@ -54,4 +62,239 @@ SharedInodeVMObject::SharedInodeVMObject(const SharedInodeVMObject& other)
 {
 }
 
+SharedInodeVMObject::~SharedInodeVMObject()
+{
+    ScopedSpinLock lock(s_page_cache_lock);
+    if (m_page_cache_list_node.is_in_list())
+        s_page_cache_list->remove(*this);
+}
+
+void SharedInodeVMObject::touch_page_cache()
+{
+    // The list is kept in least recently used order, so the reclaimer starts at the front.
+    ScopedSpinLock lock(s_page_cache_lock);
+    s_page_cache_list->append(*this);
+}
+
+void SharedInodeVMObject::ensure_page_count(size_t new_page_count)
+{
+    VERIFY(m_paging_lock.is_locked());
+    if (new_page_count <= page_count())
+        return;
+
+    // The inode has grown since this VMObject was created. Regions only ever
+    // look at the pages they cover, so extending the page list is harmless.
+    ScopedSpinLock lock(s_mm_lock);
+    m_physical_pages.resize(new_page_count);
+    m_dirty_pages.grow(new_page_count, false);
+}
+
+size_t SharedInodeVMObject::resident_page_count() const
+{
+    ScopedSpinLock lock(s_mm_lock);
+    size_t count = 0;
+    for (auto& page : m_physical_pages) {
+        if (page)
+            ++count;
+    }
+    return count;
+}
+
+KResult SharedInodeVMObject::fill_page(size_t page_index)
+{
+    VERIFY(m_paging_lock.is_locked());
+    auto page = MM.allocate_user_physical_page(MemoryManager::ShouldZeroFill::No);
+    if (!page)
+        return ENOMEM;
+
+    // Reading from the disk blocks, so we can't use a quickmap here. The read goes through
+    // the block cache so that blocks dirtied by write() but not yet written back are seen.
+    auto window = MM.allocate_kernel_region(page->paddr(), PAGE_SIZE, "SharedInodeVMObject", Region::Access::Read | Region::Access::Write);
+    if (!window)
+        return ENOMEM;
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(window->vaddr().as_ptr());
+    auto nread = inode().read_bytes(page_index * PAGE_SIZE, PAGE_SIZE, buffer, nullptr);
+    if (nread < 0)
+        return KResult((ErrnoCode)-nread);
+    if (nread < PAGE_SIZE) {
+        // If we read less than a page, zero out the rest to avoid leaking uninitialized data.
+        memset(window->vaddr().as_ptr() + nread, 0, PAGE_SIZE - nread);
+    }
+
+    ScopedSpinLock lock(s_mm_lock);
+    m_physical_pages[page_index] = move(page);
+    return KSuccess;
+}
+
+template<typename Callback>
+KResult SharedInodeVMObject::with_mapped_page(size_t page_index, VirtualAddress buffer_vaddr, size_t count, bool writes_to_buffer, Callback callback)
+{
+    RefPtr<PhysicalPage> page;
+    {
+        ScopedSpinLock lock(s_mm_lock);
+        page = m_physical_pages[page_index];
+        VERIFY(page);
+        // Resolving a fault on the buffer could need the quickmap itself, or block. So we can
+        // only copy between the quickmapped page and the buffer if the buffer is mapped already.
+        if (MM.is_range_mapped(buffer_vaddr, count, writes_to_buffer)) {
+            bool copied = callback(MM.quickmap_page(*page));
+            MM.unquickmap_page();
+            return copied ? KResult(KSuccess) : KResult(EFAULT);
+        }
+    }
+
+    auto window = MM.allocate_kernel_region(page->paddr(), PAGE_SIZE, "SharedInodeVMObject", Region::Access::Read | Region::Access::Write);
+    if (!window)
+        return ENOMEM;
+    return callback(window->vaddr().as_ptr()) ? KResult(KSuccess) : KResult(EFAULT);
+}
+
+KResultOr<size_t> SharedInodeVMObject::read_through_cache(u64 offset, size_t count, UserOrKernelBuffer& buffer)
+{
+    u64 inode_size = inode().size();
+    if (offset >= inode_size || count == 0)
+        return 0;
+    count = min(static_cast<u64>(count), inode_size - offset);
+
+    size_t first_page_index = offset / PAGE_SIZE;
+    size_t last_page_index = (offset + count - 1) / PAGE_SIZE;
+
+    LOCKER(m_paging_lock);
+    ensure_page_count(last_page_index + 1);
+    touch_page_cache();
+
+    size_t nread = 0;
+    for (size_t page_index = first_page_index; page_index <= last_page_index; ++page_index) {
+        size_t offset_in_page = page_index == first_page_index ? offset % PAGE_SIZE : 0;
+        size_t nbytes = min(PAGE_SIZE - offset_in_page, count - nread);
+
+        bool is_resident;
+        {
+            ScopedSpinLock lock(s_mm_lock);
+            is_resident = m_physical_pages[page_index];
+        }
+        auto result = is_resident ? KResult(KSuccess) : fill_page(page_index);
+        if (result.error() == -ENOMEM) {
+            // We can still get at the data, it just won't be cached.
+            auto destination = buffer.offset(nread);
+            auto nread_uncached = inode().read_bytes(page_index * PAGE_SIZE + offset_in_page, nbytes, destination, nullptr);
+            if (nread_uncached < 0)
+                result = KResult((ErrnoCode)-nread_uncached);
+            else if ((size_t)nread_uncached < nbytes)
+                return nread + (size_t)nread_uncached;
+            else
+                result = KSuccess;
+        } else if (!result.is_error()) {
+            auto buffer_vaddr = VirtualAddress(buffer.user_or_kernel_ptr()).offset(nread);
+            result = with_mapped_page(page_index, buffer_vaddr, nbytes, true, [&](const u8* page_data) {
+                return buffer.write(page_data + offset_in_page, nread, nbytes);
+            });
+        }
+        if (result.is_error()) {
+            if (nread && result.error() != -EFAULT)
+                return nread;
+            return result;
+        }
+        nread += nbytes;
+    }
+    return nread;
+}
+
+void SharedInodeVMObject::update_cache(u64 offset, size_t count, const UserOrKernelBuffer& data)
+{
+    if (count == 0)
+        return;
+
+    size_t first_page_index = offset / PAGE_SIZE;
+    size_t last_page_index = (offset + count - 1) / PAGE_SIZE;
+
+    LOCKER(m_paging_lock);
+    touch_page_cache();
+
+    // Only pages that are already resident are updated; the rest will be read from disk when needed.
+    size_t nwritten = 0;
+    bool dropped_pages = false;
+    for (size_t page_index = first_page_index; page_index <= last_page_index && page_index < page_count(); ++page_index) {
+        size_t offset_in_page = page_index == first_page_index ? offset % PAGE_SIZE : 0;
+        size_t nbytes = min(PAGE_SIZE - offset_in_page, count - nwritten);
+        size_t data_offset = nwritten;
+        nwritten += nbytes;
+
+        {
+            ScopedSpinLock lock(s_mm_lock);
+            if (!m_physical_pages[page_index])
+                continue;
+        }
+        auto data_vaddr = VirtualAddress(data.user_or_kernel_ptr()).offset(data_offset);
+        auto result = with_mapped_page(page_index, data_vaddr, nbytes, false, [&](u8* page_data) {
+            return data.read(page_data + offset_in_page, data_offset, nbytes);
+        });
+        if (result.is_error()) {
+            // The data made it to the inode but we can't see it anymore, so forget the stale page.
+            ScopedSpinLock lock(s_mm_lock);
+            m_physical_pages[page_index] = nullptr;
+            dropped_pages = true;
+        }
+    }
+
+    if (dropped_pages) {
+        for_each_region([](auto& region) {
+            region.remap();
+        });
+    }
+}
+
+void SharedInodeVMObject::invalidate_cache_from(u64 offset)
+{
+    LOCKER(m_paging_lock);
+    size_t first_dropped_page_index = ceil_div(offset, static_cast<u64>(PAGE_SIZE));
+    {
+        ScopedSpinLock lock(s_mm_lock);
+        size_t offset_in_page = offset % PAGE_SIZE;
+        size_t partial_page_index = offset / PAGE_SIZE;
+        if (offset_in_page && partial_page_index < page_count()) {
+            if (auto& page = m_physical_pages[partial_page_index]) {
+                memset(MM.quickmap_page(*page) + offset_in_page, 0, PAGE_SIZE - offset_in_page);
+                MM.unquickmap_page();
+            }
+        }
+        for (size_t i = first_dropped_page_index; i < page_count(); ++i) {
+            m_physical_pages[i] = nullptr;
+            m_dirty_pages.set(i, false);
+        }
+    }
+    for_each_region([](auto& region) {
+        region.remap();
+    });
+}
+
+size_t SharedInodeVMObject::reclaim_cached_pages(size_t target_page_count)
+{
+    VERIFY(s_mm_lock.own_lock());
+    ScopedSpinLock lock(s_page_cache_lock);
+
+    size_t reclaimed = 0;
+    for (auto& vmobject : *s_page_cache_list) {
+        if (reclaimed >= target_page_count)
+            break;
+        // Someone is paging this inode in right now, leave it alone.
+        if (vmobject.m_paging_lock.is_locked())
+            continue;
+        // Pages in writable shared mappings may have been modified behind our back.
+        if (vmobject.writable_mappings())
+            continue;
+        reclaimed += vmobject.release_all_clean_pages_impl();
+    }
+    return reclaimed;
+}
+
+void SharedInodeVMObject::trim_page_cache()
+{
+    ScopedSpinLock lock(s_mm_lock);
+    size_t low_watermark = MM.user_physical_pages() / page_cache_low_watermark_divisor;
+    size_t free_pages = MM.user_physical_pages_uncommitted();
+    if (free_pages < low_watermark)
+        reclaim_cached_pages(low_watermark - free_pages);
+}
+
 }
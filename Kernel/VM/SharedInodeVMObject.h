@@ -27,8 +27,11 @@
 #pragma once
 
 #include <AK/Bitmap.h>
+#include <AK/IntrusiveList.h>
+#include <Kernel/KResult.h>
 #include <Kernel/UnixTypes.h>
 #include <Kernel/VM/InodeVMObject.h>
+#include <Kernel/VirtualAddress.h>
 
 namespace Kernel {
 
@@ -37,8 +40,22 @@ class SharedInodeVMObject final : public InodeVMObject {
 
 public:
     static NonnullRefPtr<SharedInodeVMObject> create_with_inode(Inode&);
+    virtual ~SharedInodeVMObject() override;
     virtual RefPtr<VMObject> clone() override;
 
+    // The physical pages of an inode's SharedInodeVMObject double as its page cache:
+    // read() and write() on the inode go through the same pages that shared mappings use.
+    KResultOr<size_t> read_through_cache(u64 offset, size_t count, UserOrKernelBuffer&);
+    void update_cache(u64 offset, size_t count, const UserOrKernelBuffer&);
+    void invalidate_cache_from(u64 offset);
+    void touch_page_cache();
+
+    // Releases clean pages from the least recently used caches. The caller must hold the MM lock.
+    // The LRU list doesn't keep its entries alive, a cache only lives as long as the inode is
+    // mapped or open for reading somewhere.
+    static size_t reclaim_cached_pages(size_t target_page_count);
+    static void trim_page_cache();
+
 private:
     virtual bool is_shared_inode() const override { return true; }
 
@@ -48,6 +65,17 @@ private:
     virtual const char* class_name() const override { return "SharedInodeVMObject"; }
 
     SharedInodeVMObject& operator=(const SharedInodeVMObject&) = delete;
+
+    KResult fill_page(size_t page_index);
+    template<typename Callback>
+    KResult with_mapped_page(size_t page_index, VirtualAddress buffer_vaddr, size_t count, bool writes_to_buffer, Callback);
+    void ensure_page_count(size_t);
+    size_t resident_page_count() const;
+
+    IntrusiveListNode<SharedInodeVMObject, RawPtr<SharedInodeVMObject>> m_page_cache_list_node;
+
+public:
+    using PageCacheList = IntrusiveList<SharedInodeVMObject, RawPtr<SharedInodeVMObject>, &SharedInodeVMObject::m_page_cache_list_node>;
 };
 
 }
@@ -48,6 +48,7 @@ public:
 
     virtual JS::Value get(const JS::PropertyName&, JS::Value receiver = {}, bool without_side_effects = false) const override;
     virtual bool put(const JS::PropertyName&, JS::Value value, JS::Value receiver = {}) override;
+    virtual bool overrides_property_access() const override { return true; }
     virtual void initialize_global_object() override;
 
     JS_DECLARE_NATIVE_FUNCTION(get_real_cell_contents);
@@ -76,6 +77,8 @@ public:
 
 private:
     virtual void visit_edges(Visitor&) override;
+    // The sheets we visit are owned by the workbook, which doesn't use write barriers.
+    virtual bool is_always_remembered() const override { return true; }
     Workbook& m_workbook;
 };
 
@@ -117,6 +117,7 @@ ProcessMemoryMapWidget::ProcessMemoryMapWidget()
             return pagemap;
         });
     pid_vm_fields.empend("cow_pages", "# CoW", Gfx::TextAlignment::CenterRight);
+    pid_vm_fields.empend("pages_mapped_ahead", "# Mapped ahead", Gfx::TextAlignment::CenterRight);
     pid_vm_fields.empend("name", "Name", Gfx::TextAlignment::CenterLeft);
     m_json_model = GUI::JsonArrayModel::create({}, move(pid_vm_fields));
     m_table_view->set_model(GUI::SortingProxyModel::create(*m_json_model));
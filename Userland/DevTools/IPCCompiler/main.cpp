@@ -55,6 +55,23 @@ struct Message {
     }
 };
 
+static String snake_case_name(const String& name)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < name.length(); ++i) {
+        if (isupper(name[i])) {
+            bool follows_lowercase = i > 0 && !isupper(name[i - 1]);
+            bool ends_acronym = i > 0 && i + 1 < name.length() && isupper(name[i - 1]) && islower(name[i + 1]);
+            if (follows_lowercase || ends_acronym)
+                builder.append('_');
+            builder.append(tolower(name[i]));
+        } else {
+            builder.append(name[i]);
+        }
+    }
+    return builder.to_string();
+}
+
 struct Endpoint {
     String name;
     int magic;
@@ -317,9 +334,9 @@ public:
     static i32 static_message_id() { return (int)MessageID::@message.name@; }
     virtual const char* message_name() const override { return "@endpoint.name@::@message.name@"; }
 
-    static OwnPtr<@message.name@> decode(InputMemoryStream& stream, int sockfd)
+    static OwnPtr<@message.name@> decode(InputMemoryStream& stream, int sockfd, IPC::OutOfLineRings* out_of_line_rings)
     {
-        IPC::Decoder decoder { stream, sockfd };
+        IPC::Decoder decoder { stream, sockfd, out_of_line_rings };
 )~~~");
 
             for (auto& parameter : parameters) {
@@ -333,9 +350,14 @@ public:
                 else
                     parameter_generator.set("parameter.initial_value", "{}");
 
+                if (parameter.attributes.contains_slow("OutOfLine"))
+                    parameter_generator.set("parameter.decode", "decode_out_of_line");
+                else
+                    parameter_generator.set("parameter.decode", "decode");
+
                 parameter_generator.append(R"~~~(
         @parameter.type@ @parameter.name@ = @parameter.initial_value@;
-        if (!decoder.decode(@parameter.name@))
+        if (!decoder.@parameter.decode@(@parameter.name@))
             return {};
 )~~~");
 
@@ -365,10 +387,10 @@ public:
 )~~~");
 
             message_generator.append(R"~~~(
-    virtual IPC::MessageBuffer encode() const override
+    virtual IPC::MessageBuffer encode(IPC::OutOfLineRings* out_of_line_rings) const override
     {
         IPC::MessageBuffer buffer;
-        IPC::Encoder stream(buffer);
+        IPC::Encoder stream(buffer, out_of_line_rings);
         stream << endpoint_magic();
         stream << (int)MessageID::@message.name@;
 )~~~");
@@ -377,9 +399,15 @@ public:
                 auto parameter_generator = message_generator.fork();
 
                 parameter_generator.set("parameter.name", parameter.name);
-                parameter_generator.append(R"~~~(
+                if (parameter.attributes.contains_slow("OutOfLine")) {
+                    parameter_generator.append(R"~~~(
+        stream.encode_out_of_line(m_@parameter.name@);
+)~~~");
+                } else {
+                    parameter_generator.append(R"~~~(
         stream << m_@parameter.name@;
 )~~~");
+                }
             }
 
             message_generator.append(R"~~~(
@@ -437,7 +465,7 @@ public:
     static String static_name() { return "@endpoint.name@"; }
     virtual String name() const override { return "@endpoint.name@"; }
 
-    static OwnPtr<IPC::Message> decode_message(ReadonlyBytes buffer, int sockfd)
+    static OwnPtr<IPC::Message> decode_message(ReadonlyBytes buffer, int sockfd, IPC::OutOfLineRings* out_of_line_rings)
     {
         InputMemoryStream stream { buffer };
         i32 message_endpoint_magic = 0;
@@ -489,7 +517,7 @@ public:
 
                 message_generator.append(R"~~~(
         case (int)Messages::@endpoint.name@::MessageID::@message.name@:
-            message = Messages::@endpoint.name@::@message.name@::decode(stream, sockfd);
+            message = Messages::@endpoint.name@::@message.name@::decode(stream, sockfd, out_of_line_rings);
             break;
 )~~~");
             };
@@ -585,6 +613,46 @@ public:
         endpoint_generator.append(R"~~~(
 private:
 };
+
+// Mix this into a connection whose peer is @endpoint.name@ to get async_*() calls that
+// post a synchronous request and return a future for its reply, so requests can be pipelined.
+template<typename ConnectionType>
+class @endpoint.name@Proxy {
+public:
+)~~~");
+
+        for (auto& message : endpoint.messages) {
+            if (!message.is_synchronous)
+                continue;
+
+            auto message_generator = endpoint_generator.fork();
+            message_generator.set("message.name", message.name);
+            message_generator.set("message.stub_name", snake_case_name(message.name));
+
+            StringBuilder parameters_builder;
+            StringBuilder arguments_builder;
+            for (size_t i = 0; i < message.inputs.size(); ++i) {
+                auto& parameter = message.inputs[i];
+                if (i != 0) {
+                    parameters_builder.append(", ");
+                    arguments_builder.append(", ");
+                }
+                parameters_builder.appendff("{} {}", parameter.type, parameter.name);
+                arguments_builder.appendff("move({})", parameter.name);
+            }
+            message_generator.set("message.parameters", parameters_builder.to_string());
+            message_generator.set("message.arguments", arguments_builder.to_string());
+
+            message_generator.append(R"~~~(
+    auto async_@message.stub_name@(@message.parameters@)
+    {
+        return static_cast<ConnectionType&>(*this).template post_message_with_reply<Messages::@endpoint.name@::@message.name@>(@message.arguments@);
+    }
+)~~~");
+        }
+
+        endpoint_generator.append(R"~~~(
+};
 )~~~");
     }
 
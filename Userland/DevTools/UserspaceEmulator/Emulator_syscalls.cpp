@@ -33,6 +33,7 @@
 #include <sched.h>
 #include <serenity.h>
 #include <strings.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/select.h>
@@ -207,6 +208,16 @@ u32 Emulator::virt_syscall(u32 function, u32 arg1, u32 arg2, u32 arg3)
         return virt$listen(arg1, arg2);
     case SC_select:
         return virt$select(arg1);
+    case SC_epoll_create:
+        return virt$epoll_create(arg1);
+    case SC_epoll_ctl:
+        return virt$epoll_ctl(arg1);
+    case SC_epoll_wait:
+        return virt$epoll_wait(arg1);
+    case SC_sendfile:
+        return virt$sendfile(arg1);
+    case SC_splice:
+        return virt$splice(arg1);
     case SC_recvmsg:
         return virt$recvmsg(arg1, arg2, arg3);
     case SC_sendmsg:
@@ -701,6 +712,88 @@ int Emulator::virt$select(FlatPtr params_addr)
     return rc;
 }
 
+int Emulator::virt$epoll_create(int flags)
+{
+    return syscall(SC_epoll_create, flags);
+}
+
+int Emulator::virt$epoll_ctl(FlatPtr params_addr)
+{
+    Syscall::SC_epoll_ctl_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+
+    epoll_event event {};
+    if (params.event)
+        mmu().copy_from_vm(&event, (FlatPtr)params.event, sizeof(event));
+
+    Syscall::SC_epoll_ctl_params host_params { params.epfd, params.op, params.fd, params.event ? &event : nullptr };
+    return syscall(SC_epoll_ctl, &host_params);
+}
+
+int Emulator::virt$epoll_wait(FlatPtr params_addr)
+{
+    Syscall::SC_epoll_wait_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+
+    if (params.maxevents <= 0)
+        return -EINVAL;
+
+    struct timespec timeout;
+    u32 sigmask;
+    if (params.timeout)
+        mmu().copy_from_vm(&timeout, (FlatPtr)params.timeout, sizeof(timeout));
+    if (params.sigmask)
+        mmu().copy_from_vm(&sigmask, (FlatPtr)params.sigmask, sizeof(sigmask));
+
+    Vector<epoll_event> events;
+    events.resize(params.maxevents);
+
+    Syscall::SC_epoll_wait_params host_params { params.epfd, events.data(), params.maxevents, params.timeout ? &timeout : nullptr, params.sigmask ? &sigmask : nullptr };
+    int rc = syscall(SC_epoll_wait, &host_params);
+    if (rc <= 0)
+        return rc;
+
+    mmu().copy_to_vm((FlatPtr)params.events, events.data(), rc * sizeof(epoll_event));
+    return rc;
+}
+
+int Emulator::virt$sendfile(FlatPtr params_addr)
+{
+    Syscall::SC_sendfile_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+
+    off_t offset;
+    if (params.offset)
+        mmu().copy_from_vm(&offset, (FlatPtr)params.offset, sizeof(offset));
+
+    Syscall::SC_sendfile_params host_params { params.out_fd, params.in_fd, params.offset ? &offset : nullptr, params.count };
+    int rc = syscall(SC_sendfile, &host_params);
+    if (rc >= 0 && params.offset)
+        mmu().copy_to_vm((FlatPtr)params.offset, &offset, sizeof(offset));
+    return rc;
+}
+
+int Emulator::virt$splice(FlatPtr params_addr)
+{
+    Syscall::SC_splice_params params;
+    mmu().copy_from_vm(&params, params_addr, sizeof(params));
+
+    off_t off_in;
+    off_t off_out;
+    if (params.off_in)
+        mmu().copy_from_vm(&off_in, (FlatPtr)params.off_in, sizeof(off_in));
+    if (params.off_out)
+        mmu().copy_from_vm(&off_out, (FlatPtr)params.off_out, sizeof(off_out));
+
+    Syscall::SC_splice_params host_params { params.fd_in, params.off_in ? &off_in : nullptr, params.fd_out, params.off_out ? &off_out : nullptr, params.length, params.flags };
+    int rc = syscall(SC_splice, &host_params);
+    if (rc >= 0 && params.off_in)
+        mmu().copy_to_vm((FlatPtr)params.off_in, &off_in, sizeof(off_in));
+    if (rc >= 0 && params.off_out)
+        mmu().copy_to_vm((FlatPtr)params.off_out, &off_out, sizeof(off_out));
+    return rc;
+}
+
 int Emulator::virt$getsockopt(FlatPtr params_addr)
 {
     Syscall::SC_getsockopt_params params;
@@ -37,6 +37,8 @@ __BEGIN_DECLS
 #define F_GETFL 3
 #define F_SETFL 4
 #define F_ISTTY 5
+#define F_GETPIPE_SZ 8
+#define F_SETPIPE_SZ 9
 
 #define FD_CLOEXEC 1
 
@@ -64,6 +66,12 @@ int openat(int dirfd, const char* path, int options, ...);
 int fcntl(int fd, int cmd, ...);
 int watch_file(const char* path, size_t path_length);
 
+#define SPLICE_F_MOVE (1 << 0)
+#define SPLICE_F_NONBLOCK (1 << 1)
+#define SPLICE_F_MORE (1 << 2)
+
+ssize_t splice(int fd_in, off_t* off_in, int fd_out, off_t* off_out, size_t length, unsigned flags);
+
 #define F_RDLCK 0
 #define F_WRLCK 1
 #define F_UNLCK 2
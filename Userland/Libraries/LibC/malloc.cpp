@@ -40,8 +40,6 @@
 #include <sys/mman.h>
 #include <syscall.h>
 
-// FIXME: Thread safety.
-
 #define RECYCLE_BIG_ALLOCATIONS
 
 #define PAGE_ROUND_UP(x) ((((size_t)(x)) + PAGE_SIZE - 1) & (~(PAGE_SIZE - 1)))
@@ -55,6 +53,12 @@ static LibThread::Lock& malloc_lock()
 constexpr size_t number_of_chunked_blocks_to_keep_around_per_size_class = 4;
 constexpr size_t number_of_big_blocks_to_keep_around_per_size_class = 8;
 
+// Small allocations are served from per-thread magazines, which are refilled from
+// (and drained back to) the shared ChunkedBlocks in batches of roughly this many bytes.
+constexpr size_t largest_thread_cached_size = 1016;
+constexpr size_t thread_cache_batch_bytes = 4 * KiB;
+constexpr size_t thread_cache_max_batch_size = 16;
+
 static bool s_log_malloc = false;
 static bool s_scrub_malloc = true;
 static bool s_scrub_free = true;
@@ -99,6 +103,12 @@ struct MallocStats {
     size_t number_of_freed_full_blocks;
     size_t number_of_keeps;
     size_t number_of_frees;
+
+    size_t number_of_thread_cache_malloc_hits;
+    size_t number_of_thread_cache_refills;
+    size_t number_of_thread_cache_free_hits;
+    size_t number_of_thread_cache_drains;
+    size_t number_of_thread_cache_flushes;
 };
 static MallocStats g_malloc_stats = {};
 
@@ -115,6 +125,31 @@ struct BigAllocator {
     Vector<BigAllocationBlock*, number_of_big_blocks_to_keep_around_per_size_class> blocks;
 };
 
+constexpr size_t compute_number_of_thread_cached_size_classes()
+{
+    size_t count = 0;
+    while (size_classes[count] && size_classes[count] <= largest_thread_cached_size)
+        ++count;
+    return count;
+}
+
+constexpr size_t number_of_thread_cached_size_classes = compute_number_of_thread_cached_size_classes();
+
+// NOTE: This has to be trivially constructible, since it lives in TLS.
+struct ThreadCache {
+    struct Magazine {
+        size_t count;
+        void* chunks[thread_cache_max_batch_size * 2];
+    };
+    Magazine magazines[number_of_thread_cached_size_classes];
+
+    // These are folded into g_malloc_stats whenever we take the malloc lock anyway,
+    // so that cache hits don't have to touch any shared cache lines.
+    size_t number_of_malloc_hits;
+    size_t number_of_free_hits;
+};
+static __thread ThreadCache t_thread_cache;
+
 // Allocators will be initialized in __malloc_init.
 // We can not rely on global constructors to initialize them,
 // because they must be initialized before other global constructors
@@ -146,6 +181,21 @@ static Allocator* allocator_for_size(size_t size, size_t& good_size)
     return nullptr;
 }
 
+static inline size_t size_class_index(const Allocator& allocator)
+{
+    return &allocator - &allocators()[0];
+}
+
+static inline bool is_thread_cached(const Allocator& allocator)
+{
+    return size_class_index(allocator) < number_of_thread_cached_size_classes;
+}
+
+static inline size_t thread_cache_batch_size(const Allocator& allocator)
+{
+    return clamp(thread_cache_batch_bytes / allocator.size, (size_t)2, thread_cache_max_batch_size);
+}
+
 #ifdef RECYCLE_BIG_ALLOCATIONS
 static BigAllocator* big_allocator_for_size(size_t size)
 {
@@ -175,21 +225,180 @@ enum class CallerWillInitializeMemory {
     Yes,
 };
 
-static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
+static void* allocate_chunk(Allocator& allocator, size_t good_size)
+{
+    ChunkedBlock* block = nullptr;
+
+    for (block = allocator.usable_blocks.head(); block; block = block->next()) {
+        if (block->free_chunks())
+            break;
+    }
+
+    if (!block && allocator.empty_block_count) {
+        g_malloc_stats.number_of_empty_block_hits++;
+        block = allocator.empty_blocks[--allocator.empty_block_count];
+        int rc = madvise(block, ChunkedBlock::block_size, MADV_SET_NONVOLATILE);
+        bool this_block_was_purged = rc == 1;
+        if (rc < 0) {
+            perror("madvise");
+            VERIFY_NOT_REACHED();
+        }
+        rc = mprotect(block, ChunkedBlock::block_size, PROT_READ | PROT_WRITE);
+        if (rc < 0) {
+            perror("mprotect");
+            VERIFY_NOT_REACHED();
+        }
+        if (this_block_was_purged) {
+            g_malloc_stats.number_of_empty_block_purge_hits++;
+            new (block) ChunkedBlock(good_size);
+        }
+        allocator.usable_blocks.append(block);
+    }
+
+    if (!block) {
+        g_malloc_stats.number_of_block_allocs++;
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
+        block = (ChunkedBlock*)os_alloc(ChunkedBlock::block_size, buffer);
+        new (block) ChunkedBlock(good_size);
+        allocator.usable_blocks.append(block);
+        ++allocator.block_count;
+    }
+
+    --block->m_free_chunks;
+    void* ptr = block->m_freelist;
+    VERIFY(ptr);
+    block->m_freelist = block->m_freelist->next;
+    if (block->is_full()) {
+        g_malloc_stats.number_of_blocks_full++;
+        dbgln_if(MALLOC_DEBUG, "Block {:p} is now full in size class {}", block, good_size);
+        allocator.usable_blocks.remove(block);
+        allocator.full_blocks.append(block);
+    }
+    dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (chunk in block {:p}, size {})", ptr, block, block->bytes_per_chunk());
+    return ptr;
+}
+
+static void free_chunk(ChunkedBlock* block, void* ptr)
 {
+    dbgln_if(MALLOC_DEBUG, "LibC: freeing {:p} in allocator {:p} (size={}, used={})", ptr, block, block->bytes_per_chunk(), block->used_chunks());
+
+    auto* entry = (FreelistEntry*)ptr;
+    entry->next = block->m_freelist;
+    block->m_freelist = entry;
+
+    if (block->is_full()) {
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
+        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
+        g_malloc_stats.number_of_freed_full_blocks++;
+        allocator->full_blocks.remove(block);
+        allocator->usable_blocks.prepend(block);
+    }
+
+    ++block->m_free_chunks;
+
+    if (!block->used_chunks()) {
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
+        if (allocator->block_count < number_of_chunked_blocks_to_keep_around_per_size_class) {
+            dbgln_if(MALLOC_DEBUG, "Keeping block {:p} around for size class {}", block, good_size);
+            g_malloc_stats.number_of_keeps++;
+            allocator->usable_blocks.remove(block);
+            allocator->empty_blocks[allocator->empty_block_count++] = block;
+            mprotect(block, ChunkedBlock::block_size, PROT_NONE);
+            madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
+            return;
+        }
+        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, good_size);
+        g_malloc_stats.number_of_frees++;
+        allocator->usable_blocks.remove(block);
+        --allocator->block_count;
+        os_free(block, ChunkedBlock::block_size);
+    }
+}
+
+static inline ChunkedBlock* block_for_chunk(void* ptr)
+{
+    return (ChunkedBlock*)((FlatPtr)ptr & ChunkedBlock::block_mask);
+}
+
+// NOTE: The malloc lock must be held.
+static void fold_thread_cache_stats()
+{
+    g_malloc_stats.number_of_malloc_calls += t_thread_cache.number_of_malloc_hits;
+    g_malloc_stats.number_of_thread_cache_malloc_hits += t_thread_cache.number_of_malloc_hits;
+    g_malloc_stats.number_of_free_calls += t_thread_cache.number_of_free_hits;
+    g_malloc_stats.number_of_thread_cache_free_hits += t_thread_cache.number_of_free_hits;
+    t_thread_cache.number_of_malloc_hits = 0;
+    t_thread_cache.number_of_free_hits = 0;
+}
+
+static void* allocate_from_thread_cache(Allocator& allocator, size_t good_size)
+{
+    auto& magazine = t_thread_cache.magazines[size_class_index(allocator)];
+    if (magazine.count) {
+        ++t_thread_cache.number_of_malloc_hits;
+        return magazine.chunks[--magazine.count];
+    }
+
     LOCKER(malloc_lock());
+    fold_thread_cache_stats();
+    g_malloc_stats.number_of_malloc_calls++;
+    g_malloc_stats.number_of_thread_cache_refills++;
+
+    auto batch_size = thread_cache_batch_size(allocator);
+    while (magazine.count < batch_size)
+        magazine.chunks[magazine.count++] = allocate_chunk(allocator, good_size);
+    return magazine.chunks[--magazine.count];
+}
 
+static void free_to_thread_cache(Allocator& allocator, void* ptr)
+{
+    auto& magazine = t_thread_cache.magazines[size_class_index(allocator)];
+    auto batch_size = thread_cache_batch_size(allocator);
+
+    if (magazine.count == batch_size * 2) {
+        LOCKER(malloc_lock());
+        fold_thread_cache_stats();
+        g_malloc_stats.number_of_thread_cache_drains++;
+
+        // Give back the chunks that have been sitting in the magazine the longest,
+        // and keep the recently freed (likely still cache-hot) ones.
+        for (size_t i = 0; i < batch_size; ++i)
+            free_chunk(block_for_chunk(magazine.chunks[i]), magazine.chunks[i]);
+        for (size_t i = batch_size; i < magazine.count; ++i)
+            magazine.chunks[i - batch_size] = magazine.chunks[i];
+        magazine.count -= batch_size;
+    }
+
+    ++t_thread_cache.number_of_free_hits;
+    magazine.chunks[magazine.count++] = ptr;
+}
+
+static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_initialize_memory)
+{
     if (s_log_malloc)
         dbgln("LibC: malloc({})", size);
 
     if (!size)
         return nullptr;
 
-    g_malloc_stats.number_of_malloc_calls++;
-
     size_t good_size;
     auto* allocator = allocator_for_size(size, good_size);
 
+    if (allocator && is_thread_cached(*allocator)) {
+        void* ptr = allocate_from_thread_cache(*allocator, good_size);
+        if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
+            memset(ptr, MALLOC_SCRUB_BYTE, good_size);
+        ue_notify_malloc(ptr, size);
+        return ptr;
+    }
+
+    LOCKER(malloc_lock());
+
+    g_malloc_stats.number_of_malloc_calls++;
+
     if (!allocator) {
         size_t real_size = round_up_to_power_of_two(sizeof(BigAllocationBlock) + size, ChunkedBlock::block_size);
 #ifdef RECYCLE_BIG_ALLOCATIONS
@@ -224,58 +433,10 @@ static void* malloc_impl(size_t size, CallerWillInitializeMemory caller_will_ini
         return &block->m_slot[0];
     }
 
-    ChunkedBlock* block = nullptr;
-
-    for (block = allocator->usable_blocks.head(); block; block = block->next()) {
-        if (block->free_chunks())
-            break;
-    }
-
-    if (!block && allocator->empty_block_count) {
-        g_malloc_stats.number_of_empty_block_hits++;
-        block = allocator->empty_blocks[--allocator->empty_block_count];
-        int rc = madvise(block, ChunkedBlock::block_size, MADV_SET_NONVOLATILE);
-        bool this_block_was_purged = rc == 1;
-        if (rc < 0) {
-            perror("madvise");
-            VERIFY_NOT_REACHED();
-        }
-        rc = mprotect(block, ChunkedBlock::block_size, PROT_READ | PROT_WRITE);
-        if (rc < 0) {
-            perror("mprotect");
-            VERIFY_NOT_REACHED();
-        }
-        if (this_block_was_purged) {
-            g_malloc_stats.number_of_empty_block_purge_hits++;
-            new (block) ChunkedBlock(good_size);
-        }
-        allocator->usable_blocks.append(block);
-    }
-
-    if (!block) {
-        g_malloc_stats.number_of_block_allocs++;
-        char buffer[64];
-        snprintf(buffer, sizeof(buffer), "malloc: ChunkedBlock(%zu)", good_size);
-        block = (ChunkedBlock*)os_alloc(ChunkedBlock::block_size, buffer);
-        new (block) ChunkedBlock(good_size);
-        allocator->usable_blocks.append(block);
-        ++allocator->block_count;
-    }
-
-    --block->m_free_chunks;
-    void* ptr = block->m_freelist;
-    VERIFY(ptr);
-    block->m_freelist = block->m_freelist->next;
-    if (block->is_full()) {
-        g_malloc_stats.number_of_blocks_full++;
-        dbgln_if(MALLOC_DEBUG, "Block {:p} is now full in size class {}", block, good_size);
-        allocator->usable_blocks.remove(block);
-        allocator->full_blocks.append(block);
-    }
-    dbgln_if(MALLOC_DEBUG, "LibC: allocated {:p} (chunk in block {:p}, size {})", ptr, block, block->bytes_per_chunk());
+    void* ptr = allocate_chunk(*allocator, good_size);
 
     if (s_scrub_malloc && caller_will_initialize_memory == CallerWillInitializeMemory::No)
-        memset(ptr, MALLOC_SCRUB_BYTE, block->m_size);
+        memset(ptr, MALLOC_SCRUB_BYTE, good_size);
 
     ue_notify_malloc(ptr, size);
     return ptr;
@@ -288,12 +449,25 @@ static void free_impl(void* ptr)
     if (!ptr)
         return;
 
-    g_malloc_stats.number_of_free_calls++;
+    void* block_base = (void*)((FlatPtr)ptr & ChunkedBlock::ChunkedBlock::block_mask);
+    size_t magic = *(size_t*)block_base;
+
+    // NOTE: The block header can't change under us, since the block stays alive at least as long as ptr does.
+    if (magic == MAGIC_PAGE_HEADER) {
+        auto* block = (ChunkedBlock*)block_base;
+        size_t good_size;
+        auto* allocator = allocator_for_size(block->m_size, good_size);
+        if (is_thread_cached(*allocator)) {
+            if (s_scrub_free)
+                memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
+            free_to_thread_cache(*allocator, ptr);
+            return;
+        }
+    }
 
     LOCKER(malloc_lock());
 
-    void* block_base = (void*)((FlatPtr)ptr & ChunkedBlock::ChunkedBlock::block_mask);
-    size_t magic = *(size_t*)block_base;
+    g_malloc_stats.number_of_free_calls++;
 
     if (magic == MAGIC_BIGALLOC_HEADER) {
         auto* block = (BigAllocationBlock*)block_base;
@@ -323,44 +497,10 @@ static void free_impl(void* ptr)
     assert(magic == MAGIC_PAGE_HEADER);
     auto* block = (ChunkedBlock*)block_base;
 
-    dbgln_if(MALLOC_DEBUG, "LibC: freeing {:p} in allocator {:p} (size={}, used={})", ptr, block, block->bytes_per_chunk(), block->used_chunks());
-
     if (s_scrub_free)
         memset(ptr, FREE_SCRUB_BYTE, block->bytes_per_chunk());
 
-    auto* entry = (FreelistEntry*)ptr;
-    entry->next = block->m_freelist;
-    block->m_freelist = entry;
-
-    if (block->is_full()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        dbgln_if(MALLOC_DEBUG, "Block {:p} no longer full in size class {}", block, good_size);
-        g_malloc_stats.number_of_freed_full_blocks++;
-        allocator->full_blocks.remove(block);
-        allocator->usable_blocks.prepend(block);
-    }
-
-    ++block->m_free_chunks;
-
-    if (!block->used_chunks()) {
-        size_t good_size;
-        auto* allocator = allocator_for_size(block->m_size, good_size);
-        if (allocator->block_count < number_of_chunked_blocks_to_keep_around_per_size_class) {
-            dbgln_if(MALLOC_DEBUG, "Keeping block {:p} around for size class {}", block, good_size);
-            g_malloc_stats.number_of_keeps++;
-            allocator->usable_blocks.remove(block);
-            allocator->empty_blocks[allocator->empty_block_count++] = block;
-            mprotect(block, ChunkedBlock::block_size, PROT_NONE);
-            madvise(block, ChunkedBlock::block_size, MADV_SET_VOLATILE);
-            return;
-        }
-        dbgln_if(MALLOC_DEBUG, "Releasing block {:p} for size class {}", block, good_size);
-        g_malloc_stats.number_of_frees++;
-        allocator->usable_blocks.remove(block);
-        --allocator->block_count;
-        os_free(block, ChunkedBlock::block_size);
-    }
+    free_chunk(block, ptr);
 }
 
 [[gnu::flatten]] void* malloc(size_t size)
@@ -454,8 +594,26 @@ void __malloc_init()
     new (&big_allocators()[0])(BigAllocator);
 }
 
+void __malloc_flush_thread_cache()
+{
+    LOCKER(malloc_lock());
+    fold_thread_cache_stats();
+    g_malloc_stats.number_of_thread_cache_flushes++;
+
+    for (auto& magazine : t_thread_cache.magazines) {
+        for (size_t i = 0; i < magazine.count; ++i)
+            free_chunk(block_for_chunk(magazine.chunks[i]), magazine.chunks[i]);
+        magazine.count = 0;
+    }
+}
+
 void serenity_dump_malloc_stats()
 {
+    {
+        LOCKER(malloc_lock());
+        fold_thread_cache_stats();
+    }
+
     dbgln("# malloc() calls: {}", g_malloc_stats.number_of_malloc_calls);
     dbgln();
     dbgln("big alloc hits: {}", g_malloc_stats.number_of_big_allocator_hits);
@@ -475,5 +633,11 @@ void serenity_dump_malloc_stats()
     dbgln("full block frees: {}", g_malloc_stats.number_of_freed_full_blocks);
     dbgln("number of keeps: {}", g_malloc_stats.number_of_keeps);
     dbgln("number of frees: {}", g_malloc_stats.number_of_frees);
+    dbgln();
+    dbgln("thread cache malloc hits: {}", g_malloc_stats.number_of_thread_cache_malloc_hits);
+    dbgln("thread cache refills: {}", g_malloc_stats.number_of_thread_cache_refills);
+    dbgln("thread cache free hits: {}", g_malloc_stats.number_of_thread_cache_free_hits);
+    dbgln("thread cache drains: {}", g_malloc_stats.number_of_thread_cache_drains);
+    dbgln("thread cache flushes: {}", g_malloc_stats.number_of_thread_cache_flushes);
 }
 }
@@ -50,6 +50,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/select.h>
+#ifdef __serenity__
+#    include <sys/epoll.h>
+#endif
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/time.h>
@@ -82,6 +85,13 @@ static NeverDestroyed<IDAllocator> s_id_allocator;
 static HashMap<int, NonnullOwnPtr<EventLoopTimer>>* s_timers;
 static HashTable<Notifier*>* s_notifiers;
 int EventLoop::s_wake_pipe_fds[2];
+#ifdef __serenity__
+// Notifiers are watched through a persistent kernel event queue instead of
+// rebuilding fd sets for every select() call. The queue is keyed by fd, and
+// several notifiers may share one (e.g. one for reading and one for writing).
+static int s_event_queue_fd { -1 };
+static HashMap<int, Vector<Notifier*, 1>>* s_notifiers_by_fd;
+#endif
 static RefPtr<LocalServer> s_rpc_server;
 HashMap<int, RefPtr<RPCClient>> s_rpc_clients;
 
@@ -282,6 +292,9 @@ EventLoop::EventLoop()
         s_event_loop_stack = new Vector<EventLoop*>;
         s_timers = new HashMap<int, NonnullOwnPtr<EventLoopTimer>>;
         s_notifiers = new HashTable<Notifier*>;
+#ifdef __serenity__
+        s_notifiers_by_fd = new HashMap<int, Vector<Notifier*, 1>>;
+#endif
     }
 
     if (!s_main_event_loop) {
@@ -580,6 +593,14 @@ void EventLoop::notify_forked(ForkEvent event)
         s_event_loop_stack->clear();
         s_timers->clear();
         s_notifiers->clear();
+#ifdef __serenity__
+        // The event queue is shared with our parent, we must not touch its registrations.
+        s_notifiers_by_fd->clear();
+        if (s_event_queue_fd >= 0) {
+            close(s_event_queue_fd);
+            s_event_queue_fd = -1;
+        }
+#endif
         if (auto* info = signals_info<false>()) {
             info->signal_handlers.clear();
             info->next_signal_id = 0;
@@ -597,6 +618,10 @@ void EventLoop::notify_forked(ForkEvent event)
 
 void EventLoop::wait_for_event(WaitMode mode)
 {
+#ifdef __serenity__
+    epoll_event ready_events[64];
+retry:
+#else
     fd_set rfds;
     fd_set wfds;
 retry:
@@ -621,6 +646,7 @@ retry:
         if (notifier->event_mask() & Notifier::Exceptional)
             VERIFY_NOT_REACHED();
     }
+#endif
 
     bool queued_events_is_empty;
     {
@@ -649,7 +675,14 @@ retry:
     }
 
 try_select_again:
+#ifdef __serenity__
+    int timeout_ms = -1;
+    if (!should_wait_forever)
+        timeout_ms = timeout.tv_sec * 1000 + (timeout.tv_usec + 999) / 1000;
+    int marked_fd_count = epoll_wait(event_queue_fd(), ready_events, array_size(ready_events), timeout_ms);
+#else
     int marked_fd_count = select(max_fd + 1, &rfds, &wfds, nullptr, should_wait_forever ? nullptr : &timeout);
+#endif
     if (marked_fd_count < 0) {
         int saved_errno = errno;
         if (saved_errno == EINTR) {
@@ -662,7 +695,16 @@ try_select_again:
         // Blow up, similar to Core::safe_syscall.
         VERIFY_NOT_REACHED();
     }
-    if (FD_ISSET(s_wake_pipe_fds[0], &rfds)) {
+#ifdef __serenity__
+    bool wake_pipe_is_readable = false;
+    for (int i = 0; i < marked_fd_count; ++i) {
+        if (ready_events[i].data.fd == s_wake_pipe_fds[0])
+            wake_pipe_is_readable = true;
+    }
+#else
+    bool wake_pipe_is_readable = FD_ISSET(s_wake_pipe_fds[0], &rfds);
+#endif
+    if (wake_pipe_is_readable) {
         int wake_events[8];
         auto nread = read(s_wake_pipe_fds[0], wake_events, sizeof(wake_events));
         if (nread < 0) {
@@ -715,6 +757,20 @@ try_select_again:
     if (!marked_fd_count)
         return;
 
+#ifdef __serenity__
+    for (int i = 0; i < marked_fd_count; ++i) {
+        auto& ready_event = ready_events[i];
+        auto it = s_notifiers_by_fd->find(ready_event.data.fd);
+        if (it == s_notifiers_by_fd->end())
+            continue;
+        for (auto* notifier : it->value) {
+            if ((ready_event.events & EPOLLIN) && (notifier->event_mask() & Notifier::Event::Read))
+                post_event(*notifier, make<NotifierReadEvent>(notifier->fd()));
+            if ((ready_event.events & EPOLLOUT) && (notifier->event_mask() & Notifier::Event::Write))
+                post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
+        }
+    }
+#else
     for (auto& notifier : *s_notifiers) {
         if (FD_ISSET(notifier->fd(), &rfds)) {
             if (notifier->event_mask() & Notifier::Event::Read)
@@ -725,6 +781,7 @@ try_select_again:
                 post_event(*notifier, make<NotifierWriteEvent>(notifier->fd()));
         }
     }
+#endif
 }
 
 bool EventLoopTimer::has_expired(const timeval& now) const
@@ -787,14 +844,92 @@ bool EventLoop::unregister_timer(int timer_id)
 
 void EventLoop::register_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->set(&notifier);
+    if (s_notifiers->set(&notifier) != AK::HashSetResult::InsertedNewEntry)
+        return;
+#ifdef __serenity__
+    s_notifiers_by_fd->ensure(notifier.fd()).append(&notifier);
+    update_event_queue_interest(notifier.fd());
+#endif
 }
 
 void EventLoop::unregister_notifier(Badge<Notifier>, Notifier& notifier)
 {
-    s_notifiers->remove(&notifier);
+    if (!s_notifiers->remove(&notifier))
+        return;
+#ifdef __serenity__
+    auto it = s_notifiers_by_fd->find(notifier.fd());
+    VERIFY(it != s_notifiers_by_fd->end());
+    it->value.remove_first_matching([&](auto* entry) { return entry == &notifier; });
+    if (it->value.is_empty())
+        s_notifiers_by_fd->remove(it);
+    update_event_queue_interest(notifier.fd());
+#endif
+}
+
+void EventLoop::notifier_event_mask_changed(Badge<Notifier>, [[maybe_unused]] Notifier& notifier)
+{
+#ifdef __serenity__
+    if (s_notifiers->contains(&notifier))
+        update_event_queue_interest(notifier.fd());
+#endif
 }
 
+#ifdef __serenity__
+int EventLoop::event_queue_fd()
+{
+    if (s_event_queue_fd >= 0)
+        return s_event_queue_fd;
+
+    s_event_queue_fd = epoll_create1(EPOLL_CLOEXEC);
+    VERIFY(s_event_queue_fd >= 0);
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = s_wake_pipe_fds[0];
+    int rc = epoll_ctl(s_event_queue_fd, EPOLL_CTL_ADD, s_wake_pipe_fds[0], &event);
+    VERIFY(rc == 0);
+
+    for (auto& it : *s_notifiers_by_fd)
+        update_event_queue_interest(it.key);
+    return s_event_queue_fd;
+}
+
+void EventLoop::update_event_queue_interest(int fd)
+{
+    if (s_event_queue_fd < 0) {
+        // The queue will pick up all notifiers once it's created.
+        return;
+    }
+
+    u32 events = 0;
+    if (auto it = s_notifiers_by_fd->find(fd); it != s_notifiers_by_fd->end()) {
+        for (auto* notifier : it->value) {
+            if (notifier->event_mask() & Notifier::Event::Read)
+                events |= EPOLLIN;
+            if (notifier->event_mask() & Notifier::Event::Write)
+                events |= EPOLLOUT;
+            if (notifier->event_mask() & Notifier::Event::Exceptional)
+                VERIFY_NOT_REACHED();
+        }
+    }
+
+    if (!events) {
+        // NOTE: This fails if the fd was already closed, in which case the kernel has forgotten about it anyway.
+        (void)epoll_ctl(s_event_queue_fd, EPOLL_CTL_DEL, fd, nullptr);
+        return;
+    }
+
+    epoll_event event {};
+    event.events = events;
+    event.data.fd = fd;
+    int rc = epoll_ctl(s_event_queue_fd, EPOLL_CTL_MOD, fd, &event);
+    if (rc < 0 && errno == ENOENT)
+        rc = epoll_ctl(s_event_queue_fd, EPOLL_CTL_ADD, fd, &event);
+    if (rc < 0)
+        dbgln("Core::EventLoop: Failed to watch fd {} for events {:#x}: {}", fd, events, strerror(errno));
+}
+#endif
+
 void EventLoop::wake()
 {
     int wake_event = 0;
@@ -67,6 +67,7 @@ public:
 
     static void register_notifier(Badge<Notifier>, Notifier&);
     static void unregister_notifier(Badge<Notifier>, Notifier&);
+    static void notifier_event_mask_changed(Badge<Notifier>, Notifier&);
 
     void quit(int);
     void unquit();
@@ -94,6 +95,10 @@ private:
     Optional<struct timeval> get_next_timer_expiration();
     static void dispatch_signal(int);
     static void handle_signal(int);
+#ifdef __serenity__
+    static int event_queue_fd();
+    static void update_event_queue_interest(int fd);
+#endif
 
     struct QueuedEvent {
         AK_MAKE_NONCOPYABLE(QueuedEvent);
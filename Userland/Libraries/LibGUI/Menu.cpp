@@ -111,19 +111,23 @@ int Menu::realize_menu(RefPtr<Action> default_action)
     dbgln("GUI::Menu::realize_menu(): New menu ID: {}", m_menu_id);
 #endif
     VERIFY(m_menu_id > 0);
+
+    // Post all the items before waiting for any of them, so we don't pay a round trip per item.
+    Vector<IPC::ReplyFuture<Messages::WindowServer::AddMenuSeparatorResponse>> pending_separators;
+    Vector<IPC::ReplyFuture<Messages::WindowServer::AddMenuItemResponse>> pending_items;
     for (size_t i = 0; i < m_items.size(); ++i) {
         auto& item = m_items[i];
         item.set_menu_id({}, m_menu_id);
         item.set_identifier({}, i);
         if (item.type() == MenuItem::Type::Separator) {
-            WindowServerConnection::the().send_sync<Messages::WindowServer::AddMenuSeparator>(m_menu_id);
+            pending_separators.append(WindowServerConnection::the().async_add_menu_separator(m_menu_id));
             continue;
         }
         if (item.type() == MenuItem::Type::Submenu) {
             auto& submenu = *item.submenu();
             submenu.realize_if_needed(default_action);
             auto icon = submenu.icon() ? submenu.icon()->to_shareable_bitmap() : Gfx::ShareableBitmap();
-            WindowServerConnection::the().send_sync<Messages::WindowServer::AddMenuItem>(m_menu_id, i, submenu.menu_id(), submenu.name(), true, false, false, false, "", icon, false);
+            pending_items.append(WindowServerConnection::the().async_add_menu_item(m_menu_id, i, submenu.menu_id(), submenu.name(), true, false, false, false, "", icon, false));
             continue;
         }
         if (item.type() == MenuItem::Type::Action) {
@@ -132,9 +136,18 @@ int Menu::realize_menu(RefPtr<Action> default_action)
             bool exclusive = action.group() && action.group()->is_exclusive() && action.is_checkable();
             bool is_default = (default_action.ptr() == &action);
             auto icon = action.icon() ? action.icon()->to_shareable_bitmap() : Gfx::ShareableBitmap();
-            WindowServerConnection::the().send_sync<Messages::WindowServer::AddMenuItem>(m_menu_id, i, -1, action.text(), action.is_enabled(), action.is_checkable(), action.is_checkable() ? action.is_checked() : false, is_default, shortcut_text, icon, exclusive);
+            pending_items.append(WindowServerConnection::the().async_add_menu_item(m_menu_id, i, -1, action.text(), action.is_enabled(), action.is_checkable(), action.is_checkable() ? action.is_checked() : false, is_default, shortcut_text, icon, exclusive));
         }
     }
+    for (auto& separator : pending_separators) {
+        auto response = separator.wait();
+        VERIFY(response);
+    }
+    for (auto& item : pending_items) {
+        auto response = item.wait();
+        VERIFY(response);
+    }
+
     all_menus().set(m_menu_id, this);
     m_last_default_action = default_action;
     return m_menu_id;
@@ -34,7 +34,8 @@ namespace GUI {
 
 class WindowServerConnection
     : public IPC::ServerConnection<WindowClientEndpoint, WindowServerEndpoint>
-    , public WindowClientEndpoint {
+    , public WindowClientEndpoint
+    , public WindowServerProxy<WindowServerConnection> {
     C_OBJECT(WindowServerConnection)
 public:
     WindowServerConnection()
@@ -27,6 +27,8 @@
 #pragma once
 
 #include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/HashTable.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
@@ -35,6 +37,8 @@
 #include <LibCore/SyscallUtils.h>
 #include <LibCore/Timer.h>
 #include <LibIPC/Message.h>
+#include <LibIPC/OutOfLineRing.h>
+#include <LibIPC/ReplyFuture.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -74,7 +78,7 @@ public:
         if (!m_socket->is_open())
             return;
 
-        auto buffer = message.encode();
+        auto buffer = message.encode(&m_out_of_line_rings);
         // Prepend the message size.
         uint32_t message_size = buffer.data.size();
         buffer.data.prepend(reinterpret_cast<const u8*>(&message_size), sizeof(message_size));
@@ -118,10 +122,29 @@ public:
     }
 
     template<typename RequestType, typename... Args>
-    OwnPtr<typename RequestType::ResponseType> send_sync(Args&&... args)
+    ReplyFuture<typename RequestType::ResponseType> post_message_with_reply(Args&&... args)
     {
+        using ResponseType = typename RequestType::ResponseType;
+        auto& replies = m_pending_replies.ensure(ResponseType::static_message_id());
+        auto sequence = replies.next_request++;
         post_message(RequestType(forward<Args>(args)...));
-        auto response = wait_for_specific_endpoint_message<typename RequestType::ResponseType, PeerEndpoint>();
+        return {
+            [weak_this = make_weak_ptr<Connection>(), sequence]() mutable -> OwnPtr<ResponseType> {
+                if (!weak_this)
+                    return {};
+                return weak_this->template wait_for_reply<ResponseType>(sequence);
+            },
+            [weak_this = make_weak_ptr<Connection>(), sequence]() mutable {
+                if (weak_this)
+                    weak_this->template abandon_reply<ResponseType>(sequence);
+            }
+        };
+    }
+
+    template<typename RequestType, typename... Args>
+    OwnPtr<typename RequestType::ResponseType> send_sync(Args&&... args)
+    {
+        auto response = post_message_with_reply<RequestType>(forward<Args>(args)...).wait();
         VERIFY(response);
         return response;
     }
@@ -129,8 +152,7 @@ public:
     template<typename RequestType, typename... Args>
     OwnPtr<typename RequestType::ResponseType> send_sync_but_allow_failure(Args&&... args)
     {
-        post_message(RequestType(forward<Args>(args)...));
-        return wait_for_specific_endpoint_message<typename RequestType::ResponseType, PeerEndpoint>();
+        return post_message_with_reply<RequestType>(forward<Args>(args)...).wait();
     }
 
     virtual void may_have_become_unresponsive() { }
@@ -162,23 +184,67 @@ protected:
                     return m_unprocessed_messages.take(i).template release_nonnull<MessageType>();
             }
 
-            if (!m_socket->is_open())
+            if (!wait_for_messages_from_peer())
                 break;
-            fd_set rfds;
-            FD_ZERO(&rfds);
-            FD_SET(m_socket->fd(), &rfds);
-            int rc = Core::safe_syscall(select, m_socket->fd() + 1, &rfds, nullptr, nullptr, nullptr);
-            if (rc < 0) {
-                perror("select");
+        }
+        return {};
+    }
+
+    template<typename ResponseType>
+    OwnPtr<ResponseType> wait_for_reply(u32 sequence)
+    {
+        for (;;) {
+            auto& replies = m_pending_replies.find(ResponseType::static_message_id())->value;
+            auto it = replies.arrived.find(sequence);
+            if (it != replies.arrived.end()) {
+                auto reply = move(it->value);
+                replies.arrived.remove(it);
+                return reply.template release_nonnull<ResponseType>();
             }
-            VERIFY(rc > 0);
-            VERIFY(FD_ISSET(m_socket->fd(), &rfds));
-            if (!drain_messages_from_peer())
+            if (!wait_for_messages_from_peer())
                 break;
         }
         return {};
     }
 
+    template<typename ResponseType>
+    void abandon_reply(u32 sequence)
+    {
+        auto& replies = m_pending_replies.find(ResponseType::static_message_id())->value;
+        if (!replies.arrived.remove(sequence) && sequence >= replies.next_reply)
+            replies.abandoned.set(sequence);
+    }
+
+    bool wait_for_messages_from_peer()
+    {
+        if (!m_socket->is_open())
+            return false;
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(m_socket->fd(), &rfds);
+        int rc = Core::safe_syscall(select, m_socket->fd() + 1, &rfds, nullptr, nullptr, nullptr);
+        if (rc < 0) {
+            perror("select");
+        }
+        VERIFY(rc > 0);
+        VERIFY(FD_ISSET(m_socket->fd(), &rfds));
+        return drain_messages_from_peer();
+    }
+
+    void enqueue_message_from_peer(NonnullOwnPtr<Message> message)
+    {
+        // Replies are matched to their requests by their position in the pending-reply table.
+        auto it = m_pending_replies.find(message->message_id());
+        if (it == m_pending_replies.end() || it->value.next_reply == it->value.next_request) {
+            m_unprocessed_messages.append(move(message));
+            return;
+        }
+        auto& replies = it->value;
+        auto sequence = replies.next_reply++;
+        if (!replies.abandoned.remove(sequence))
+            replies.arrived.set(sequence, move(message));
+    }
+
     bool drain_messages_from_peer()
     {
         Vector<u8> bytes;
@@ -220,10 +286,10 @@ protected:
                 break;
             index += sizeof(message_size);
             auto remaining_bytes = ReadonlyBytes { bytes.data() + index, bytes.size() - index };
-            if (auto message = LocalEndpoint::decode_message(remaining_bytes, m_socket->fd())) {
-                m_unprocessed_messages.append(message.release_nonnull());
-            } else if (auto message = PeerEndpoint::decode_message(remaining_bytes, m_socket->fd())) {
+            if (auto message = LocalEndpoint::decode_message(remaining_bytes, m_socket->fd(), &m_out_of_line_rings)) {
                 m_unprocessed_messages.append(message.release_nonnull());
+            } else if (auto message = PeerEndpoint::decode_message(remaining_bytes, m_socket->fd(), &m_out_of_line_rings)) {
+                enqueue_message_from_peer(message.release_nonnull());
             } else {
                 dbgln("Failed to parse a message");
                 break;
@@ -262,6 +328,14 @@ protected:
     }
 
 protected:
+    // Replies to the requests we've sent, keyed by the reply's message ID.
+    struct PendingReplies {
+        u32 next_request { 0 };
+        u32 next_reply { 0 };
+        HashMap<u32, OwnPtr<Message>> arrived;
+        HashTable<u32> abandoned;
+    };
+
     LocalEndpoint& m_local_endpoint;
     NonnullRefPtr<Core::LocalSocket> m_socket;
     RefPtr<Core::Timer> m_responsiveness_timer;
@@ -269,6 +343,8 @@ protected:
     RefPtr<Core::Notifier> m_notifier;
     NonnullOwnPtrVector<Message> m_unprocessed_messages;
     ByteBuffer m_unprocessed_bytes;
+    OutOfLineRings m_out_of_line_rings;
+    HashMap<i32, PendingReplies> m_pending_replies;
 };
 
 }
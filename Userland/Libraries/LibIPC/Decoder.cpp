@@ -31,6 +31,7 @@
 #include <LibIPC/Decoder.h>
 #include <LibIPC/Dictionary.h>
 #include <LibIPC/File.h>
+#include <LibIPC/OutOfLineRing.h>
 #include <fcntl.h>
 #include <string.h>
 #include <sys/socket.h>
@@ -186,6 +187,41 @@ bool Decoder::decode([[maybe_unused]] File& file)
 #endif
 }
 
+bool Decoder::begin_out_of_line_chunk(u8 kind, u32& position, ReadonlyBytes& bytes)
+{
+    if (!m_out_of_line_rings)
+        return false;
+
+    if (kind == (u8)OutOfLineKind::AttachRing) {
+        u32 ring_size;
+        if (!decode(ring_size))
+            return false;
+        IPC::File ring_file;
+        if (!decode(ring_file))
+            return false;
+        m_out_of_line_rings->incoming = OutOfLineRing::create_from_anon_fd(ring_file.take_fd(), ring_size);
+    } else if (kind != (u8)OutOfLineKind::InRing) {
+        return false;
+    }
+
+    auto& ring = m_out_of_line_rings->incoming;
+    if (!ring)
+        return false;
+    u32 size;
+    if (!decode(position) || !decode(size))
+        return false;
+    auto chunk = ring->bytes_at(position, size);
+    if (!chunk.has_value())
+        return false;
+    bytes = chunk.value();
+    return true;
+}
+
+void Decoder::end_out_of_line_chunk(u32 position, u32 size)
+{
+    m_out_of_line_rings->incoming->release(position, size);
+}
+
 bool decode(Decoder& decoder, Core::AnonymousBuffer& buffer)
 {
     bool valid = false;
@@ -27,11 +27,13 @@
 #pragma once
 
 #include <AK/Forward.h>
+#include <AK/MemoryStream.h>
 #include <AK/NumericLimits.h>
 #include <AK/StdLibExtras.h>
 #include <AK/String.h>
 #include <LibIPC/Forward.h>
 #include <LibIPC/Message.h>
+#include <LibIPC/OutOfLineRing.h>
 
 namespace IPC {
 
@@ -44,9 +46,10 @@ inline bool decode(Decoder&, T&)
 
 class Decoder {
 public:
-    Decoder(InputMemoryStream& stream, int sockfd)
+    Decoder(InputMemoryStream& stream, int sockfd, OutOfLineRings* out_of_line_rings = nullptr)
         : m_stream(stream)
         , m_sockfd(sockfd)
+        , m_out_of_line_rings(out_of_line_rings)
     {
     }
 
@@ -124,9 +127,33 @@ public:
         return true;
     }
 
+    template<typename T>
+    bool decode_out_of_line(T& value)
+    {
+        u8 kind;
+        if (!decode(kind))
+            return false;
+        if (kind == (u8)OutOfLineKind::Inline)
+            return decode(value);
+
+        u32 position;
+        ReadonlyBytes bytes;
+        if (!begin_out_of_line_chunk(kind, position, bytes))
+            return false;
+        InputMemoryStream chunk_stream { bytes };
+        Decoder chunk_decoder { chunk_stream, m_sockfd, m_out_of_line_rings };
+        bool decoded = chunk_decoder.decode(value);
+        end_out_of_line_chunk(position, bytes.size());
+        return decoded;
+    }
+
 private:
+    bool begin_out_of_line_chunk(u8 kind, u32& position, ReadonlyBytes&);
+    void end_out_of_line_chunk(u32 position, u32 size);
+
     InputMemoryStream& m_stream;
     int m_sockfd { -1 };
+    OutOfLineRings* m_out_of_line_rings { nullptr };
 };
 
 }
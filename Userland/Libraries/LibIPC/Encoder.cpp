@@ -32,6 +32,7 @@
 #include <LibIPC/Dictionary.h>
 #include <LibIPC/Encoder.h>
 #include <LibIPC/File.h>
+#include <LibIPC/OutOfLineRing.h>
 
 namespace IPC {
 
@@ -172,6 +173,32 @@ Encoder& Encoder::operator<<(const File& file)
     return *this;
 }
 
+void Encoder::append_out_of_line_chunk(MessageBuffer& chunk)
+{
+#ifdef __serenity__
+    if (m_out_of_line_rings && chunk.data.size() >= OutOfLineRing::min_chunk_size) {
+        auto& ring = m_out_of_line_rings->outgoing;
+        if (!ring)
+            ring = OutOfLineRing::create();
+        if (auto position = ring ? ring->try_write(chunk.data.span()) : Optional<u32> {}; position.has_value()) {
+            if (ring->has_been_announced()) {
+                *this << (u8)OutOfLineKind::InRing;
+            } else {
+                *this << (u8)OutOfLineKind::AttachRing << (u32)ring->buffer().size() << IPC::File(ring->buffer().fd());
+                ring->set_announced();
+            }
+            *this << position.value() << (u32)chunk.data.size();
+            m_buffer.fds.append(chunk.fds.data(), chunk.fds.size());
+            return;
+        }
+    }
+#endif
+    // Without a ring (or room in it), the chunk just follows the marker.
+    *this << (u8)OutOfLineKind::Inline;
+    m_buffer.data.append(chunk.data.data(), chunk.data.size());
+    m_buffer.fds.append(chunk.fds.data(), chunk.fds.size());
+}
+
 bool encode(Encoder& encoder, const Core::AnonymousBuffer& buffer)
 {
     encoder << buffer.is_valid();
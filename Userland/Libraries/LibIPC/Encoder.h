@@ -40,8 +40,9 @@ bool encode(Encoder&, T&)
 
 class Encoder {
 public:
-    explicit Encoder(MessageBuffer& buffer)
+    explicit Encoder(MessageBuffer& buffer, OutOfLineRings* out_of_line_rings = nullptr)
         : m_buffer(buffer)
+        , m_out_of_line_rings(out_of_line_rings)
     {
     }
 
@@ -104,8 +105,21 @@ public:
         IPC::encode(*this, value);
     }
 
+    // Large values go through the connection's shared memory ring instead of the socket, if there's room.
+    template<typename T>
+    void encode_out_of_line(const T& value)
+    {
+        MessageBuffer chunk;
+        Encoder chunk_encoder { chunk };
+        chunk_encoder << value;
+        append_out_of_line_chunk(chunk);
+    }
+
 private:
+    void append_out_of_line_chunk(MessageBuffer&);
+
     MessageBuffer& m_buffer;
+    OutOfLineRings* m_out_of_line_rings { nullptr };
 };
 
 }
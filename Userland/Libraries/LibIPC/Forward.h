@@ -33,5 +33,9 @@ class Dictionary;
 class Encoder;
 class Message;
 class File;
+class OutOfLineRing;
+struct OutOfLineRings;
+template<typename ResponseType>
+class ReplyFuture;
 
 }
@@ -28,6 +28,7 @@
 
 #include <AK/Function.h>
 #include <AK/Vector.h>
+#include <LibIPC/Forward.h>
 
 namespace IPC {
 
@@ -43,7 +44,7 @@ public:
     virtual int endpoint_magic() const = 0;
     virtual int message_id() const = 0;
     virtual const char* message_name() const = 0;
-    virtual MessageBuffer encode() const = 0;
+    virtual MessageBuffer encode(OutOfLineRings*) const = 0;
 
 protected:
     Message();
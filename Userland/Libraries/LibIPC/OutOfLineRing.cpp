@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/Atomic.h>
+#include <AK/StdLibExtras.h>
+#include <LibIPC/OutOfLineRing.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace IPC {
+
+static bool is_valid_capacity(size_t capacity)
+{
+    return capacity >= (size_t)PAGE_SIZE && capacity <= 256 * MiB && (capacity & (capacity - 1)) == 0;
+}
+
+RefPtr<OutOfLineRing> OutOfLineRing::create(size_t capacity)
+{
+    VERIFY(is_valid_capacity(capacity));
+    auto buffer = Core::AnonymousBuffer::create_with_size(data_offset + capacity);
+    if (!buffer.is_valid())
+        return {};
+    return adopt(*new OutOfLineRing(move(buffer), capacity));
+}
+
+RefPtr<OutOfLineRing> OutOfLineRing::create_from_anon_fd(int fd, size_t size)
+{
+    // The size comes from the peer, so don't take it at face value.
+    if (size <= data_offset || !is_valid_capacity(size - data_offset)) {
+        close(fd);
+        return {};
+    }
+    auto buffer = Core::AnonymousBuffer::create_from_anon_fd(fd, size);
+    if (!buffer.is_valid()) {
+        close(fd);
+        return {};
+    }
+    return adopt(*new OutOfLineRing(move(buffer), size - data_offset));
+}
+
+OutOfLineRing::OutOfLineRing(Core::AnonymousBuffer buffer, u32 capacity)
+    : m_buffer(move(buffer))
+    , m_capacity(capacity)
+{
+}
+
+Optional<u32> OutOfLineRing::try_write(ReadonlyBytes bytes)
+{
+    if (bytes.size() > m_capacity)
+        return {};
+
+    u32 consumed = AK::atomic_load(&header().consumed, AK::MemoryOrder::memory_order_acquire);
+    // A peer that claims to have consumed more than we wrote doesn't get any more chunks.
+    if (m_tail - consumed > m_capacity)
+        return {};
+
+    // Chunks are kept contiguous, so skip the rest of the ring if this one doesn't fit before the end.
+    u32 position = m_tail;
+    u32 offset = position & (m_capacity - 1);
+    if (offset + bytes.size() > m_capacity) {
+        position += m_capacity - offset;
+        offset = 0;
+    }
+    if (position + bytes.size() - consumed > m_capacity)
+        return {};
+
+    memcpy(data() + offset, bytes.data(), bytes.size());
+    m_tail = position + bytes.size();
+    return position;
+}
+
+Optional<ReadonlyBytes> OutOfLineRing::bytes_at(u32 position, u32 size) const
+{
+    u32 offset = position & (m_capacity - 1);
+    if (size > m_capacity || offset + size > m_capacity)
+        return {};
+    return ReadonlyBytes { data() + offset, size };
+}
+
+void OutOfLineRing::release(u32 position, u32 size)
+{
+    AK::atomic_store(&header().consumed, position + size, AK::MemoryOrder::memory_order_release);
+}
+
+}
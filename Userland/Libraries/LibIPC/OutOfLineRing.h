@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Optional.h>
+#include <AK/RefCounted.h>
+#include <AK/RefPtr.h>
+#include <AK/Span.h>
+#include <AK/Types.h>
+#include <LibCore/AnonymousBuffer.h>
+
+namespace IPC {
+
+// How an out-of-line parameter was sent. See Encoder::encode_out_of_line().
+enum class OutOfLineKind : u8 {
+    Inline,
+    InRing,
+    AttachRing,
+};
+
+// A ring of shared memory that one side of a connection writes large message parameters into.
+// Only the position and size of each chunk travel over the socket. The peer copies the chunk out
+// while decoding and then hands the space back by advancing the consumed position in the header.
+// Positions only ever grow (modulo 2^32), and chunks never wrap around the end of the ring.
+class OutOfLineRing : public RefCounted<OutOfLineRing> {
+public:
+    static constexpr size_t default_capacity = 4 * MiB;
+
+    // Parameters smaller than this are cheaper to just send inline.
+    static constexpr size_t min_chunk_size = 4 * KiB;
+
+    static RefPtr<OutOfLineRing> create(size_t capacity = default_capacity);
+    static RefPtr<OutOfLineRing> create_from_anon_fd(int fd, size_t size);
+
+    const Core::AnonymousBuffer& buffer() const { return m_buffer; }
+    u32 capacity() const { return m_capacity; }
+
+    // The peer only learns about the ring from the first chunk that's written into it.
+    bool has_been_announced() const { return m_announced; }
+    void set_announced() { m_announced = true; }
+
+    // Writing side: Returns the position of the chunk, or nothing if the ring is too full.
+    Optional<u32> try_write(ReadonlyBytes);
+
+    // Reading side
+    Optional<ReadonlyBytes> bytes_at(u32 position, u32 size) const;
+    void release(u32 position, u32 size);
+
+private:
+    struct Header {
+        u32 consumed;
+    };
+
+    OutOfLineRing(Core::AnonymousBuffer, u32 capacity);
+
+    Header& header() { return *m_buffer.data<Header>(); }
+    u8* data() { return m_buffer.data<u8>() + data_offset; }
+    const u8* data() const { return m_buffer.data<u8>() + data_offset; }
+
+    static constexpr size_t data_offset = 64;
+
+    Core::AnonymousBuffer m_buffer;
+    u32 m_capacity { 0 };
+    u32 m_tail { 0 };
+    bool m_announced { false };
+};
+
+// The rings of one connection, one for each direction.
+struct OutOfLineRings {
+    RefPtr<OutOfLineRing> outgoing;
+    RefPtr<OutOfLineRing> incoming;
+};
+
+}
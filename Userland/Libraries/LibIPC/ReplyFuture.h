@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Function.h>
+#include <AK/Noncopyable.h>
+#include <AK/OwnPtr.h>
+#include <AK/StdLibExtras.h>
+
+namespace IPC {
+
+// The reply to a synchronous request that has been posted but not waited for yet.
+// Replies to the same message type come back in the order the requests were sent,
+// so several requests can be in flight at once and waited for later, in any order.
+template<typename ResponseType>
+class [[nodiscard]] ReplyFuture {
+    AK_MAKE_NONCOPYABLE(ReplyFuture);
+
+public:
+    ReplyFuture(Function<OwnPtr<ResponseType>()> wait, Function<void()> abandon)
+        : m_wait(move(wait))
+        , m_abandon(move(abandon))
+    {
+    }
+
+    ReplyFuture(ReplyFuture&& other)
+        : m_wait(move(other.m_wait))
+        , m_abandon(move(other.m_abandon))
+    {
+    }
+
+    ~ReplyFuture()
+    {
+        // Nobody is going to look at the reply, so let the connection drop it when it arrives.
+        if (m_abandon)
+            m_abandon();
+    }
+
+    // Blocks until the reply has arrived. Returns null if the connection went away first.
+    OwnPtr<ResponseType> wait()
+    {
+        VERIFY(m_wait);
+        m_abandon = nullptr;
+        auto wait = move(m_wait);
+        return wait();
+    }
+
+private:
+    Function<OwnPtr<ResponseType>()> m_wait;
+    Function<void()> m_abandon;
+};
+
+}
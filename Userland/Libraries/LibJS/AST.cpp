@@ -33,6 +33,7 @@
 #include <AK/TemporaryChange.h>
 #include <LibCrypto/BigInt/SignedBigInteger.h>
 #include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/Accessor.h>
 #include <LibJS/Runtime/Array.h>
@@ -105,6 +106,13 @@ Value ScopeNode::execute(Interpreter& interpreter, GlobalObject& global_object)
     return interpreter.execute_statement(global_object, *this);
 }
 
+const Bytecode::Executable& ScopeNode::bytecode_executable() const
+{
+    if (!m_bytecode_executable)
+        m_bytecode_executable = Bytecode::Generator::generate(*this);
+    return *m_bytecode_executable;
+}
+
 Value Program::execute(Interpreter& interpreter, GlobalObject& global_object) const
 {
     InterpreterNodeScope node_scope { interpreter, *this };
@@ -181,6 +189,23 @@ CallExpression::ThisAndCallee CallExpression::compute_this_and_callee(Interprete
     return { &global_object, m_callee->execute(interpreter, global_object) };
 }
 
+void CallExpression::throw_type_error_for_callee(GlobalObject& global_object, Value callee) const
+{
+    auto& vm = global_object.vm();
+    auto call_type = is<NewExpression>(*this) ? "constructor" : "function";
+    if (is<Identifier>(*m_callee) || is<MemberExpression>(*m_callee)) {
+        String expression_string;
+        if (is<Identifier>(*m_callee)) {
+            expression_string = static_cast<const Identifier&>(*m_callee).string();
+        } else {
+            expression_string = static_cast<const MemberExpression&>(*m_callee).to_string_approximation();
+        }
+        vm.throw_exception<TypeError>(global_object, ErrorType::IsNotAEvaluatedFrom, callee.to_string_without_side_effects(), call_type, expression_string);
+    } else {
+        vm.throw_exception<TypeError>(global_object, ErrorType::IsNotA, callee.to_string_without_side_effects(), call_type);
+    }
+}
+
 Value CallExpression::execute(Interpreter& interpreter, GlobalObject& global_object) const
 {
     InterpreterNodeScope node_scope { interpreter, *this };
@@ -193,19 +218,7 @@ Value CallExpression::execute(Interpreter& interpreter, GlobalObject& global_obj
 
     if (!callee.is_function()
         || (is<NewExpression>(*this) && (is<NativeFunction>(callee.as_object()) && !static_cast<NativeFunction&>(callee.as_object()).has_constructor()))) {
-        String error_message;
-        auto call_type = is<NewExpression>(*this) ? "constructor" : "function";
-        if (is<Identifier>(*m_callee) || is<MemberExpression>(*m_callee)) {
-            String expression_string;
-            if (is<Identifier>(*m_callee)) {
-                expression_string = static_cast<const Identifier&>(*m_callee).string();
-            } else {
-                expression_string = static_cast<const MemberExpression&>(*m_callee).to_string_approximation();
-            }
-            vm.throw_exception<TypeError>(global_object, ErrorType::IsNotAEvaluatedFrom, callee.to_string_without_side_effects(), call_type, expression_string);
-        } else {
-            vm.throw_exception<TypeError>(global_object, ErrorType::IsNotA, callee.to_string_without_side_effects(), call_type);
-        }
+        throw_type_error_for_callee(global_object, callee);
         return {};
     }
 
@@ -670,6 +683,8 @@ Reference Expression::to_reference(Interpreter&, GlobalObject&) const
 
 Reference Identifier::to_reference(Interpreter& interpreter, GlobalObject&) const
 {
+    if (auto* environment = interpreter.vm().environment_for_binding(m_environment_coordinate, string()))
+        return { Reference::LocalVariable, *environment, m_environment_coordinate->index, string() };
     return interpreter.vm().get_reference(string());
 }
 
@@ -681,6 +696,8 @@ Reference MemberExpression::to_reference(Interpreter& interpreter, GlobalObject&
     auto property_name = computed_property_name(interpreter, global_object);
     if (!property_name.is_valid())
         return {};
+    if (!m_computed)
+        return { object_value, property_name, m_lookup_cache };
     return { object_value, property_name };
 }
 
@@ -1269,6 +1286,9 @@ Value Identifier::execute(Interpreter& interpreter, GlobalObject& global_object)
 {
     InterpreterNodeScope node_scope { interpreter, *this };
 
+    if (auto* environment = interpreter.vm().environment_for_binding(m_environment_coordinate, string()))
+        return environment->slot(m_environment_coordinate->index).value;
+
     auto value = interpreter.vm().get_variable(string(), global_object);
     if (value.is_empty()) {
         interpreter.vm().throw_exception<ReferenceError>(global_object, ErrorType::UnknownIdentifier, string());
@@ -1280,7 +1300,10 @@ Value Identifier::execute(Interpreter& interpreter, GlobalObject& global_object)
 void Identifier::dump(int indent) const
 {
     print_indent(indent);
-    outln("Identifier \"{}\"", m_string);
+    if (m_environment_coordinate.has_value())
+        outln("Identifier \"{}\" (hops: {}, index: {})", m_string, m_environment_coordinate->hops, m_environment_coordinate->index);
+    else
+        outln("Identifier \"{}\"", m_string);
 }
 
 void SpreadExpression::dump(int indent) const
@@ -1555,10 +1578,14 @@ Value VariableDeclaration::execute(Interpreter& interpreter, GlobalObject& globa
             auto initalizer_result = init->execute(interpreter, global_object);
             if (interpreter.exception())
                 return {};
-            auto variable_name = declarator.id().string();
+            auto& id = declarator.id();
+            auto variable_name = id.string();
             if (is<ClassExpression>(*init))
                 update_function_name(initalizer_result, variable_name);
-            interpreter.vm().set_variable(variable_name, initalizer_result, global_object, true);
+            if (auto* environment = interpreter.vm().environment_for_binding(id.environment_coordinate(), variable_name))
+                environment->set_slot_value(id.environment_coordinate()->index, initalizer_result);
+            else
+                interpreter.vm().set_variable(variable_name, initalizer_result, global_object, true);
         }
     }
     return {};
@@ -1982,9 +2009,8 @@ Value TryStatement::execute(Interpreter& interpreter, GlobalObject& global_objec
         if (m_handler) {
             interpreter.vm().clear_exception();
 
-            HashMap<FlyString, Variable> parameters;
-            parameters.set(m_handler->parameter(), Variable { exception->value(), DeclarationKind::Var });
-            auto* catch_scope = interpreter.heap().allocate<LexicalEnvironment>(global_object, move(parameters), interpreter.vm().call_frame().scope);
+            auto* catch_scope = interpreter.heap().allocate<LexicalEnvironment>(global_object, Vector<Binding> { { m_handler->parameter(), DeclarationKind::Var } }, interpreter.vm().call_frame().scope);
+            catch_scope->set_slot_value(0, exception->value());
             TemporaryChange<ScopeObject*> scope_change(interpreter.vm().call_frame().scope, catch_scope);
             result = interpreter.execute_statement(global_object, m_handler->body());
         }
@@ -2190,9 +2216,34 @@ Value DebuggerStatement::execute(Interpreter& interpreter, GlobalObject&) const
 
 void ScopeNode::add_variables(NonnullRefPtrVector<VariableDeclaration> variables)
 {
+    for (auto& declaration : variables) {
+        for (auto& declarator : declaration.declarations())
+            add_binding(declarator.id().string(), declaration.declaration_kind());
+    }
     m_variables.append(move(variables));
 }
 
+void ScopeNode::add_binding(const FlyString& name, DeclarationKind declaration_kind)
+{
+    // A redeclared name keeps its slot, but takes on the kind of the latest declaration.
+    for (auto& binding : m_bindings) {
+        if (binding.name == name) {
+            binding.declaration_kind = declaration_kind;
+            return;
+        }
+    }
+    m_bindings.append({ name, declaration_kind });
+}
+
+void ScopeNode::add_parameter_bindings(const Vector<FlyString>& names)
+{
+    auto body_bindings = move(m_bindings);
+    for (auto& name : names)
+        add_binding(name, DeclarationKind::Var);
+    for (auto& binding : body_bindings)
+        add_binding(binding.name, binding.declaration_kind);
+}
+
 void ScopeNode::add_functions(NonnullRefPtrVector<FunctionDeclaration> functions)
 {
     m_functions.append(move(functions));
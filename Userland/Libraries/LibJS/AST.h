@@ -30,11 +30,17 @@
 #include <AK/FlyString.h>
 #include <AK/HashMap.h>
 #include <AK/NonnullRefPtrVector.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
 #include <AK/String.h>
 #include <AK/Vector.h>
+#include <LibJS/Bytecode/Executable.h>
+#include <LibJS/Bytecode/Register.h>
 #include <LibJS/Forward.h>
+#include <LibJS/Runtime/PropertyLookupCache.h>
 #include <LibJS/Runtime/PropertyName.h>
+#include <LibJS/Runtime/ScopeObject.h>
 #include <LibJS/Runtime/Value.h>
 #include <LibJS/SourceRange.h>
 
@@ -54,6 +60,8 @@ class ASTNode : public RefCounted<ASTNode> {
 public:
     virtual ~ASTNode() { }
     virtual Value execute(Interpreter&, GlobalObject&) const = 0;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const;
+    virtual void analyze_scope(ScopeAnalysis&) const;
     virtual void dump(int indent) const;
 
     const SourceRange& source_range() const { return m_source_range; }
@@ -81,6 +89,8 @@ public:
     const FlyString& label() const { return m_label; }
     void set_label(FlyString string) { m_label = string; }
 
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+
 protected:
     FlyString m_label;
 };
@@ -92,6 +102,7 @@ public:
     {
     }
     Value execute(Interpreter&, GlobalObject&) const override { return {}; }
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
 };
 
 class ErrorStatement final : public Statement {
@@ -112,6 +123,8 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
     const Expression& expression() const { return m_expression; };
@@ -136,13 +149,22 @@ public:
 
     const NonnullRefPtrVector<Statement>& children() const { return m_children; }
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
     void add_variables(NonnullRefPtrVector<VariableDeclaration>);
     void add_functions(NonnullRefPtrVector<FunctionDeclaration>);
+    void add_parameter_bindings(const Vector<FlyString>& names);
     const NonnullRefPtrVector<VariableDeclaration>& variables() const { return m_variables; }
     const NonnullRefPtrVector<FunctionDeclaration>& functions() const { return m_functions; }
 
+    // The slots of the environment created for this scope, one per declared name.
+    // For a function body, this is the function's environment and starts with its parameters.
+    const Vector<Binding>& bindings() const { return m_bindings; }
+
+    bool has_bytecode_executable() const { return m_bytecode_executable; }
+    const Bytecode::Executable& bytecode_executable() const;
+
 protected:
     ScopeNode(SourceRange source_range)
         : Statement(move(source_range))
@@ -150,9 +172,13 @@ protected:
     }
 
 private:
+    void add_binding(const FlyString& name, DeclarationKind);
+
     NonnullRefPtrVector<Statement> m_children;
     NonnullRefPtrVector<VariableDeclaration> m_variables;
     NonnullRefPtrVector<FunctionDeclaration> m_functions;
+    Vector<Binding> m_bindings;
+    mutable OwnPtr<Bytecode::Executable> m_bytecode_executable;
 };
 
 class Program final : public ScopeNode {
@@ -177,6 +203,8 @@ public:
         : ScopeNode(move(source_range))
     {
     }
+
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
 };
 
 class Expression : public ASTNode {
@@ -186,6 +214,7 @@ public:
     {
     }
     virtual Reference to_reference(Interpreter&, GlobalObject&) const;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
 };
 
 class Declaration : public Statement {
@@ -228,9 +257,16 @@ protected:
         , m_function_length(function_length)
         , m_is_strict_mode(is_strict_mode)
     {
+        if (is<ScopeNode>(*m_body)) {
+            Vector<FlyString> parameter_names;
+            for (auto& parameter : m_parameters)
+                parameter_names.append(parameter.name);
+            static_cast<ScopeNode&>(*m_body).add_parameter_bindings(parameter_names);
+        }
     }
 
     void dump(int indent, const String& class_name) const;
+    void analyze_function_scope(ScopeAnalysis&, bool is_hoisted) const;
 
     const NonnullRefPtrVector<VariableDeclaration>& variables() const { return m_variables; }
 
@@ -263,6 +299,8 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 };
 
@@ -280,6 +318,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
     void set_name_if_possible(FlyString new_name)
@@ -319,6 +358,8 @@ public:
     const Expression* argument() const { return m_argument; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -340,6 +381,8 @@ public:
     const Statement* alternate() const { return m_alternate; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -361,6 +404,8 @@ public:
     const Statement& body() const { return *m_body; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -381,6 +426,8 @@ public:
     const Statement& body() const { return *m_body; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -401,6 +448,7 @@ public:
     const Statement& body() const { return *m_body; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -425,6 +473,8 @@ public:
     const Statement& body() const { return *m_body; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -449,6 +499,7 @@ public:
     const Statement& body() const { return *m_body; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -472,6 +523,7 @@ public:
     const Statement& body() const { return *m_body; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -516,6 +568,8 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -541,6 +595,8 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -569,6 +625,8 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -587,6 +645,8 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
 
 private:
     NonnullRefPtrVector<Expression> m_expressions;
@@ -609,6 +669,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -624,6 +685,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -639,6 +701,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -655,6 +718,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 
     StringView value() const { return m_value; }
@@ -673,6 +737,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 };
 
@@ -706,12 +771,20 @@ public:
 
     const FlyString& string() const { return m_string; }
 
+    // Set by ScopeAnalysis if this name is known to live in an enclosing function or block environment.
+    const Optional<EnvironmentCoordinate>& environment_coordinate() const { return m_environment_coordinate; }
+
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
     virtual Reference to_reference(Interpreter&, GlobalObject&) const override;
 
 private:
+    friend class ScopeAnalysis;
+
     FlyString m_string;
+    mutable Optional<EnvironmentCoordinate> m_environment_coordinate;
 };
 
 class ClassMethod final : public ASTNode {
@@ -736,6 +809,7 @@ public:
     bool is_static() const { return m_is_static; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -770,6 +844,7 @@ public:
     StringView name() const { return m_name; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -788,6 +863,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -803,6 +879,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -816,6 +893,7 @@ public:
     {
     }
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
     virtual void dump(int indent) const override;
 };
 
@@ -834,8 +912,12 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
+    void throw_type_error_for_callee(GlobalObject&, Value callee) const;
+
 private:
     struct ThisAndCallee {
         Value this_value;
@@ -885,6 +967,8 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -909,6 +993,8 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -942,6 +1028,7 @@ public:
     const Expression* init() const { return m_init; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -961,6 +1048,8 @@ public:
     DeclarationKind declaration_kind() const { return m_declaration_kind; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
     const NonnullRefPtrVector<VariableDeclarator>& declarations() const { return m_declarations; }
@@ -1000,6 +1089,7 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
 
 private:
     NonnullRefPtr<Expression> m_key;
@@ -1017,6 +1107,8 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -1034,6 +1126,8 @@ public:
     const Vector<RefPtr<Expression>>& elements() const { return m_elements; }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -1056,6 +1150,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
     const NonnullRefPtrVector<Expression>& expressions() const { return m_expressions; }
@@ -1076,6 +1171,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
 
 private:
@@ -1094,6 +1190,8 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
     virtual void dump(int indent) const override;
     virtual Reference to_reference(Interpreter&, GlobalObject&) const override;
 
@@ -1109,6 +1207,9 @@ private:
     NonnullRefPtr<Expression> m_object;
     NonnullRefPtr<Expression> m_property;
     bool m_computed { false };
+
+    // Shared by every get and put that goes through this node, including assignments to it.
+    mutable PropertyLookupCache m_lookup_cache;
 };
 
 class MetaProperty final : public Expression {
@@ -1143,6 +1244,8 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
 
 private:
     NonnullRefPtr<Expression> m_test;
@@ -1164,6 +1267,7 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
 
 private:
     FlyString m_parameter;
@@ -1186,6 +1290,7 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
 
 private:
     NonnullRefPtr<BlockStatement> m_block;
@@ -1205,6 +1310,8 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
 
 private:
     NonnullRefPtr<Expression> m_argument;
@@ -1224,6 +1331,7 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
 
 private:
     RefPtr<Expression> m_test;
@@ -1241,6 +1349,7 @@ public:
 
     virtual void dump(int indent) const override;
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual void analyze_scope(ScopeAnalysis&) const override;
 
 private:
     NonnullRefPtr<Expression> m_discriminant;
@@ -1256,6 +1365,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
 
     const FlyString& target_label() const { return m_target_label; }
 
@@ -1272,6 +1382,7 @@ public:
     }
 
     virtual Value execute(Interpreter&, GlobalObject&) const override;
+    virtual Optional<Bytecode::Register> generate_bytecode(Bytecode::Generator&) const override;
 
     const FlyString& target_label() const { return m_target_label; }
 
@@ -0,0 +1,663 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibCrypto/BigInt/SignedBigInteger.h>
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Op.h>
+
+namespace JS {
+
+Optional<Bytecode::Register> ASTNode::generate_bytecode(Bytecode::Generator&) const
+{
+    // Only statements and expressions end up in bytecode, and they take care of themselves.
+    VERIFY_NOT_REACHED();
+}
+
+Optional<Bytecode::Register> Statement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    generator.emit_fallback(*this);
+    return {};
+}
+
+Optional<Bytecode::Register> Expression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    return generator.emit_fallback(*this);
+}
+
+Optional<Bytecode::Register> EmptyStatement::generate_bytecode(Bytecode::Generator&) const
+{
+    return {};
+}
+
+Optional<Bytecode::Register> ExpressionStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto value = generator.emit_expression(m_expression);
+    if (auto& completion = generator.completion_register(); completion.has_value())
+        generator.emit<Bytecode::Op::Move>(completion.value(), value);
+    return {};
+}
+
+Optional<Bytecode::Register> BlockStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    // Loop bodies are mostly blocks without declarations, and those don't need a scope of their own.
+    bool needs_scope = !variables().is_empty() || !functions().is_empty();
+    if (needs_scope)
+        generator.enter_scope(*this);
+    for (auto& child : children())
+        generator.emit_statement(child);
+    if (needs_scope)
+        generator.exit_scope(*this);
+    return {};
+}
+
+Optional<Bytecode::Register> FunctionDeclaration::generate_bytecode(Bytecode::Generator&) const
+{
+    // Function declarations are hoisted when their scope is entered.
+    return {};
+}
+
+Optional<Bytecode::Register> VariableDeclaration::generate_bytecode(Bytecode::Generator& generator) const
+{
+    for (auto& declarator : m_declarations) {
+        // Anonymous classes pick up the variable name, which is left to the AST interpreter.
+        if (declarator.init() && is<ClassExpression>(*declarator.init())) {
+            generator.emit_fallback(*this);
+            return {};
+        }
+    }
+
+    for (auto& declarator : m_declarations) {
+        if (auto* init = declarator.init()) {
+            auto value = generator.emit_expression(*init);
+            generator.emit<Bytecode::Op::InitializeVariable>(declarator.id().string(), value, declarator.id().environment_coordinate());
+        }
+    }
+    return {};
+}
+
+static void reset_completion(Bytecode::Generator& generator)
+{
+    if (auto& completion = generator.completion_register(); completion.has_value())
+        generator.emit<Bytecode::Op::Load>(completion.value(), js_undefined());
+}
+
+Optional<Bytecode::Register> IfStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto else_label = generator.make_label();
+    auto end_label = generator.make_label();
+
+    reset_completion(generator);
+    auto predicate = generator.emit_expression(m_predicate);
+    generator.emit<Bytecode::Op::JumpIfFalse>(predicate, else_label);
+    generator.emit_statement(m_consequent);
+    generator.emit<Bytecode::Op::Jump>(end_label);
+    generator.link(else_label);
+    if (m_alternate)
+        generator.emit_statement(*m_alternate);
+    generator.link(end_label);
+    return {};
+}
+
+Optional<Bytecode::Register> WhileStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto test_label = generator.make_label();
+    auto end_label = generator.make_label();
+
+    reset_completion(generator);
+    generator.link(test_label);
+    auto test = generator.emit_expression(m_test);
+    generator.emit<Bytecode::Op::JumpIfFalse>(test, end_label);
+    generator.begin_loop(end_label, test_label);
+    generator.emit_statement(m_body);
+    generator.end_loop();
+    generator.emit<Bytecode::Op::Jump>(test_label);
+    generator.link(end_label);
+    return {};
+}
+
+Optional<Bytecode::Register> DoWhileStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto body_label = generator.make_label();
+    auto test_label = generator.make_label();
+    auto end_label = generator.make_label();
+
+    reset_completion(generator);
+    generator.link(body_label);
+    generator.begin_loop(end_label, test_label);
+    generator.emit_statement(m_body);
+    generator.end_loop();
+    generator.link(test_label);
+    auto test = generator.emit_expression(m_test);
+    generator.emit<Bytecode::Op::JumpIfTrue>(test, body_label);
+    generator.link(end_label);
+    return {};
+}
+
+Optional<Bytecode::Register> ForStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto test_label = generator.make_label();
+    auto update_label = generator.make_label();
+    auto end_label = generator.make_label();
+
+    // Like the AST interpreter, we give let and const declarations in the head a block of their own.
+    RefPtr<BlockStatement> wrapper;
+    if (m_init && is<VariableDeclaration>(*m_init) && static_cast<const VariableDeclaration&>(*m_init).declaration_kind() != DeclarationKind::Var) {
+        wrapper = create_ast_node<BlockStatement>(source_range());
+        NonnullRefPtrVector<VariableDeclaration> declarations;
+        declarations.append(static_cast<const VariableDeclaration&>(*m_init));
+        wrapper->add_variables(declarations);
+        generator.keep_alive(*wrapper);
+        generator.enter_scope(*wrapper);
+    }
+
+    reset_completion(generator);
+    if (m_init) {
+        if (is<Expression>(*m_init))
+            generator.emit_expression(static_cast<const Expression&>(*m_init));
+        else
+            generator.emit_statement(static_cast<const Statement&>(*m_init));
+    }
+
+    generator.link(test_label);
+    if (m_test) {
+        auto test = generator.emit_expression(*m_test);
+        generator.emit<Bytecode::Op::JumpIfFalse>(test, end_label);
+    }
+    generator.begin_loop(end_label, update_label);
+    generator.emit_statement(m_body);
+    generator.end_loop();
+    generator.link(update_label);
+    if (m_update)
+        generator.emit_expression(*m_update);
+    generator.emit<Bytecode::Op::Jump>(test_label);
+    generator.link(end_label);
+
+    if (wrapper)
+        generator.exit_scope(*wrapper);
+    return {};
+}
+
+Optional<Bytecode::Register> ReturnStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    Optional<Bytecode::Register> argument;
+    if (m_argument)
+        argument = generator.emit_expression(*m_argument);
+    generator.emit<Bytecode::Op::Return>(argument);
+    return {};
+}
+
+Optional<Bytecode::Register> ThrowStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto argument = generator.emit_expression(m_argument);
+    generator.emit<Bytecode::Op::Throw>(argument);
+    return {};
+}
+
+Optional<Bytecode::Register> BreakStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (!m_target_label.is_null() || !generator.is_in_loop())
+        return Statement::generate_bytecode(generator);
+    generator.emit_break();
+    return {};
+}
+
+Optional<Bytecode::Register> ContinueStatement::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (!m_target_label.is_null() || !generator.is_in_loop())
+        return Statement::generate_bytecode(generator);
+    generator.emit_continue();
+    return {};
+}
+
+Optional<Bytecode::Register> NumericLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::Load>(dst, m_value);
+    return dst;
+}
+
+Optional<Bytecode::Register> BooleanLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::Load>(dst, Value(m_value));
+    return dst;
+}
+
+Optional<Bytecode::Register> NullLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::Load>(dst, js_null());
+    return dst;
+}
+
+Optional<Bytecode::Register> StringLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::NewString>(dst, m_value);
+    return dst;
+}
+
+Optional<Bytecode::Register> BigIntLiteral::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::NewBigInt>(dst, Crypto::SignedBigInteger::from_base10(m_value.substring(0, m_value.length() - 1)));
+    return dst;
+}
+
+Optional<Bytecode::Register> Identifier::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::GetVariable>(dst, m_string, m_environment_coordinate);
+    return dst;
+}
+
+Optional<Bytecode::Register> ThisExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::ResolveThisBinding>(dst);
+    return dst;
+}
+
+static void emit_binary_op(Bytecode::Generator& generator, BinaryOp op, Bytecode::Register dst, Bytecode::Register lhs, Bytecode::Register rhs)
+{
+    switch (op) {
+    case BinaryOp::Addition:
+        generator.emit<Bytecode::Op::Add>(dst, lhs, rhs);
+        return;
+    case BinaryOp::Subtraction:
+        generator.emit<Bytecode::Op::Sub>(dst, lhs, rhs);
+        return;
+    case BinaryOp::Multiplication:
+        generator.emit<Bytecode::Op::Mul>(dst, lhs, rhs);
+        return;
+    case BinaryOp::Division:
+        generator.emit<Bytecode::Op::Div>(dst, lhs, rhs);
+        return;
+    case BinaryOp::Modulo:
+        generator.emit<Bytecode::Op::Mod>(dst, lhs, rhs);
+        return;
+    case BinaryOp::Exponentiation:
+        generator.emit<Bytecode::Op::Exp>(dst, lhs, rhs);
+        return;
+    case BinaryOp::TypedEquals:
+        generator.emit<Bytecode::Op::TypedEquals>(dst, lhs, rhs);
+        return;
+    case BinaryOp::TypedInequals:
+        generator.emit<Bytecode::Op::TypedInequals>(dst, lhs, rhs);
+        return;
+    case BinaryOp::AbstractEquals:
+        generator.emit<Bytecode::Op::AbstractEquals>(dst, lhs, rhs);
+        return;
+    case BinaryOp::AbstractInequals:
+        generator.emit<Bytecode::Op::AbstractInequals>(dst, lhs, rhs);
+        return;
+    case BinaryOp::GreaterThan:
+        generator.emit<Bytecode::Op::GreaterThan>(dst, lhs, rhs);
+        return;
+    case BinaryOp::GreaterThanEquals:
+        generator.emit<Bytecode::Op::GreaterThanEquals>(dst, lhs, rhs);
+        return;
+    case BinaryOp::LessThan:
+        generator.emit<Bytecode::Op::LessThan>(dst, lhs, rhs);
+        return;
+    case BinaryOp::LessThanEquals:
+        generator.emit<Bytecode::Op::LessThanEquals>(dst, lhs, rhs);
+        return;
+    case BinaryOp::BitwiseAnd:
+        generator.emit<Bytecode::Op::BitwiseAnd>(dst, lhs, rhs);
+        return;
+    case BinaryOp::BitwiseOr:
+        generator.emit<Bytecode::Op::BitwiseOr>(dst, lhs, rhs);
+        return;
+    case BinaryOp::BitwiseXor:
+        generator.emit<Bytecode::Op::BitwiseXor>(dst, lhs, rhs);
+        return;
+    case BinaryOp::LeftShift:
+        generator.emit<Bytecode::Op::LeftShift>(dst, lhs, rhs);
+        return;
+    case BinaryOp::RightShift:
+        generator.emit<Bytecode::Op::RightShift>(dst, lhs, rhs);
+        return;
+    case BinaryOp::UnsignedRightShift:
+        generator.emit<Bytecode::Op::UnsignedRightShift>(dst, lhs, rhs);
+        return;
+    case BinaryOp::In:
+        generator.emit<Bytecode::Op::In>(dst, lhs, rhs);
+        return;
+    case BinaryOp::InstanceOf:
+        generator.emit<Bytecode::Op::InstanceOf>(dst, lhs, rhs);
+        return;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+Optional<Bytecode::Register> BinaryExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto lhs = generator.emit_expression(m_lhs);
+    auto rhs = generator.emit_expression(m_rhs);
+    auto dst = generator.allocate_register();
+    emit_binary_op(generator, m_op, dst, lhs, rhs);
+    return dst;
+}
+
+Optional<Bytecode::Register> LogicalExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto end_label = generator.make_label();
+    auto dst = generator.allocate_register();
+
+    auto lhs = generator.emit_expression(m_lhs);
+    generator.emit<Bytecode::Op::Move>(dst, lhs);
+    switch (m_op) {
+    case LogicalOp::And:
+        generator.emit<Bytecode::Op::JumpIfFalse>(dst, end_label);
+        break;
+    case LogicalOp::Or:
+        generator.emit<Bytecode::Op::JumpIfTrue>(dst, end_label);
+        break;
+    case LogicalOp::NullishCoalescing:
+        generator.emit<Bytecode::Op::JumpIfNotNullish>(dst, end_label);
+        break;
+    }
+    auto rhs = generator.emit_expression(m_rhs);
+    generator.emit<Bytecode::Op::Move>(dst, rhs);
+    generator.link(end_label);
+    return dst;
+}
+
+Optional<Bytecode::Register> UnaryExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    // delete needs a reference, and typeof must not throw for undeclared identifiers.
+    if (m_op == UnaryOp::Delete || (m_op == UnaryOp::Typeof && is<Identifier>(*m_lhs)))
+        return Expression::generate_bytecode(generator);
+
+    auto src = generator.emit_expression(m_lhs);
+    auto dst = generator.allocate_register();
+    switch (m_op) {
+    case UnaryOp::BitwiseNot:
+        generator.emit<Bytecode::Op::BitwiseNot>(dst, src);
+        break;
+    case UnaryOp::Not:
+        generator.emit<Bytecode::Op::Not>(dst, src);
+        break;
+    case UnaryOp::Plus:
+        generator.emit<Bytecode::Op::UnaryPlus>(dst, src);
+        break;
+    case UnaryOp::Minus:
+        generator.emit<Bytecode::Op::UnaryMinus>(dst, src);
+        break;
+    case UnaryOp::Typeof:
+        generator.emit<Bytecode::Op::Typeof>(dst, src);
+        break;
+    case UnaryOp::Void:
+        generator.emit<Bytecode::Op::Load>(dst, js_undefined());
+        break;
+    case UnaryOp::Delete:
+        VERIFY_NOT_REACHED();
+    }
+    return dst;
+}
+
+Optional<Bytecode::Register> SequenceExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    Optional<Bytecode::Register> last_value;
+    for (auto& expression : m_expressions)
+        last_value = generator.emit_expression(expression);
+    return last_value;
+}
+
+Optional<Bytecode::Register> ConditionalExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    auto alternate_label = generator.make_label();
+    auto end_label = generator.make_label();
+    auto dst = generator.allocate_register();
+
+    auto test = generator.emit_expression(m_test);
+    generator.emit<Bytecode::Op::JumpIfFalse>(test, alternate_label);
+    auto consequent = generator.emit_expression(m_consequent);
+    generator.emit<Bytecode::Op::Move>(dst, consequent);
+    generator.emit<Bytecode::Op::Jump>(end_label);
+    generator.link(alternate_label);
+    auto alternate = generator.emit_expression(m_alternate);
+    generator.emit<Bytecode::Op::Move>(dst, alternate);
+    generator.link(end_label);
+    return dst;
+}
+
+Optional<Bytecode::Register> ObjectExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (!m_properties.is_empty())
+        return Expression::generate_bytecode(generator);
+
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::NewObject>(dst);
+    return dst;
+}
+
+Optional<Bytecode::Register> ArrayExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    for (auto& element : m_elements) {
+        if (!element || is<SpreadExpression>(*element))
+            return Expression::generate_bytecode(generator);
+    }
+
+    Vector<Bytecode::Register> elements;
+    elements.ensure_capacity(m_elements.size());
+    for (auto& element : m_elements)
+        elements.append(generator.emit_expression(*element));
+
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::NewArray>(dst, move(elements));
+    return dst;
+}
+
+Optional<Bytecode::Register> MemberExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (is<SuperExpression>(*m_object))
+        return Expression::generate_bytecode(generator);
+
+    auto object = generator.emit_expression(m_object);
+    auto dst = generator.allocate_register();
+    if (m_computed) {
+        auto property = generator.emit_expression(m_property);
+        generator.emit<Bytecode::Op::GetByValue>(dst, object, property);
+    } else {
+        generator.emit<Bytecode::Op::GetById>(dst, object, static_cast<const Identifier&>(*m_property).string());
+    }
+    return dst;
+}
+
+// Assignment targets that we know how to read and write from bytecode.
+static bool is_simple_assignment_target(const Expression& expression)
+{
+    if (is<Identifier>(expression))
+        return true;
+    return is<MemberExpression>(expression) && !is<SuperExpression>(static_cast<const MemberExpression&>(expression).object());
+}
+
+// The base and key of a member expression, evaluated once so a compound assignment can both read and write through them.
+struct AssignmentTarget {
+    Optional<Bytecode::Register> object;
+    Optional<Bytecode::Register> property;
+};
+
+static AssignmentTarget emit_assignment_target(Bytecode::Generator& generator, const Expression& expression)
+{
+    if (is<Identifier>(expression))
+        return {};
+    auto& member_expression = static_cast<const MemberExpression&>(expression);
+    AssignmentTarget target;
+    target.object = generator.emit_expression(member_expression.object());
+    if (member_expression.is_computed())
+        target.property = generator.emit_expression(member_expression.property());
+    return target;
+}
+
+static void emit_load_from_target(Bytecode::Generator& generator, const Expression& expression, const AssignmentTarget& target, Bytecode::Register dst)
+{
+    if (is<Identifier>(expression)) {
+        auto& identifier = static_cast<const Identifier&>(expression);
+        generator.emit<Bytecode::Op::GetVariable>(dst, identifier.string(), identifier.environment_coordinate());
+        return;
+    }
+    auto& member_expression = static_cast<const MemberExpression&>(expression);
+    if (target.property.has_value())
+        generator.emit<Bytecode::Op::GetByValue>(dst, target.object.value(), target.property.value());
+    else
+        generator.emit<Bytecode::Op::GetById>(dst, target.object.value(), static_cast<const Identifier&>(member_expression.property()).string());
+}
+
+static void emit_store_to_target(Bytecode::Generator& generator, const Expression& expression, const AssignmentTarget& target, Bytecode::Register src)
+{
+    if (is<Identifier>(expression)) {
+        auto& identifier = static_cast<const Identifier&>(expression);
+        generator.emit<Bytecode::Op::SetVariable>(identifier.string(), src, identifier.environment_coordinate());
+        return;
+    }
+    auto& member_expression = static_cast<const MemberExpression&>(expression);
+    if (target.property.has_value())
+        generator.emit<Bytecode::Op::PutByValue>(target.object.value(), target.property.value(), src);
+    else
+        generator.emit<Bytecode::Op::PutById>(target.object.value(), static_cast<const Identifier&>(member_expression.property()).string(), src);
+}
+
+Optional<Bytecode::Register> AssignmentExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (!is_simple_assignment_target(m_lhs))
+        return Expression::generate_bytecode(generator);
+
+    Optional<BinaryOp> binary_op;
+    switch (m_op) {
+    case AssignmentOp::Assignment:
+        break;
+    case AssignmentOp::AdditionAssignment:
+        binary_op = BinaryOp::Addition;
+        break;
+    case AssignmentOp::SubtractionAssignment:
+        binary_op = BinaryOp::Subtraction;
+        break;
+    case AssignmentOp::MultiplicationAssignment:
+        binary_op = BinaryOp::Multiplication;
+        break;
+    case AssignmentOp::DivisionAssignment:
+        binary_op = BinaryOp::Division;
+        break;
+    case AssignmentOp::ModuloAssignment:
+        binary_op = BinaryOp::Modulo;
+        break;
+    case AssignmentOp::ExponentiationAssignment:
+        binary_op = BinaryOp::Exponentiation;
+        break;
+    case AssignmentOp::BitwiseAndAssignment:
+        binary_op = BinaryOp::BitwiseAnd;
+        break;
+    case AssignmentOp::BitwiseOrAssignment:
+        binary_op = BinaryOp::BitwiseOr;
+        break;
+    case AssignmentOp::BitwiseXorAssignment:
+        binary_op = BinaryOp::BitwiseXor;
+        break;
+    case AssignmentOp::LeftShiftAssignment:
+        binary_op = BinaryOp::LeftShift;
+        break;
+    case AssignmentOp::RightShiftAssignment:
+        binary_op = BinaryOp::RightShift;
+        break;
+    case AssignmentOp::UnsignedRightShiftAssignment:
+        binary_op = BinaryOp::UnsignedRightShift;
+        break;
+    case AssignmentOp::AndAssignment:
+    case AssignmentOp::OrAssignment:
+    case AssignmentOp::NullishAssignment:
+        return Expression::generate_bytecode(generator);
+    }
+
+    auto target = emit_assignment_target(generator, m_lhs);
+    auto value = generator.allocate_register();
+    if (binary_op.has_value()) {
+        auto old_value = generator.allocate_register();
+        emit_load_from_target(generator, m_lhs, target, old_value);
+        auto rhs = generator.emit_expression(m_rhs);
+        emit_binary_op(generator, binary_op.value(), value, old_value, rhs);
+    } else {
+        auto rhs = generator.emit_expression(m_rhs);
+        generator.emit<Bytecode::Op::Move>(value, rhs);
+    }
+    emit_store_to_target(generator, m_lhs, target, value);
+    return value;
+}
+
+Optional<Bytecode::Register> UpdateExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (!is_simple_assignment_target(m_argument))
+        return Expression::generate_bytecode(generator);
+
+    auto target = emit_assignment_target(generator, m_argument);
+    auto old_value = generator.allocate_register();
+    emit_load_from_target(generator, m_argument, target, old_value);
+    generator.emit<Bytecode::Op::ToNumeric>(old_value, old_value);
+
+    auto new_value = generator.allocate_register();
+    if (m_op == UpdateOp::Increment)
+        generator.emit<Bytecode::Op::Increment>(new_value, old_value);
+    else
+        generator.emit<Bytecode::Op::Decrement>(new_value, old_value);
+    emit_store_to_target(generator, m_argument, target, new_value);
+    return m_prefixed ? new_value : old_value;
+}
+
+Optional<Bytecode::Register> CallExpression::generate_bytecode(Bytecode::Generator& generator) const
+{
+    if (is<NewExpression>(*this) || is<SuperExpression>(*m_callee))
+        return Expression::generate_bytecode(generator);
+    for (auto& argument : m_arguments) {
+        if (argument.is_spread)
+            return Expression::generate_bytecode(generator);
+    }
+    if (is<MemberExpression>(*m_callee) && !is_simple_assignment_target(m_callee))
+        return Expression::generate_bytecode(generator);
+
+    // Method calls get the object they were looked up on as this, everything else gets the global object.
+    Optional<Bytecode::Register> this_value;
+    auto callee = is<MemberExpression>(*m_callee) ? generator.allocate_register() : generator.emit_expression(m_callee);
+    if (is<MemberExpression>(*m_callee)) {
+        auto target = emit_assignment_target(generator, m_callee);
+        emit_load_from_target(generator, m_callee, target, callee);
+        this_value = generator.allocate_register();
+        generator.emit<Bytecode::Op::ToObject>(this_value.value(), target.object.value());
+    }
+
+    Vector<Bytecode::Register> arguments;
+    arguments.ensure_capacity(m_arguments.size());
+    for (auto& argument : m_arguments)
+        arguments.append(generator.emit_expression(argument.value));
+
+    auto dst = generator.allocate_register();
+    generator.emit<Bytecode::Op::Call>(dst, callee, this_value, move(arguments), *this);
+    return dst;
+}
+
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::Bytecode {
+
+Generator::Generator()
+    : m_executable(make<Executable>())
+{
+}
+
+NonnullOwnPtr<Executable> Generator::generate(const ScopeNode& scope_node)
+{
+    Generator generator;
+
+    // The scope itself is entered by whoever runs the executable, so we only generate its children.
+    if (is<Program>(scope_node)) {
+        auto completion = generator.allocate_register();
+        generator.m_executable->completion_register = completion;
+    }
+    for (auto& child : scope_node.children())
+        generator.emit_statement(child);
+
+    VERIFY(generator.m_scopes.is_empty());
+    VERIFY(generator.m_loops.is_empty());
+    return move(generator.m_executable);
+}
+
+Register Generator::allocate_register()
+{
+    return Register(m_executable->register_count++);
+}
+
+Label Generator::make_label()
+{
+    // Labels start out unbound, which we mark with an address no instruction can have.
+    m_executable->label_addresses.append(NumericLimits<size_t>::max());
+    return Label(m_executable->label_addresses.size() - 1);
+}
+
+void Generator::link(Label label)
+{
+    VERIFY(m_executable->label_addresses[label.id()] == NumericLimits<size_t>::max());
+    m_executable->label_addresses[label.id()] = m_executable->instructions.size();
+}
+
+Register Generator::emit_expression(const Expression& expression)
+{
+    auto result = expression.generate_bytecode(*this);
+    VERIFY(result.has_value());
+    return result.value();
+}
+
+void Generator::emit_statement(const Statement& statement)
+{
+    // Labelled statements are rare enough that we let the AST interpreter deal with the extra bookkeeping.
+    if (!statement.label().is_null()) {
+        emit_fallback(statement);
+        return;
+    }
+    (void)statement.generate_bytecode(*this);
+}
+
+Register Generator::emit_fallback(const Expression& expression)
+{
+    auto dst = allocate_register();
+    emit<Op::EvaluateExpression>(dst, expression);
+    return dst;
+}
+
+void Generator::emit_fallback(const Statement& statement)
+{
+    Optional<Op::EvaluateStatement::LoopTargets> loop_targets;
+    if (!m_loops.is_empty()) {
+        auto& loop = m_loops.last();
+        loop_targets = Op::EvaluateStatement::LoopTargets { loop.break_target, loop.continue_target, loop.scope_depth };
+    }
+    emit<Op::EvaluateStatement>(statement, completion_register(), loop_targets);
+}
+
+void Generator::enter_scope(const ScopeNode& scope_node)
+{
+    emit<Op::EnterScope>(scope_node);
+    m_scopes.append(&scope_node);
+}
+
+void Generator::exit_scope(const ScopeNode& scope_node)
+{
+    VERIFY(!m_scopes.is_empty() && m_scopes.last() == &scope_node);
+    m_scopes.take_last();
+    emit<Op::ExitScope>(scope_node);
+}
+
+void Generator::keep_alive(NonnullRefPtr<ScopeNode> scope_node)
+{
+    m_executable->synthesized_scopes.append(move(scope_node));
+}
+
+void Generator::begin_loop(Label break_target, Label continue_target)
+{
+    m_loops.append({ break_target, continue_target, m_scopes.size() });
+}
+
+void Generator::end_loop()
+{
+    m_loops.take_last();
+}
+
+void Generator::emit_exit_scopes_until(size_t depth)
+{
+    // This is for jumps out of scopes, so the scopes stay open for the code that follows.
+    for (size_t i = m_scopes.size(); i > depth; --i)
+        emit<Op::ExitScope>(*m_scopes[i - 1]);
+}
+
+void Generator::emit_break()
+{
+    auto& loop = m_loops.last();
+    emit_exit_scopes_until(loop.scope_depth);
+    emit<Op::Jump>(loop.break_target);
+}
+
+void Generator::emit_continue()
+{
+    auto& loop = m_loops.last();
+    emit_exit_scopes_until(loop.scope_depth);
+    emit<Op::Jump>(loop.continue_target);
+}
+
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibJS/Bytecode/Executable.h>
+#include <LibJS/Bytecode/Label.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Bytecode/Register.h>
+#include <LibJS/Forward.h>
+
+namespace JS::Bytecode {
+
+// Walks the AST of one function body or program and turns it into an Executable.
+// Nodes without a generate_bytecode() of their own are left to the AST interpreter.
+class Generator {
+public:
+    static NonnullOwnPtr<Executable> generate(const ScopeNode&);
+
+    Register allocate_register();
+    Label make_label();
+    void link(Label);
+
+    template<typename OpType, typename... Args>
+    void emit(Args&&... args)
+    {
+        m_executable->instructions.append(make<OpType>(forward<Args>(args)...));
+    }
+
+    Register emit_expression(const Expression&);
+    void emit_statement(const Statement&);
+
+    // Hands a node to the AST interpreter. This is mainly used for for-in/for-of, switch, try, with,
+    // labelled statements, classes, function expressions, new, template literals, regexps, super,
+    // spread and non-empty object literals.
+    Register emit_fallback(const Expression&);
+    void emit_fallback(const Statement&);
+
+    void enter_scope(const ScopeNode&);
+    void exit_scope(const ScopeNode&);
+    void keep_alive(NonnullRefPtr<ScopeNode>);
+
+    void begin_loop(Label break_target, Label continue_target);
+    void end_loop();
+    bool is_in_loop() const { return !m_loops.is_empty(); }
+    void emit_break();
+    void emit_continue();
+
+    const Optional<Register>& completion_register() const { return m_executable->completion_register; }
+
+private:
+    Generator();
+
+    struct Loop {
+        Label break_target;
+        Label continue_target;
+        size_t scope_depth { 0 };
+    };
+
+    void emit_exit_scopes_until(size_t depth);
+
+    NonnullOwnPtr<Executable> m_executable;
+    Vector<const ScopeNode*> m_scopes;
+    Vector<Loop> m_loops;
+};
+
+}
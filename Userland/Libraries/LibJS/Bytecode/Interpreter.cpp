@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/VM.h>
+
+namespace JS::Bytecode {
+
+Interpreter::Interpreter(JS::Interpreter& ast_interpreter, GlobalObject& global_object, const Executable& executable)
+    : m_ast_interpreter(ast_interpreter)
+    , m_global_object(global_object)
+    , m_vm(global_object.vm())
+    , m_executable(executable)
+    , m_registers(global_object.heap())
+{
+    m_registers.resize(executable.register_count);
+}
+
+Interpreter::~Interpreter()
+{
+}
+
+Value Interpreter::run()
+{
+    auto& instructions = m_executable.instructions;
+    while (m_pc < instructions.size()) {
+        auto& instruction = instructions[m_pc++];
+        instruction.execute(*this);
+        if (m_vm.exception() || m_has_returned)
+            break;
+    }
+
+    // Returns and exceptions can leave in the middle of a block, so leave its scope for it.
+    exit_scopes_until(0);
+
+    if (m_vm.exception())
+        return {};
+    if (m_has_returned)
+        return m_return_value;
+    if (m_executable.completion_register.has_value())
+        return reg(m_executable.completion_register.value()).value_or(js_undefined());
+    return js_undefined();
+}
+
+void Interpreter::enter_scope(const ScopeNode& scope_node)
+{
+    m_ast_interpreter.enter_scope(scope_node, ScopeType::Block, m_global_object);
+    m_scopes.append(&scope_node);
+}
+
+void Interpreter::exit_scope(const ScopeNode& scope_node)
+{
+    VERIFY(!m_scopes.is_empty() && m_scopes.last() == &scope_node);
+    m_scopes.take_last();
+    m_ast_interpreter.exit_scope(scope_node);
+}
+
+void Interpreter::exit_scopes_until(size_t depth)
+{
+    while (m_scopes.size() > depth)
+        exit_scope(*m_scopes.last());
+}
+
+}
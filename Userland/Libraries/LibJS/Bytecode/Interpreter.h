@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Vector.h>
+#include <LibJS/Bytecode/Executable.h>
+#include <LibJS/Bytecode/Label.h>
+#include <LibJS/Bytecode/Register.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/MarkedValueList.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::Bytecode {
+
+// Runs one Executable. Each function call gets its own Bytecode::Interpreter and with it its own registers.
+class Interpreter {
+    AK_MAKE_NONCOPYABLE(Interpreter);
+    AK_MAKE_NONMOVABLE(Interpreter);
+
+public:
+    Interpreter(JS::Interpreter&, GlobalObject&, const Executable&);
+    ~Interpreter();
+
+    Value run();
+
+    JS::Interpreter& ast_interpreter() { return m_ast_interpreter; }
+    GlobalObject& global_object() { return m_global_object; }
+    VM& vm() { return m_vm; }
+
+    Value& reg(Register reg) { return m_registers[reg.index()]; }
+
+    void jump(Label label) { m_pc = m_executable.address_of(label); }
+    void do_return(Value return_value)
+    {
+        m_return_value = return_value;
+        m_has_returned = true;
+    }
+
+    void enter_scope(const ScopeNode&);
+    void exit_scope(const ScopeNode&);
+    size_t scope_depth() const { return m_scopes.size(); }
+    void exit_scopes_until(size_t depth);
+
+private:
+    JS::Interpreter& m_ast_interpreter;
+    GlobalObject& m_global_object;
+    VM& m_vm;
+    const Executable& m_executable;
+    MarkedValueList m_registers;
+    Vector<const ScopeNode*> m_scopes;
+    size_t m_pc { 0 };
+    Value m_return_value;
+    bool m_has_returned { false };
+};
+
+}
@@ -0,0 +1,517 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <AK/StringBuilder.h>
+#include <LibJS/AST.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Runtime/Array.h>
+#include <LibJS/Runtime/BigInt.h>
+#include <LibJS/Runtime/Error.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/PrimitiveString.h>
+#include <LibJS/Runtime/Reference.h>
+#include <LibJS/Runtime/VM.h>
+
+namespace JS::Bytecode::Op {
+
+static String format_register_list(const Vector<Register>& registers)
+{
+    StringBuilder builder;
+    for (size_t i = 0; i < registers.size(); ++i) {
+        if (i != 0)
+            builder.append(", ");
+        builder.appendff("{}", registers[i]);
+    }
+    return builder.to_string();
+}
+
+void Load::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.reg(m_dst) = m_value;
+}
+
+String Load::to_string() const
+{
+    return String::formatted("Load {}, {}", m_dst, m_value.to_string_without_side_effects());
+}
+
+void Move::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.reg(m_dst) = interpreter.reg(m_src);
+}
+
+String Move::to_string() const
+{
+    return String::formatted("Move {}, {}", m_dst, m_src);
+}
+
+void NewString::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.reg(m_dst) = js_string(interpreter.vm(), m_string);
+}
+
+String NewString::to_string() const
+{
+    return String::formatted("NewString {}, \"{}\"", m_dst, m_string);
+}
+
+void NewBigInt::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.reg(m_dst) = js_bigint(interpreter.vm().heap(), m_bigint);
+}
+
+String NewBigInt::to_string() const
+{
+    return String::formatted("NewBigInt {}, {}n", m_dst, m_bigint.to_base10());
+}
+
+void NewArray::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto* array = Array::create(interpreter.global_object());
+    for (auto& element : m_elements)
+        array->indexed_properties().append(interpreter.reg(element));
+    interpreter.reg(m_dst) = array;
+}
+
+String NewArray::to_string() const
+{
+    return String::formatted("NewArray {}, [{}]", m_dst, format_register_list(m_elements));
+}
+
+void NewObject::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.reg(m_dst) = Object::create_empty(interpreter.global_object());
+}
+
+String NewObject::to_string() const
+{
+    return String::formatted("NewObject {}", m_dst);
+}
+
+static String format_coordinate(const Optional<EnvironmentCoordinate>& coordinate)
+{
+    if (!coordinate.has_value())
+        return {};
+    return String::formatted(" ({}, {})", coordinate->hops, coordinate->index);
+}
+
+void GetVariable::execute(Bytecode::Interpreter& interpreter) const
+{
+    if (auto* environment = interpreter.vm().environment_for_binding(m_coordinate, m_name)) {
+        interpreter.reg(m_dst) = environment->slot(m_coordinate->index).value;
+        return;
+    }
+
+    auto value = interpreter.vm().get_variable(m_name, interpreter.global_object());
+    if (interpreter.vm().exception())
+        return;
+    if (value.is_empty()) {
+        interpreter.vm().throw_exception<ReferenceError>(interpreter.global_object(), ErrorType::UnknownIdentifier, m_name);
+        return;
+    }
+    interpreter.reg(m_dst) = value;
+}
+
+String GetVariable::to_string() const
+{
+    return String::formatted("GetVariable {}, {}{}", m_dst, m_name, format_coordinate(m_coordinate));
+}
+
+void SetVariable::execute(Bytecode::Interpreter& interpreter) const
+{
+    if (auto* environment = interpreter.vm().environment_for_binding(m_coordinate, m_name)) {
+        if (environment->slot(m_coordinate->index).declaration_kind == DeclarationKind::Const) {
+            interpreter.vm().throw_exception<TypeError>(interpreter.global_object(), ErrorType::InvalidAssignToConst);
+            return;
+        }
+        environment->set_slot_value(m_coordinate->index, interpreter.reg(m_src));
+        return;
+    }
+
+    auto reference = interpreter.vm().get_reference(m_name);
+    if (reference.is_unresolvable()) {
+        interpreter.vm().throw_exception<ReferenceError>(interpreter.global_object(), ErrorType::InvalidLeftHandAssignment);
+        return;
+    }
+    reference.put(interpreter.global_object(), interpreter.reg(m_src));
+}
+
+String SetVariable::to_string() const
+{
+    return String::formatted("SetVariable {}{}, {}", m_name, format_coordinate(m_coordinate), m_src);
+}
+
+void InitializeVariable::execute(Bytecode::Interpreter& interpreter) const
+{
+    if (auto* environment = interpreter.vm().environment_for_binding(m_coordinate, m_name)) {
+        environment->set_slot_value(m_coordinate->index, interpreter.reg(m_src));
+        return;
+    }
+    interpreter.vm().set_variable(m_name, interpreter.reg(m_src), interpreter.global_object(), true);
+}
+
+String InitializeVariable::to_string() const
+{
+    return String::formatted("InitializeVariable {}{}, {}", m_name, format_coordinate(m_coordinate), m_src);
+}
+
+void GetById::execute(Bytecode::Interpreter& interpreter) const
+{
+    Reference reference { interpreter.reg(m_base), m_property, m_lookup_cache };
+    auto value = reference.get(interpreter.global_object());
+    if (interpreter.vm().exception())
+        return;
+    interpreter.reg(m_dst) = value;
+}
+
+String GetById::to_string() const
+{
+    return String::formatted("GetById {}, {}, {}", m_dst, m_base, m_property);
+}
+
+void PutById::execute(Bytecode::Interpreter& interpreter) const
+{
+    Reference reference { interpreter.reg(m_base), m_property, m_lookup_cache };
+    reference.put(interpreter.global_object(), interpreter.reg(m_src));
+}
+
+String PutById::to_string() const
+{
+    return String::formatted("PutById {}, {}, {}", m_base, m_property, m_src);
+}
+
+void GetByValue::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto property_name = PropertyName::from_value(interpreter.global_object(), interpreter.reg(m_property));
+    if (interpreter.vm().exception())
+        return;
+    Reference reference { interpreter.reg(m_base), property_name };
+    auto value = reference.get(interpreter.global_object());
+    if (interpreter.vm().exception())
+        return;
+    interpreter.reg(m_dst) = value;
+}
+
+String GetByValue::to_string() const
+{
+    return String::formatted("GetByValue {}, {}, {}", m_dst, m_base, m_property);
+}
+
+void PutByValue::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto property_name = PropertyName::from_value(interpreter.global_object(), interpreter.reg(m_property));
+    if (interpreter.vm().exception())
+        return;
+    Reference reference { interpreter.reg(m_base), property_name };
+    reference.put(interpreter.global_object(), interpreter.reg(m_src));
+}
+
+String PutByValue::to_string() const
+{
+    return String::formatted("PutByValue {}, {}, {}", m_base, m_property, m_src);
+}
+
+static Value abstract_equals(GlobalObject& global_object, Value lhs, Value rhs)
+{
+    return Value(abstract_eq(global_object, lhs, rhs));
+}
+
+static Value abstract_inequals(GlobalObject& global_object, Value lhs, Value rhs)
+{
+    return Value(!abstract_eq(global_object, lhs, rhs));
+}
+
+static Value typed_equals(GlobalObject&, Value lhs, Value rhs)
+{
+    return Value(strict_eq(lhs, rhs));
+}
+
+static Value typed_inequals(GlobalObject&, Value lhs, Value rhs)
+{
+    return Value(!strict_eq(lhs, rhs));
+}
+
+#define __JS_ENUMERATE_BINARY_OP(OpTitleCase, op_snake_case)                                                      \
+    void OpTitleCase::execute(Bytecode::Interpreter& interpreter) const                                           \
+    {                                                                                                             \
+        auto result = op_snake_case(interpreter.global_object(), interpreter.reg(m_lhs), interpreter.reg(m_rhs)); \
+        if (interpreter.vm().exception())                                                                         \
+            return;                                                                                               \
+        interpreter.reg(m_dst) = result;                                                                          \
+    }                                                                                                             \
+    String OpTitleCase::to_string() const                                                                         \
+    {                                                                                                             \
+        return String::formatted(#OpTitleCase " {}, {}, {}", m_dst, m_lhs, m_rhs);                                \
+    }
+
+JS_ENUMERATE_BYTECODE_BINARY_OPS(__JS_ENUMERATE_BINARY_OP)
+#undef __JS_ENUMERATE_BINARY_OP
+
+static Value not_(GlobalObject&, Value value)
+{
+    return Value(!value.to_boolean());
+}
+
+static Value typeof_(GlobalObject& global_object, Value value)
+{
+    return js_string(global_object.vm(), value.typeof());
+}
+
+static Value to_numeric(GlobalObject& global_object, Value value)
+{
+    return value.to_numeric(global_object);
+}
+
+// Increment and Decrement expect an operand that has already been through ToNumeric.
+static Value increment(GlobalObject& global_object, Value value)
+{
+    if (value.is_number())
+        return Value(value.as_double() + 1);
+    return js_bigint(global_object.heap(), value.as_bigint().big_integer().plus(Crypto::SignedBigInteger { 1 }));
+}
+
+static Value decrement(GlobalObject& global_object, Value value)
+{
+    if (value.is_number())
+        return Value(value.as_double() - 1);
+    return js_bigint(global_object.heap(), value.as_bigint().big_integer().minus(Crypto::SignedBigInteger { 1 }));
+}
+
+static Value to_object(GlobalObject& global_object, Value value)
+{
+    return value.to_object(global_object);
+}
+
+#define __JS_ENUMERATE_UNARY_OP(OpTitleCase, op_snake_case)                               \
+    void OpTitleCase::execute(Bytecode::Interpreter& interpreter) const                   \
+    {                                                                                     \
+        auto result = op_snake_case(interpreter.global_object(), interpreter.reg(m_src)); \
+        if (interpreter.vm().exception())                                                 \
+            return;                                                                       \
+        interpreter.reg(m_dst) = result;                                                  \
+    }                                                                                     \
+    String OpTitleCase::to_string() const                                                 \
+    {                                                                                     \
+        return String::formatted(#OpTitleCase " {}, {}", m_dst, m_src);                   \
+    }
+
+JS_ENUMERATE_BYTECODE_UNARY_OPS(__JS_ENUMERATE_UNARY_OP)
+#undef __JS_ENUMERATE_UNARY_OP
+
+void Jump::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.jump(m_target);
+}
+
+String Jump::to_string() const
+{
+    return String::formatted("Jump {}", m_target);
+}
+
+void JumpIfTrue::execute(Bytecode::Interpreter& interpreter) const
+{
+    if (interpreter.reg(m_condition).to_boolean())
+        interpreter.jump(m_target);
+}
+
+String JumpIfTrue::to_string() const
+{
+    return String::formatted("JumpIfTrue {}, {}", m_condition, m_target);
+}
+
+void JumpIfFalse::execute(Bytecode::Interpreter& interpreter) const
+{
+    if (!interpreter.reg(m_condition).to_boolean())
+        interpreter.jump(m_target);
+}
+
+String JumpIfFalse::to_string() const
+{
+    return String::formatted("JumpIfFalse {}, {}", m_condition, m_target);
+}
+
+void JumpIfNotNullish::execute(Bytecode::Interpreter& interpreter) const
+{
+    if (!interpreter.reg(m_condition).is_nullish())
+        interpreter.jump(m_target);
+}
+
+String JumpIfNotNullish::to_string() const
+{
+    return String::formatted("JumpIfNotNullish {}, {}", m_condition, m_target);
+}
+
+void Call::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto& vm = interpreter.vm();
+    auto callee = interpreter.reg(m_callee);
+    if (!callee.is_function()) {
+        m_call_expression.throw_type_error_for_callee(interpreter.global_object(), callee);
+        return;
+    }
+
+    Value this_value = &interpreter.global_object();
+    if (m_this_value.has_value())
+        this_value = interpreter.reg(m_this_value.value());
+
+    MarkedValueList arguments(vm.heap());
+    arguments.ensure_capacity(m_arguments.size());
+    for (auto& argument : m_arguments)
+        arguments.append(interpreter.reg(argument));
+
+    // Let the callee's call frame and any exception point at this call, like they would in the AST interpreter.
+    auto& ast_interpreter = interpreter.ast_interpreter();
+    ExecutingASTNodeChain chain_node { nullptr, m_call_expression };
+    vm.call_frame().current_node = &m_call_expression;
+    ast_interpreter.push_ast_node(chain_node);
+    auto result = vm.call(callee.as_function(), this_value, move(arguments));
+    ast_interpreter.pop_ast_node();
+    if (vm.exception())
+        return;
+    interpreter.reg(m_dst) = result;
+}
+
+String Call::to_string() const
+{
+    if (m_this_value.has_value())
+        return String::formatted("Call {}, {}, this={}, ({})", m_dst, m_callee, m_this_value.value(), format_register_list(m_arguments));
+    return String::formatted("Call {}, {}, ({})", m_dst, m_callee, format_register_list(m_arguments));
+}
+
+void ResolveThisBinding::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto this_value = interpreter.vm().resolve_this_binding(interpreter.global_object());
+    if (interpreter.vm().exception())
+        return;
+    interpreter.reg(m_dst) = this_value;
+}
+
+String ResolveThisBinding::to_string() const
+{
+    return String::formatted("ResolveThisBinding {}", m_dst);
+}
+
+void EnterScope::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.enter_scope(m_scope_node);
+}
+
+String EnterScope::to_string() const
+{
+    return "EnterScope";
+}
+
+void ExitScope::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.exit_scope(m_scope_node);
+}
+
+String ExitScope::to_string() const
+{
+    return "ExitScope";
+}
+
+void Return::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.do_return(m_argument.has_value() ? interpreter.reg(m_argument.value()) : js_undefined());
+}
+
+String Return::to_string() const
+{
+    if (m_argument.has_value())
+        return String::formatted("Return {}", m_argument.value());
+    return "Return";
+}
+
+void Throw::execute(Bytecode::Interpreter& interpreter) const
+{
+    interpreter.vm().throw_exception(interpreter.global_object(), interpreter.reg(m_argument));
+}
+
+String Throw::to_string() const
+{
+    return String::formatted("Throw {}", m_argument);
+}
+
+void EvaluateExpression::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto value = m_expression.execute(interpreter.ast_interpreter(), interpreter.global_object());
+    if (interpreter.vm().exception())
+        return;
+    interpreter.reg(m_dst) = value;
+}
+
+String EvaluateExpression::to_string() const
+{
+    return String::formatted("EvaluateExpression {}, {}", m_dst, m_expression.class_name());
+}
+
+void EvaluateStatement::execute(Bytecode::Interpreter& interpreter) const
+{
+    auto& vm = interpreter.vm();
+    auto value = m_statement.execute(interpreter.ast_interpreter(), interpreter.global_object());
+    if (vm.exception())
+        return;
+    if (m_completion.has_value() && !value.is_empty())
+        interpreter.reg(m_completion.value()) = value;
+    if (!vm.should_unwind())
+        return;
+
+    if (vm.unwind_until() == ScopeType::Function) {
+        // The function's executor stops the unwind, just like it does for the AST interpreter.
+        // Not every statement passes on the value of a nested return, but the VM keeps track of it.
+        if (value.is_empty())
+            value = vm.last_value();
+        interpreter.do_return(value.value_or(js_undefined()));
+        return;
+    }
+
+    if (m_loop_targets.has_value() && vm.should_unwind_until(ScopeType::Breakable)) {
+        vm.stop_unwind();
+        interpreter.exit_scopes_until(m_loop_targets->scope_depth);
+        interpreter.jump(m_loop_targets->break_target);
+        return;
+    }
+
+    if (m_loop_targets.has_value() && vm.should_unwind_until(ScopeType::Continuable)) {
+        vm.stop_unwind();
+        interpreter.exit_scopes_until(m_loop_targets->scope_depth);
+        interpreter.jump(m_loop_targets->continue_target);
+        return;
+    }
+
+    // Whatever this is unwinding to lives outside of this bytecode, so keep unwinding.
+    interpreter.do_return(value.value_or(js_undefined()));
+}
+
+String EvaluateStatement::to_string() const
+{
+    return String::formatted("EvaluateStatement {}", m_statement.class_name());
+}
+
+}
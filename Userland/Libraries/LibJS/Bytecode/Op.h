@@ -0,0 +1,543 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/FlyString.h>
+#include <AK/Optional.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibCrypto/BigInt/SignedBigInteger.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Label.h>
+#include <LibJS/Bytecode/Register.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/PropertyLookupCache.h>
+#include <LibJS/Runtime/ScopeObject.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::Bytecode::Op {
+
+class Load final : public Instruction {
+public:
+    Load(Register dst, Value value)
+        : m_dst(dst)
+        , m_value(value)
+    {
+        // Constants live outside the heap, so they must not point into it.
+        VERIFY(!value.is_cell());
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_dst;
+    Value m_value;
+};
+
+class Move final : public Instruction {
+public:
+    Move(Register dst, Register src)
+        : m_dst(dst)
+        , m_src(src)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_dst;
+    Register m_src;
+};
+
+class NewString final : public Instruction {
+public:
+    NewString(Register dst, String string)
+        : m_dst(dst)
+        , m_string(move(string))
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_dst;
+    String m_string;
+};
+
+class NewBigInt final : public Instruction {
+public:
+    NewBigInt(Register dst, Crypto::SignedBigInteger bigint)
+        : m_dst(dst)
+        , m_bigint(move(bigint))
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_dst;
+    Crypto::SignedBigInteger m_bigint;
+};
+
+class NewArray final : public Instruction {
+public:
+    NewArray(Register dst, Vector<Register> elements)
+        : m_dst(dst)
+        , m_elements(move(elements))
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_dst;
+    Vector<Register> m_elements;
+};
+
+class NewObject final : public Instruction {
+public:
+    explicit NewObject(Register dst)
+        : m_dst(dst)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_dst;
+};
+
+class GetVariable final : public Instruction {
+public:
+    GetVariable(Register dst, FlyString name, Optional<EnvironmentCoordinate> coordinate = {})
+        : m_dst(dst)
+        , m_name(move(name))
+        , m_coordinate(coordinate)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_dst;
+    FlyString m_name;
+    Optional<EnvironmentCoordinate> m_coordinate;
+};
+
+class SetVariable final : public Instruction {
+public:
+    SetVariable(FlyString name, Register src, Optional<EnvironmentCoordinate> coordinate = {})
+        : m_name(move(name))
+        , m_src(src)
+        , m_coordinate(coordinate)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    FlyString m_name;
+    Register m_src;
+    Optional<EnvironmentCoordinate> m_coordinate;
+};
+
+// Like SetVariable, but for the initializer of a declaration, which may assign to a const.
+class InitializeVariable final : public Instruction {
+public:
+    InitializeVariable(FlyString name, Register src, Optional<EnvironmentCoordinate> coordinate = {})
+        : m_name(move(name))
+        , m_src(src)
+        , m_coordinate(coordinate)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    FlyString m_name;
+    Register m_src;
+    Optional<EnvironmentCoordinate> m_coordinate;
+};
+
+class GetById final : public Instruction {
+public:
+    GetById(Register dst, Register base, FlyString property)
+        : m_dst(dst)
+        , m_base(base)
+        , m_property(move(property))
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_dst;
+    Register m_base;
+    FlyString m_property;
+    mutable PropertyLookupCache m_lookup_cache;
+};
+
+class PutById final : public Instruction {
+public:
+    PutById(Register base, FlyString property, Register src)
+        : m_base(base)
+        , m_property(move(property))
+        , m_src(src)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_base;
+    FlyString m_property;
+    Register m_src;
+    mutable PropertyLookupCache m_lookup_cache;
+};
+
+class GetByValue final : public Instruction {
+public:
+    GetByValue(Register dst, Register base, Register property)
+        : m_dst(dst)
+        , m_base(base)
+        , m_property(property)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_dst;
+    Register m_base;
+    Register m_property;
+};
+
+class PutByValue final : public Instruction {
+public:
+    PutByValue(Register base, Register property, Register src)
+        : m_base(base)
+        , m_property(property)
+        , m_src(src)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_base;
+    Register m_property;
+    Register m_src;
+};
+
+#define JS_ENUMERATE_BYTECODE_BINARY_OPS(O)     \
+    O(Add, add)                                 \
+    O(Sub, sub)                                 \
+    O(Mul, mul)                                 \
+    O(Div, div)                                 \
+    O(Mod, mod)                                 \
+    O(Exp, exp)                                 \
+    O(GreaterThan, greater_than)                \
+    O(GreaterThanEquals, greater_than_equals)   \
+    O(LessThan, less_than)                      \
+    O(LessThanEquals, less_than_equals)         \
+    O(AbstractEquals, abstract_equals)          \
+    O(AbstractInequals, abstract_inequals)      \
+    O(TypedEquals, typed_equals)                \
+    O(TypedInequals, typed_inequals)            \
+    O(BitwiseAnd, bitwise_and)                  \
+    O(BitwiseOr, bitwise_or)                    \
+    O(BitwiseXor, bitwise_xor)                  \
+    O(LeftShift, left_shift)                    \
+    O(RightShift, right_shift)                  \
+    O(UnsignedRightShift, unsigned_right_shift) \
+    O(In, in)                                   \
+    O(InstanceOf, instance_of)
+
+#define __JS_ENUMERATE_BINARY_OP(OpTitleCase, op_snake_case)         \
+    class OpTitleCase final : public Instruction {                   \
+    public:                                                          \
+        OpTitleCase(Register dst, Register lhs, Register rhs)        \
+            : m_dst(dst)                                             \
+            , m_lhs(lhs)                                             \
+            , m_rhs(rhs)                                             \
+        {                                                            \
+        }                                                            \
+                                                                     \
+        virtual void execute(Bytecode::Interpreter&) const override; \
+        virtual String to_string() const override;                   \
+                                                                     \
+    private:                                                         \
+        Register m_dst;                                              \
+        Register m_lhs;                                              \
+        Register m_rhs;                                              \
+    };
+
+JS_ENUMERATE_BYTECODE_BINARY_OPS(__JS_ENUMERATE_BINARY_OP)
+#undef __JS_ENUMERATE_BINARY_OP
+
+#define JS_ENUMERATE_BYTECODE_UNARY_OPS(O) \
+    O(BitwiseNot, bitwise_not)             \
+    O(Not, not_)                           \
+    O(UnaryPlus, unary_plus)               \
+    O(UnaryMinus, unary_minus)             \
+    O(Typeof, typeof_)                     \
+    O(ToNumeric, to_numeric)               \
+    O(Increment, increment)                \
+    O(Decrement, decrement)                \
+    O(ToObject, to_object)
+
+#define __JS_ENUMERATE_UNARY_OP(OpTitleCase, op_snake_case)          \
+    class OpTitleCase final : public Instruction {                   \
+    public:                                                          \
+        OpTitleCase(Register dst, Register src)                      \
+            : m_dst(dst)                                             \
+            , m_src(src)                                             \
+        {                                                            \
+        }                                                            \
+                                                                     \
+        virtual void execute(Bytecode::Interpreter&) const override; \
+        virtual String to_string() const override;                   \
+                                                                     \
+    private:                                                         \
+        Register m_dst;                                              \
+        Register m_src;                                              \
+    };
+
+JS_ENUMERATE_BYTECODE_UNARY_OPS(__JS_ENUMERATE_UNARY_OP)
+#undef __JS_ENUMERATE_UNARY_OP
+
+class Jump final : public Instruction {
+public:
+    explicit Jump(Label target)
+        : m_target(target)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Label m_target;
+};
+
+class JumpIfTrue final : public Instruction {
+public:
+    JumpIfTrue(Register condition, Label target)
+        : m_condition(condition)
+        , m_target(target)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_condition;
+    Label m_target;
+};
+
+class JumpIfFalse final : public Instruction {
+public:
+    JumpIfFalse(Register condition, Label target)
+        : m_condition(condition)
+        , m_target(target)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_condition;
+    Label m_target;
+};
+
+class JumpIfNotNullish final : public Instruction {
+public:
+    JumpIfNotNullish(Register condition, Label target)
+        : m_condition(condition)
+        , m_target(target)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_condition;
+    Label m_target;
+};
+
+class Call final : public Instruction {
+public:
+    Call(Register dst, Register callee, Optional<Register> this_value, Vector<Register> arguments, const CallExpression& call_expression)
+        : m_dst(dst)
+        , m_callee(callee)
+        , m_this_value(this_value)
+        , m_arguments(move(arguments))
+        , m_call_expression(call_expression)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_dst;
+    Register m_callee;
+    Optional<Register> m_this_value;
+    Vector<Register> m_arguments;
+    const CallExpression& m_call_expression;
+};
+
+class ResolveThisBinding final : public Instruction {
+public:
+    explicit ResolveThisBinding(Register dst)
+        : m_dst(dst)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_dst;
+};
+
+class EnterScope final : public Instruction {
+public:
+    explicit EnterScope(const ScopeNode& scope_node)
+        : m_scope_node(scope_node)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    const ScopeNode& m_scope_node;
+};
+
+class ExitScope final : public Instruction {
+public:
+    explicit ExitScope(const ScopeNode& scope_node)
+        : m_scope_node(scope_node)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    const ScopeNode& m_scope_node;
+};
+
+class Return final : public Instruction {
+public:
+    explicit Return(Optional<Register> argument)
+        : m_argument(argument)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Optional<Register> m_argument;
+};
+
+class Throw final : public Instruction {
+public:
+    explicit Throw(Register argument)
+        : m_argument(argument)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_argument;
+};
+
+// Evaluates an expression we don't generate bytecode for with the AST interpreter.
+class EvaluateExpression final : public Instruction {
+public:
+    EvaluateExpression(Register dst, const Expression& expression)
+        : m_dst(dst)
+        , m_expression(expression)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    Register m_dst;
+    const Expression& m_expression;
+};
+
+// Evaluates a statement we don't generate bytecode for with the AST interpreter.
+// A break, continue or return inside of it is picked up from the VM's unwind state afterwards.
+class EvaluateStatement final : public Instruction {
+public:
+    struct LoopTargets {
+        Label break_target;
+        Label continue_target;
+        size_t scope_depth { 0 };
+    };
+
+    EvaluateStatement(const Statement& statement, Optional<Register> completion, Optional<LoopTargets> loop_targets)
+        : m_statement(statement)
+        , m_completion(completion)
+        , m_loop_targets(loop_targets)
+    {
+    }
+
+    virtual void execute(Bytecode::Interpreter&) const override;
+    virtual String to_string() const override;
+
+private:
+    const Statement& m_statement;
+    Optional<Register> m_completion;
+    Optional<LoopTargets> m_loop_targets;
+};
+
+}
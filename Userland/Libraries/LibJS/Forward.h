@@ -143,8 +143,10 @@ class PrimitiveString;
 class PromiseReaction;
 class PromiseReactionJob;
 class PromiseResolveThenableJob;
+class PropertyLookupCache;
 class PropertyName;
 class Reference;
+class ScopeAnalysis;
 class ScopeNode;
 class ScopeObject;
 class Shape;
@@ -156,6 +158,7 @@ class VM;
 class Value;
 enum class DeclarationKind;
 struct AlreadyResolved;
+struct EnvironmentCoordinate;
 struct JobCallback;
 struct PromiseCapability;
 
@@ -178,4 +181,13 @@ JS_ENUMERATE_TYPED_ARRAYS
 template<class T>
 class Handle;
 
+namespace Bytecode {
+class Generator;
+class Instruction;
+class Interpreter;
+class Label;
+class Register;
+struct Executable;
+}
+
 }
@@ -56,7 +56,9 @@ Cell* Allocator::allocate_cell(Heap& heap)
 
 void Allocator::block_did_become_empty(Badge<Heap>, HeapBlock& block)
 {
-    block.m_list_node.remove();
+    // Blocks that were just swept have already been taken off the pending list.
+    if (block.m_list_node.is_in_list())
+        block.m_list_node.remove();
     delete &block;
 }
 
@@ -66,4 +68,18 @@ void Allocator::block_did_become_usable(Badge<Heap>, HeapBlock& block)
     m_usable_blocks.append(block);
 }
 
+void Allocator::block_did_become_full(Badge<Heap>, HeapBlock& block)
+{
+    VERIFY(block.is_full());
+    m_full_blocks.append(block);
+}
+
+void Allocator::defer_sweeping_of_all_blocks(Badge<Heap>)
+{
+    while (auto* block = m_full_blocks.take_last())
+        m_blocks_pending_sweep.append(*block);
+    while (auto* block = m_usable_blocks.take_last())
+        m_blocks_pending_sweep.append(*block);
+}
+
 }
@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <AK/Badge.h>
 #include <AK/IntrusiveList.h>
 #include <AK/NonnullOwnPtr.h>
 #include <AK/Vector.h>
@@ -54,11 +55,23 @@ public:
             if (callback(block) == IterationDecision::Break)
                 return IterationDecision::Break;
         }
+        for (auto& block : m_blocks_pending_sweep) {
+            if (callback(block) == IterationDecision::Break)
+                return IterationDecision::Break;
+        }
         return IterationDecision::Continue;
     }
 
+    bool has_usable_blocks() const { return !m_usable_blocks.is_empty(); }
+    bool has_blocks_pending_sweep() const { return !m_blocks_pending_sweep.is_empty(); }
+
+    // Blocks pending sweep are not allocated from until the heap has swept them and handed them back.
+    void defer_sweeping_of_all_blocks(Badge<Heap>);
+    HeapBlock* take_block_pending_sweep(Badge<Heap>) { return m_blocks_pending_sweep.take_last(); }
+
     void block_did_become_empty(Badge<Heap>, HeapBlock&);
     void block_did_become_usable(Badge<Heap>, HeapBlock&);
+    void block_did_become_full(Badge<Heap>, HeapBlock&);
 
 private:
     const size_t m_cell_size;
@@ -66,6 +79,7 @@ private:
     typedef IntrusiveList<HeapBlock, RawPtr<HeapBlock>, &HeapBlock::m_list_node> BlockList;
     BlockList m_full_blocks;
     BlockList m_usable_blocks;
+    BlockList m_blocks_pending_sweep;
 };
 
 }
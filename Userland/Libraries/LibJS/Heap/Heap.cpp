@@ -29,7 +29,6 @@
 #include <AK/HashTable.h>
 #include <AK/StackInfo.h>
 #include <AK/TemporaryChange.h>
-#include <LibCore/ElapsedTimer.h>
 #include <LibJS/Heap/Allocator.h>
 #include <LibJS/Heap/Handle.h>
 #include <LibJS/Heap/Heap.h>
@@ -37,6 +36,7 @@
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/Object.h>
 #include <setjmp.h>
+#include <time.h>
 
 namespace JS {
 
@@ -67,19 +67,30 @@ ALWAYS_INLINE Allocator& Heap::allocator_for_size(size_t cell_size)
     VERIFY_NOT_REACHED();
 }
 
+static Time monotonic_time()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return Time::from_timespec(now);
+}
+
 Cell* Heap::allocate_cell(size_t size)
 {
     if (should_collect_on_every_allocation()) {
-        collect_garbage();
+        collect_garbage(CollectionType::CollectYoungGeneration);
     } else if (m_allocations_since_last_gc > m_max_allocations_between_gc) {
         m_allocations_since_last_gc = 0;
-        collect_garbage();
+        collect_garbage(CollectionType::CollectYoungGeneration);
     } else {
         ++m_allocations_since_last_gc;
     }
 
     auto& allocator = allocator_for_size(size);
-    return allocator.allocate_cell(*this);
+    if (!allocator.has_usable_blocks() && allocator.has_blocks_pending_sweep())
+        sweep_blocks_pending_sweep_until_usable(allocator);
+    auto* cell = allocator.allocate_cell(*this);
+    m_young_cells.append(cell);
+    return cell;
 }
 
 void Heap::collect_garbage(CollectionType collection_type, bool print_report)
@@ -87,18 +98,71 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
     VERIFY(!m_collecting_garbage);
     TemporaryChange change(m_collecting_garbage, true);
 
-    Core::ElapsedTimer collection_measurement_timer;
-    collection_measurement_timer.start();
+    auto start_time = monotonic_time();
+    if (collection_type == CollectionType::CollectEverything) {
+        // Nothing is going to survive, so whatever has been marked so far doesn't matter.
+        m_is_marking = false;
+        m_mark_stack.clear();
+        for_each_block([&](auto& block) {
+            block.for_each_cell([](Cell* cell) {
+                cell->set_marked(false);
+            });
+            return IterationDecision::Continue;
+        });
+        m_young_cells.clear();
+        m_remembered_set.clear();
+        for (auto& allocator : m_allocators)
+            allocator->defer_sweeping_of_all_blocks({});
+        sweep_dead_cells(print_report, start_time);
+        return;
+    }
+
+    if (m_gc_deferrals) {
+        m_should_gc_when_deferral_ends = true;
+        return;
+    }
+
     if (collection_type == CollectionType::CollectGarbage) {
-        if (m_gc_deferrals) {
-            m_should_gc_when_deferral_ends = true;
-            return;
+        if (!m_is_marking) {
+            SweepStatistics statistics;
+            sweep_blocks_pending_sweep(Time::max(), statistics);
+            start_incremental_marking();
+        }
+        finish_incremental_marking();
+        sweep_dead_cells(print_report, start_time);
+    } else {
+        // Each step is allowed to run for a bit, except when stress testing, where we want as many steps as possible.
+        auto deadline = start_time;
+        if (!should_collect_on_every_allocation())
+            deadline += Time::from_microseconds(incremental_step_budget_in_microseconds);
+
+        if (m_is_marking) {
+            ++m_statistics.marking_steps;
+            if (perform_incremental_marking_step(deadline))
+                finish_incremental_marking();
+        } else if (m_promotions_since_last_full_gc > m_max_promotions_between_full_gc) {
+            // The last full collection has to be swept completely before we can start marking for the next one.
+            SweepStatistics statistics;
+            if (sweep_blocks_pending_sweep(deadline, statistics))
+                start_incremental_marking();
+        } else {
+            HashTable<Cell*> roots;
+            gather_roots(roots);
+            mark_live_young_cells(roots);
+            sweep_dead_young_cells(print_report, start_time);
+
+            SweepStatistics statistics;
+            sweep_blocks_pending_sweep(deadline, statistics);
         }
-        HashTable<Cell*> roots;
-        gather_roots(roots);
-        mark_live_cells(roots);
     }
-    sweep_dead_cells(print_report, collection_measurement_timer);
+
+    auto pause = monotonic_time() - start_time;
+    ++m_statistics.pauses;
+    m_statistics.total_pause_time += pause;
+    if (pause > m_statistics.longest_pause)
+        m_statistics.longest_pause = pause;
+    if (pause > Time::from_microseconds(frame_time_in_microseconds))
+        ++m_statistics.pauses_longer_than_a_frame;
 }
 
 void Heap::gather_roots(HashTable<Cell*>& roots)
@@ -173,7 +237,11 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
 
 class MarkingVisitor final : public Cell::Visitor {
 public:
-    MarkingVisitor() { }
+    MarkingVisitor(Vector<Cell*>& mark_stack, size_t& marked_cells)
+        : m_mark_stack(mark_stack)
+        , m_marked_cells(marked_cells)
+    {
+    }
 
     virtual void visit_impl(Cell* cell)
     {
@@ -181,63 +249,262 @@ public:
             return;
         dbgln_if(HEAP_DEBUG, "  ! {}", cell);
         cell->set_marked(true);
-        cell->visit_edges(*this);
+        ++m_marked_cells;
+        m_mark_stack.append(cell);
     }
+
+private:
+    Vector<Cell*>& m_mark_stack;
+    size_t& m_marked_cells;
 };
 
-void Heap::mark_live_cells(const HashTable<Cell*>& roots)
+void Heap::start_incremental_marking()
 {
-    dbgln_if(HEAP_DEBUG, "mark_live_cells:");
-    MarkingVisitor visitor;
+    dbgln_if(HEAP_DEBUG, "start_incremental_marking:");
+    VERIFY(!m_is_marking);
+    m_is_marking = true;
+    m_marked_cells = 0;
+
+    HashTable<Cell*> roots;
+    gather_roots(roots);
+    MarkingVisitor visitor(m_mark_stack, m_marked_cells);
     for (auto* root : roots)
         visitor.visit(root);
 }
 
-void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measurement_timer)
+bool Heap::perform_incremental_marking_step(const Time& deadline)
 {
-    dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
-    Vector<HeapBlock*, 32> empty_blocks;
-    Vector<HeapBlock*, 32> full_blocks_that_became_usable;
+    dbgln_if(HEAP_DEBUG, "perform_incremental_marking_step: {} cells on the mark stack", m_mark_stack.size());
+    MarkingVisitor visitor(m_mark_stack, m_marked_cells);
+    size_t visited_cells = 0;
+    while (!m_mark_stack.is_empty()) {
+        m_mark_stack.take_last()->visit_edges(visitor);
+        // Looking at the clock isn't free, so only do it every once in a while.
+        if (++visited_cells % 256 == 0 && monotonic_time() >= deadline)
+            return m_mark_stack.is_empty();
+    }
+    return true;
+}
+
+void Heap::finish_incremental_marking()
+{
+    dbgln_if(HEAP_DEBUG, "finish_incremental_marking:");
+    VERIFY(m_is_marking);
+
+    // The write barrier doesn't see what the mutator stored in the roots or in always remembered cells
+    // since marking started, so those have to be visited again before we can tell what is garbage.
+    MarkingVisitor visitor(m_mark_stack, m_marked_cells);
+    HashTable<Cell*> roots;
+    gather_roots(roots);
+    for (auto* root : roots)
+        visitor.visit(root);
+    for (auto* cell : m_remembered_set) {
+        if (cell->is_marked() && cell->is_always_remembered())
+            cell->visit_edges(visitor);
+    }
+    for (auto* cell : m_young_cells) {
+        if (cell->is_marked() && cell->is_always_remembered())
+            cell->visit_edges(visitor);
+    }
+    perform_incremental_marking_step(Time::max());
+    m_is_marking = false;
+
+    m_remembered_set.remove_all_matching([](Cell* cell) {
+        if (cell->is_marked() && cell->is_always_remembered())
+            return false;
+        cell->set_remembered(false);
+        return true;
+    });
+
+    // Everything that survived is old now. The dead young cells become old as well, so that minor
+    // collections don't trace through them while they are waiting to be swept.
+    for (auto* cell : m_young_cells) {
+        cell->set_old(true);
+        if (cell->is_marked() && cell->is_always_remembered()) {
+            cell->set_remembered(true);
+            m_remembered_set.append(cell);
+        }
+    }
+    m_young_cells.clear_with_capacity();
+
+    m_promotions_since_last_full_gc = 0;
+    m_max_promotions_between_full_gc = max(m_marked_cells, min_promotions_between_full_gc);
+    ++m_statistics.full_collections;
+
+    // The cells that weren't marked are freed as the allocators need their blocks again.
+    for (auto& allocator : m_allocators)
+        allocator->defer_sweeping_of_all_blocks({});
+}
+
+class YoungGenerationMarkingVisitor final : public Cell::Visitor {
+public:
+    explicit YoungGenerationMarkingVisitor(Vector<Cell*>& mark_stack)
+        : m_mark_stack(mark_stack)
+    {
+    }
+
+    virtual void visit_impl(Cell* cell)
+    {
+        if (cell->is_old() || cell->is_marked())
+            return;
+        dbgln_if(HEAP_DEBUG, "  ! {}", cell);
+        cell->set_marked(true);
+        m_mark_stack.append(cell);
+    }
+
+private:
+    Vector<Cell*>& m_mark_stack;
+};
+
+void Heap::mark_live_young_cells(const HashTable<Cell*>& roots)
+{
+    dbgln_if(HEAP_DEBUG, "mark_live_young_cells:");
+    YoungGenerationMarkingVisitor visitor(m_mark_stack);
+    for (auto* root : roots)
+        visitor.visit(root);
+
+    // Old cells are assumed to be live until the next full collection,
+    // so everything young they point to is live as well.
+    for (auto* cell : m_remembered_set)
+        cell->visit_edges(visitor);
+
+    while (!m_mark_stack.is_empty())
+        m_mark_stack.take_last()->visit_edges(visitor);
+}
+
+void Heap::promote(Cell& cell)
+{
+    cell.set_old(true);
+    ++m_promotions_since_last_full_gc;
+    if (cell.is_always_remembered()) {
+        cell.set_remembered(true);
+        m_remembered_set.append(&cell);
+    }
+}
+
+void Heap::sweep_dead_young_cells(bool print_report, const Time& start_time)
+{
+    dbgln_if(HEAP_DEBUG, "sweep_dead_young_cells:");
 
     size_t collected_cells = 0;
     size_t live_cells = 0;
     size_t collected_cell_bytes = 0;
     size_t live_cell_bytes = 0;
 
-    for_each_block([&](auto& block) {
-        bool block_has_live_cells = false;
+    // Every surviving young cell is promoted below, so old cells can no longer point to young ones.
+    m_remembered_set.remove_all_matching([](Cell* cell) {
+        if (cell->is_always_remembered())
+            return false;
+        cell->set_remembered(false);
+        return true;
+    });
+
+    for (auto* cell : m_young_cells) {
+        auto& block = *HeapBlock::from_cell(cell);
+        if (cell->is_marked()) {
+            cell->set_marked(false);
+            promote(*cell);
+            ++live_cells;
+            live_cell_bytes += block.cell_size();
+            continue;
+        }
+        dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
         bool block_was_full = block.is_full();
-        block.for_each_cell([&](Cell* cell) {
-            if (cell->is_live()) {
-                if (!cell->is_marked()) {
-                    dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
-                    block.deallocate(cell);
-                    ++collected_cells;
-                    collected_cell_bytes += block.cell_size();
-                } else {
-                    cell->set_marked(false);
-                    block_has_live_cells = true;
-                    ++live_cells;
-                    live_cell_bytes += block.cell_size();
-                }
-            }
-        });
-        if (!block_has_live_cells)
-            empty_blocks.append(&block);
-        else if (block_was_full != block.is_full())
-            full_blocks_that_became_usable.append(&block);
-        return IterationDecision::Continue;
+        block.deallocate(cell);
+        ++collected_cells;
+        collected_cell_bytes += block.cell_size();
+        // Blocks that become empty are only given back by the next full collection.
+        if (block_was_full)
+            allocator_for_size(block.cell_size()).block_did_become_usable({}, block);
+    }
+    m_young_cells.clear_with_capacity();
+
+    if (collected_cells)
+        ++m_sweep_count;
+
+    ++m_statistics.young_collections;
+
+    auto time_spent = (monotonic_time() - start_time).to_milliseconds();
+
+    if (print_report) {
+        dbgln("Young generation collection report");
+        dbgln("=============================================");
+        dbgln("     Time spent: {} ms", time_spent);
+        dbgln("Promoted cells: {} ({} bytes)", live_cells, live_cell_bytes);
+        dbgln("Collected cells: {} ({} bytes)", collected_cells, collected_cell_bytes);
+        dbgln(" Remembered set: {} cells", m_remembered_set.size());
+        dbgln("=============================================");
+    }
+}
+
+void Heap::sweep_block(HeapBlock& block, SweepStatistics& statistics)
+{
+    dbgln_if(HEAP_DEBUG, "sweep_block: {}", &block);
+    bool block_has_live_cells = false;
+    bool block_had_dead_cells = false;
+    block.for_each_cell([&](Cell* cell) {
+        if (!cell->is_live())
+            return;
+        if (cell->is_marked()) {
+            cell->set_marked(false);
+            block_has_live_cells = true;
+            ++statistics.live_cells;
+            statistics.live_cell_bytes += block.cell_size();
+            return;
+        }
+        dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
+        block.deallocate(cell);
+        block_had_dead_cells = true;
+        ++statistics.collected_cells;
+        statistics.collected_cell_bytes += block.cell_size();
     });
 
-    for (auto* block : empty_blocks) {
-        dbgln_if(HEAP_DEBUG, " - HeapBlock empty @ {}: cell_size={}", block, block->cell_size());
-        allocator_for_size(block->cell_size()).block_did_become_empty({}, *block);
+    if (block_had_dead_cells)
+        ++m_sweep_count;
+
+    auto& allocator = allocator_for_size(block.cell_size());
+    if (!block_has_live_cells) {
+        dbgln_if(HEAP_DEBUG, " - HeapBlock empty @ {}: cell_size={}", &block, block.cell_size());
+        ++statistics.freed_blocks;
+        allocator.block_did_become_empty({}, block);
+    } else if (block.is_full()) {
+        allocator.block_did_become_full({}, block);
+    } else {
+        allocator.block_did_become_usable({}, block);
+    }
+}
+
+bool Heap::sweep_blocks_pending_sweep(const Time& deadline, SweepStatistics& statistics)
+{
+    for (auto& allocator : m_allocators) {
+        while (auto* block = allocator->take_block_pending_sweep({})) {
+            sweep_block(*block, statistics);
+            if (monotonic_time() >= deadline)
+                return false;
+        }
     }
+    return true;
+}
 
-    for (auto* block : full_blocks_that_became_usable) {
-        dbgln_if(HEAP_DEBUG, " - HeapBlock usable again @ {}: cell_size={}", block, block->cell_size());
-        allocator_for_size(block->cell_size()).block_did_become_usable({}, *block);
+void Heap::sweep_blocks_pending_sweep_until_usable(Allocator& allocator)
+{
+    auto start_time = monotonic_time();
+    SweepStatistics statistics;
+    while (!allocator.has_usable_blocks()) {
+        auto* block = allocator.take_block_pending_sweep({});
+        if (!block)
+            break;
+        sweep_block(*block, statistics);
+        ++m_statistics.lazily_swept_blocks;
     }
+    m_statistics.lazy_sweeping_time += monotonic_time() - start_time;
+}
+
+void Heap::sweep_dead_cells(bool print_report, const Time& start_time)
+{
+    dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
+    SweepStatistics statistics;
+    sweep_blocks_pending_sweep(Time::max(), statistics);
 
 #if HEAP_DEBUG
     for_each_block([&](auto& block) {
@@ -246,7 +513,7 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
     });
 #endif
 
-    int time_spent = measurement_timer.elapsed();
+    auto time_spent = (monotonic_time() - start_time).to_milliseconds();
 
     if (print_report) {
         size_t live_block_count = 0;
@@ -258,10 +525,10 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
         dbgln("Garbage collection report");
         dbgln("=============================================");
         dbgln("     Time spent: {} ms", time_spent);
-        dbgln("     Live cells: {} ({} bytes)", live_cells, live_cell_bytes);
-        dbgln("Collected cells: {} ({} bytes)", collected_cells, collected_cell_bytes);
+        dbgln("     Live cells: {} ({} bytes)", statistics.live_cells, statistics.live_cell_bytes);
+        dbgln("Collected cells: {} ({} bytes)", statistics.collected_cells, statistics.collected_cell_bytes);
         dbgln("    Live blocks: {} ({} bytes)", live_block_count, live_block_count * HeapBlock::block_size);
-        dbgln("   Freed blocks: {} ({} bytes)", empty_blocks.size(), empty_blocks.size() * HeapBlock::block_size);
+        dbgln("   Freed blocks: {} ({} bytes)", statistics.freed_blocks, statistics.freed_blocks * HeapBlock::block_size);
         dbgln("=============================================");
     }
 }
@@ -290,6 +557,47 @@ void Heap::did_destroy_marked_value_list(Badge<MarkedValueList>, MarkedValueList
     m_marked_value_lists.remove(&list);
 }
 
+void Heap::add_to_remembered_set(Badge<Cell>, Cell& cell)
+{
+    VERIFY(cell.is_old());
+    VERIFY(!cell.is_remembered());
+    cell.set_remembered(true);
+    m_remembered_set.append(&cell);
+}
+
+void Heap::did_store_unmarked_cell(Badge<Cell>, Cell& cell)
+{
+    // Cells that haven't been swept since the last full collection are still marked, but that's fine.
+    if (!m_is_marking)
+        return;
+    MarkingVisitor visitor(m_mark_stack, m_marked_cells);
+    visitor.visit(&cell);
+}
+
+void Heap::did_store_unknown_cells(Badge<Cell>, Cell& cell)
+{
+    // The cell has already been marked, so put it back on the mark stack to have its edges visited again.
+    if (m_is_marking)
+        m_mark_stack.append(&cell);
+}
+
+void Heap::dump_statistics() const
+{
+    auto average_pause = m_statistics.pauses ? m_statistics.total_pause_time.to_microseconds() / (i64)m_statistics.pauses : 0;
+    outln("Garbage collection timing report");
+    outln("=============================================");
+    outln("          Young collections: {}", m_statistics.young_collections);
+    outln("           Full collections: {}", m_statistics.full_collections);
+    outln("  Incremental marking steps: {}", m_statistics.marking_steps);
+    outln("        Lazily swept blocks: {} ({} us)", m_statistics.lazily_swept_blocks, m_statistics.lazy_sweeping_time.to_microseconds());
+    outln("                     Pauses: {}", m_statistics.pauses);
+    outln("           Total pause time: {} us", m_statistics.total_pause_time.to_microseconds());
+    outln("         Average pause time: {} us", average_pause);
+    outln("         Longest pause time: {} us", m_statistics.longest_pause.to_microseconds());
+    outln(" Pauses longer than a frame: {}", m_statistics.pauses_longer_than_a_frame);
+    outln("=============================================");
+}
+
 void Heap::defer_gc(Badge<DeferGC>)
 {
     ++m_gc_deferrals;
@@ -302,7 +610,7 @@ void Heap::undefer_gc(Badge<DeferGC>)
 
     if (!m_gc_deferrals) {
         if (m_should_gc_when_deferral_ends)
-            collect_garbage();
+            collect_garbage(CollectionType::CollectYoungGeneration);
         m_should_gc_when_deferral_ends = false;
     }
 }
@@ -29,6 +29,7 @@
 #include <AK/HashTable.h>
 #include <AK/Noncopyable.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/Time.h>
 #include <AK/Types.h>
 #include <AK/Vector.h>
 #include <LibCore/Forward.h>
@@ -72,7 +73,10 @@ public:
     }
 
     enum class CollectionType {
+        // Marks and sweeps the whole heap before returning.
         CollectGarbage,
+        // Collects the young generation, or does a time-bounded step of an ongoing full collection.
+        CollectYoungGeneration,
         CollectEverything,
     };
 
@@ -89,16 +93,41 @@ public:
     void did_create_marked_value_list(Badge<MarkedValueList>, MarkedValueList&);
     void did_destroy_marked_value_list(Badge<MarkedValueList>, MarkedValueList&);
 
+    // Bumped whenever a sweep frees cells, so caches holding raw cell pointers can tell when an address may have been reused.
+    size_t sweep_count() const { return m_sweep_count; }
+
+    void add_to_remembered_set(Badge<Cell>, Cell&);
+    void did_store_unmarked_cell(Badge<Cell>, Cell&);
+    void did_store_unknown_cells(Badge<Cell>, Cell&);
+
+    void dump_statistics() const;
+
     void defer_gc(Badge<DeferGC>);
     void undefer_gc(Badge<DeferGC>);
 
 private:
     Cell* allocate_cell(size_t);
 
+    struct SweepStatistics {
+        size_t live_cells { 0 };
+        size_t live_cell_bytes { 0 };
+        size_t collected_cells { 0 };
+        size_t collected_cell_bytes { 0 };
+        size_t freed_blocks { 0 };
+    };
+
     void gather_roots(HashTable<Cell*>&);
     void gather_conservative_roots(HashTable<Cell*>&);
-    void mark_live_cells(const HashTable<Cell*>& live_cells);
-    void sweep_dead_cells(bool print_report, const Core::ElapsedTimer&);
+    void start_incremental_marking();
+    bool perform_incremental_marking_step(const Time& deadline);
+    void finish_incremental_marking();
+    void mark_live_young_cells(const HashTable<Cell*>& roots);
+    void sweep_dead_young_cells(bool print_report, const Time& start_time);
+    void sweep_block(HeapBlock&, SweepStatistics&);
+    bool sweep_blocks_pending_sweep(const Time& deadline, SweepStatistics&);
+    void sweep_blocks_pending_sweep_until_usable(Allocator&);
+    void sweep_dead_cells(bool print_report, const Time& start_time);
+    void promote(Cell&);
 
     Allocator& allocator_for_size(size_t);
 
@@ -112,8 +141,43 @@ private:
     }
 
     size_t m_max_allocations_between_gc { 10000 };
+
+    // How long a single step of an incremental collection may keep the mutator waiting.
+    // Pauses are meant to stay well below one frame at 60 Hz.
+    static constexpr i64 incremental_step_budget_in_microseconds = 1000;
+    static constexpr i64 frame_time_in_microseconds = 16667;
     size_t m_allocations_since_last_gc { 0 };
 
+    // Full collections happen once the old generation has grown by this many cells
+    // since the last one, or by as many cells as survived it, whichever is more.
+    static constexpr size_t min_promotions_between_full_gc = 100000;
+    size_t m_max_promotions_between_full_gc { min_promotions_between_full_gc };
+    size_t m_promotions_since_last_full_gc { 0 };
+
+    // Every cell allocated since the last collection, in allocation order.
+    Vector<Cell*> m_young_cells;
+
+    // Old cells that may point to young ones.
+    Vector<Cell*> m_remembered_set;
+
+    // Cells that have been marked but whose edges have not been visited yet.
+    Vector<Cell*> m_mark_stack;
+    bool m_is_marking { false };
+    size_t m_marked_cells { 0 };
+
+    struct Statistics {
+        size_t young_collections { 0 };
+        size_t full_collections { 0 };
+        size_t marking_steps { 0 };
+        size_t lazily_swept_blocks { 0 };
+        Time lazy_sweeping_time;
+        size_t pauses { 0 };
+        size_t pauses_longer_than_a_frame { 0 };
+        Time total_pause_time;
+        Time longest_pause;
+    };
+    Statistics m_statistics;
+
     bool m_should_collect_on_every_allocation { false };
 
     VM& m_vm;
@@ -127,6 +191,8 @@ private:
     bool m_should_gc_when_deferral_ends { false };
 
     bool m_collecting_garbage { false };
+
+    size_t m_sweep_count { 0 };
 };
 
 }
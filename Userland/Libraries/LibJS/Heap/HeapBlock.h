@@ -45,14 +45,18 @@ public:
 
     size_t cell_size() const { return m_cell_size; }
     size_t cell_count() const { return (block_size - sizeof(HeapBlock)) / m_cell_size; }
-    bool is_full() const { return !m_freelist; }
+    bool is_full() const { return !m_freelist && !has_lazy_freelist(); }
 
     ALWAYS_INLINE Cell* allocate()
     {
-        if (!m_freelist)
-            return nullptr;
-        VERIFY(is_valid_cell_pointer(m_freelist));
-        return exchange(m_freelist, m_freelist->next);
+        if (m_freelist) {
+            VERIFY(is_valid_cell_pointer(m_freelist));
+            return exchange(m_freelist, m_freelist->next);
+        }
+        // Cells that have never been handed out are bump-allocated in address order.
+        if (has_lazy_freelist())
+            return cell(m_next_lazy_freelist_index++);
+        return nullptr;
     }
 
     void deallocate(Cell*);
@@ -60,7 +64,7 @@ public:
     template<typename Callback>
     void for_each_cell(Callback callback)
     {
-        for (size_t i = 0; i < cell_count(); ++i)
+        for (size_t i = 0; i < m_next_lazy_freelist_index; ++i)
             callback(cell(i));
     }
 
@@ -76,7 +80,7 @@ public:
         if (pointer < reinterpret_cast<FlatPtr>(m_storage))
             return nullptr;
         size_t cell_index = (pointer - reinterpret_cast<FlatPtr>(m_storage)) / m_cell_size;
-        if (cell_index >= cell_count())
+        if (cell_index >= m_next_lazy_freelist_index)
             return nullptr;
         return cell(cell_index);
     }
@@ -102,13 +106,11 @@ private:
         return reinterpret_cast<Cell*>(&m_storage[index * cell_size()]);
     }
 
-    FreelistEntry* init_freelist_entry(size_t index)
-    {
-        return new (&m_storage[index * cell_size()]) FreelistEntry();
-    }
+    bool has_lazy_freelist() const { return m_next_lazy_freelist_index < cell_count(); }
 
     Heap& m_heap;
     size_t m_cell_size { 0 };
+    size_t m_next_lazy_freelist_index { 0 };
     FreelistEntry* m_freelist { nullptr };
     alignas(Cell) u8 m_storage[];
 };
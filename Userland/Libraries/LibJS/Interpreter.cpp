@@ -26,6 +26,7 @@
 
 #include <AK/StringBuilder.h>
 #include <LibJS/AST.h>
+#include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibJS/Runtime/LexicalEnvironment.h>
@@ -73,7 +74,10 @@ void Interpreter::run(GlobalObject& global_object, const Program& program)
     global_call_frame.is_strict_mode = program.is_strict_mode();
     vm.push_call_frame(global_call_frame, global_object);
     VERIFY(!vm.exception());
-    program.execute(*this, global_object);
+    if (vm.should_run_bytecode())
+        execute_bytecode(global_object, program);
+    else
+        program.execute(*this, global_object);
     vm.pop_call_frame();
 
     // Whatever the promise jobs do should not affect the effective 'last value'.
@@ -104,25 +108,19 @@ void Interpreter::enter_scope(const ScopeNode& scope_node, ScopeType scope_type,
         return;
     }
 
-    HashMap<FlyString, Variable> scope_variables_with_declaration_kind;
-    scope_variables_with_declaration_kind.ensure_capacity(16);
-
-    for (auto& declaration : scope_node.variables()) {
-        for (auto& declarator : declaration.declarations()) {
-            if (is<Program>(scope_node)) {
-                global_object.put(declarator.id().string(), js_undefined());
-                if (exception())
-                    return;
-            } else {
-                scope_variables_with_declaration_kind.set(declarator.id().string(), { js_undefined(), declaration.declaration_kind() });
-            }
+    bool is_program = is<Program>(scope_node);
+    if (is_program) {
+        for (auto& binding : scope_node.bindings()) {
+            global_object.put(binding.name, js_undefined());
+            if (exception())
+                return;
         }
     }
 
     bool pushed_lexical_environment = false;
 
-    if (!scope_variables_with_declaration_kind.is_empty()) {
-        auto* block_lexical_environment = heap().allocate<LexicalEnvironment>(global_object, move(scope_variables_with_declaration_kind), current_scope());
+    if (!is_program && !scope_node.bindings().is_empty()) {
+        auto* block_lexical_environment = heap().allocate<LexicalEnvironment>(global_object, scope_node.bindings(), current_scope());
         vm().call_frame().scope = block_lexical_environment;
         pushed_lexical_environment = true;
     }
@@ -183,6 +181,32 @@ Value Interpreter::execute_statement(GlobalObject& global_object, const Statemen
     return vm().last_value();
 }
 
+Value Interpreter::execute_bytecode(GlobalObject& global_object, const ScopeNode& scope_node, ScopeType scope_type)
+{
+    bool is_first_run = !scope_node.has_bytecode_executable();
+    auto& executable = scope_node.bytecode_executable();
+    if (is_first_run && vm().should_dump_bytecode())
+        executable.dump();
+
+    // Bytecode doesn't track the node it's executing, so anything that asks gets the enclosing scope.
+    ExecutingASTNodeChain chain_node { nullptr, scope_node };
+    push_ast_node(chain_node);
+    enter_scope(scope_node, scope_type, global_object);
+
+    Bytecode::Interpreter bytecode_interpreter(*this, global_object, executable);
+    auto result = bytecode_interpreter.run();
+    if (!result.is_empty())
+        vm().set_last_value({}, result);
+
+    if (vm().unwind_until() == scope_type)
+        vm().stop_unwind();
+
+    exit_scope(scope_node);
+    pop_ast_node();
+
+    return result;
+}
+
 LexicalEnvironment* Interpreter::current_environment()
 {
     VERIFY(is<LexicalEnvironment>(vm().call_frame().scope));
@@ -99,6 +99,7 @@ public:
     const ExecutingASTNodeChain* executing_ast_node_chain() const { return m_ast_node_chain; }
 
     Value execute_statement(GlobalObject&, const Statement&, ScopeType = ScopeType::Block);
+    Value execute_bytecode(GlobalObject&, const ScopeNode&, ScopeType = ScopeType::Block);
 
 private:
     explicit Interpreter(VM&);
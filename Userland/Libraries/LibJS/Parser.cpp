@@ -29,6 +29,7 @@
 #include <AK/ScopeGuard.h>
 #include <AK/StdLibExtras.h>
 #include <AK/TemporaryChange.h>
+#include <LibJS/ScopeAnalysis.h>
 #include <ctype.h>
 
 namespace JS {
@@ -279,6 +280,7 @@ NonnullRefPtr<Program> Parser::parse_program()
         syntax_error("Unclosed scope");
     }
     program->source_range().end = position();
+    ScopeAnalysis::analyze(*program);
     return program;
 }
 
@@ -46,10 +46,18 @@ public:
     }
 
     Function* getter() const { return m_getter; }
-    void set_getter(Function* getter) { m_getter = getter; }
+    void set_getter(Function* getter)
+    {
+        m_getter = getter;
+        write_barrier(getter);
+    }
 
     Function* setter() const { return m_setter; }
-    void set_setter(Function* setter) { m_setter = setter; }
+    void set_setter(Function* setter)
+    {
+        m_setter = setter;
+        write_barrier(setter);
+    }
 
     Value call_getter(Value this_value)
     {
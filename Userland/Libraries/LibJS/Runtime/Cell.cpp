@@ -27,10 +27,26 @@
 #include <LibJS/Heap/Heap.h>
 #include <LibJS/Heap/HeapBlock.h>
 #include <LibJS/Runtime/Cell.h>
+#include <LibJS/Runtime/VM.h>
 #include <LibJS/Runtime/Value.h>
 
 namespace JS {
 
+void Cell::add_to_remembered_set()
+{
+    heap().add_to_remembered_set({}, *this);
+}
+
+void Cell::did_store_unmarked_cell(Cell& cell)
+{
+    heap().did_store_unmarked_cell({}, cell);
+}
+
+void Cell::did_store_unknown_cells()
+{
+    heap().did_store_unknown_cells({}, *this);
+}
+
 void Cell::Visitor::visit(Cell* cell)
 {
     if (cell)
@@ -32,6 +32,7 @@
 #include <AK/String.h>
 #include <AK/TypeCasts.h>
 #include <LibJS/Forward.h>
+#include <LibJS/Runtime/Value.h>
 
 namespace JS {
 
@@ -49,6 +50,46 @@ public:
     bool is_live() const { return m_live; }
     void set_live(bool b) { m_live = b; }
 
+    // Cells are young until they survive their first collection. Minor collections only
+    // trace young cells, starting from the roots and from old cells in the remembered set.
+    bool is_old() const { return m_old; }
+    void set_old(bool b) { m_old = b; }
+
+    bool is_remembered() const { return m_remembered; }
+    void set_remembered(bool b) { m_remembered = b; }
+
+    // Must be called after storing a reference to another cell in this one.
+    // While the heap is being marked incrementally, it also keeps marked cells from gaining edges to unmarked ones.
+    ALWAYS_INLINE void write_barrier(Cell* cell)
+    {
+        if (!cell)
+            return;
+        if (m_old && !m_remembered && !cell->m_old)
+            add_to_remembered_set();
+        if (m_mark && !cell->m_mark)
+            did_store_unmarked_cell(*cell);
+    }
+
+    ALWAYS_INLINE void write_barrier(Value value)
+    {
+        if (value.is_cell())
+            write_barrier(value.as_cell());
+    }
+
+    // For stores we can't see, e.g. through a mutable reference handed out to someone else.
+    ALWAYS_INLINE void write_barrier()
+    {
+        if (m_old && !m_remembered)
+            add_to_remembered_set();
+        if (m_mark)
+            did_store_unknown_cells();
+    }
+
+    // Cells that store references to other cells without a write barrier must return true here.
+    // They are kept in the remembered set for as long as they are old, and are marked again
+    // at the end of every incremental marking cycle.
+    virtual bool is_always_remembered() const { return false; }
+
     virtual const char* class_name() const = 0;
 
     class Visitor {
@@ -70,8 +111,14 @@ protected:
     Cell() { }
 
 private:
+    void add_to_remembered_set();
+    void did_store_unmarked_cell(Cell&);
+    void did_store_unknown_cells();
+
     bool m_mark { false };
     bool m_live { true };
+    bool m_old { false };
+    bool m_remembered { false };
 };
 
 }
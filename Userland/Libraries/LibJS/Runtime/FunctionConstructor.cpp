@@ -31,6 +31,7 @@
 #include <LibJS/Runtime/Error.h>
 #include <LibJS/Runtime/FunctionConstructor.h>
 #include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/ScopeAnalysis.h>
 
 namespace JS {
 
@@ -88,6 +89,7 @@ Value FunctionConstructor::construct(Function&)
         vm.throw_exception<SyntaxError>(global_object(), error.to_string());
         return {};
     }
+    ScopeAnalysis::analyze(*function_expression);
 
     OwnPtr<Interpreter> local_interpreter;
     Interpreter* interpreter = vm.interpreter_if_exists();
@@ -70,6 +70,9 @@ public:
 protected:
     virtual void visit_edges(Visitor&) override;
 
+    // The constructors, prototypes and shapes are stored without write barriers.
+    virtual bool is_always_remembered() const override { return true; }
+
     template<typename ConstructorType>
     void initialize_constructor(const FlyString& property_name, ConstructorType*&, Object* prototype);
     template<typename ConstructorType>
@@ -27,6 +27,7 @@
 #include <AK/QuickSort.h>
 #include <LibJS/Runtime/Accessor.h>
 #include <LibJS/Runtime/IndexedProperties.h>
+#include <LibJS/Runtime/Object.h>
 
 namespace JS {
 
@@ -268,6 +269,7 @@ void IndexedProperties::put(Object* this_object, u32 index, Value value, Propert
 
     if (m_storage->is_simple_storage() || !evaluate_accessors) {
         m_storage->put(index, value, attributes);
+        m_owner->write_barrier(value);
         return;
     }
 
@@ -277,6 +279,7 @@ void IndexedProperties::put(Object* this_object, u32 index, Value value, Propert
         value_here.value().value.as_accessor().call_setter(this_object, value);
     } else {
         m_storage->put(index, value, attributes);
+        m_owner->write_barrier(value);
     }
 }
 
@@ -300,6 +303,7 @@ void IndexedProperties::insert(u32 index, Value value, PropertyAttributes attrib
         }
     }
     m_storage->insert(index, value, attributes);
+    m_owner->write_barrier(value);
 }
 
 ValueAndAttributes IndexedProperties::take_first(Object* this_object)
@@ -328,6 +332,7 @@ void IndexedProperties::append_all(Object* this_object, const IndexedProperties&
         if (this_object && this_object->vm().exception())
             return;
         m_storage->put(m_storage->array_like_size(), element.value, element.attributes);
+        m_owner->write_barrier(element.value);
     }
 }
 
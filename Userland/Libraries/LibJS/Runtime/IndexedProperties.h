@@ -136,10 +136,14 @@ private:
 
 class IndexedProperties {
 public:
-    IndexedProperties() = default;
+    explicit IndexedProperties(Object& owner)
+        : m_owner(&owner)
+    {
+    }
 
-    explicit IndexedProperties(Vector<Value> values)
-        : m_storage(make<SimpleIndexedPropertyStorage>(move(values)))
+    IndexedProperties(Object& owner, Vector<Value> values)
+        : m_owner(&owner)
+        , m_storage(make<SimpleIndexedPropertyStorage>(move(values)))
     {
     }
 
@@ -179,6 +183,8 @@ public:
 private:
     void switch_to_generic_storage();
 
+    // The object we belong to, which needs a write barrier whenever we store a value.
+    Object* m_owner { nullptr };
     NonnullOwnPtr<IndexedPropertyStorage> m_storage { make<SimpleIndexedPropertyStorage>() };
 };
 
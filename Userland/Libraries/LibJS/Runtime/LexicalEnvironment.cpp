@@ -44,17 +44,18 @@ LexicalEnvironment::LexicalEnvironment(EnvironmentRecordType environment_record_
 {
 }
 
-LexicalEnvironment::LexicalEnvironment(HashMap<FlyString, Variable> variables, ScopeObject* parent_scope)
-    : ScopeObject(parent_scope)
-    , m_variables(move(variables))
+LexicalEnvironment::LexicalEnvironment(const Vector<Binding>& bindings, ScopeObject* parent_scope)
+    : LexicalEnvironment(bindings, parent_scope, EnvironmentRecordType::Declarative)
 {
 }
 
-LexicalEnvironment::LexicalEnvironment(HashMap<FlyString, Variable> variables, ScopeObject* parent_scope, EnvironmentRecordType environment_record_type)
+LexicalEnvironment::LexicalEnvironment(const Vector<Binding>& bindings, ScopeObject* parent_scope, EnvironmentRecordType environment_record_type)
     : ScopeObject(parent_scope)
     , m_environment_record_type(environment_record_type)
-    , m_variables(move(variables))
 {
+    m_slots.ensure_capacity(bindings.size());
+    for (auto& binding : bindings)
+        m_slots.unchecked_append({ binding.name, { js_undefined(), binding.declaration_kind } });
 }
 
 LexicalEnvironment::~LexicalEnvironment()
@@ -68,18 +69,30 @@ void LexicalEnvironment::visit_edges(Visitor& visitor)
     visitor.visit(m_home_object);
     visitor.visit(m_new_target);
     visitor.visit(m_current_function);
-    for (auto& it : m_variables)
-        visitor.visit(it.value.value);
+    for (auto& slot : m_slots)
+        visitor.visit(slot.variable.value);
 }
 
 Optional<Variable> LexicalEnvironment::get_from_scope(const FlyString& name) const
 {
-    return m_variables.get(name);
+    for (auto& slot : m_slots) {
+        if (slot.name == name)
+            return slot.variable;
+    }
+    return {};
 }
 
 void LexicalEnvironment::put_to_scope(const FlyString& name, Variable variable)
 {
-    m_variables.set(name, variable);
+    for (auto& slot : m_slots) {
+        if (slot.name == name) {
+            slot.variable = variable;
+            write_barrier(variable.value);
+            return;
+        }
+    }
+    m_slots.append({ name, variable });
+    write_barrier(variable.value);
 }
 
 bool LexicalEnvironment::has_super_binding() const
@@ -128,7 +141,14 @@ void LexicalEnvironment::bind_this_value(GlobalObject& global_object, Value this
         return;
     }
     m_this_value = this_value;
+    write_barrier(this_value);
     m_this_binding_status = ThisBindingStatus::Initialized;
 }
 
+void LexicalEnvironment::set_current_function(Function& function)
+{
+    m_current_function = &function;
+    write_barrier(&function);
+}
+
 }
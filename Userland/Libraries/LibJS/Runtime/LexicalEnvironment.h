@@ -27,7 +27,7 @@
 #pragma once
 
 #include <AK/FlyString.h>
-#include <AK/HashMap.h>
+#include <AK/Vector.h>
 #include <LibJS/Runtime/ScopeObject.h>
 #include <LibJS/Runtime/Value.h>
 
@@ -52,8 +52,8 @@ public:
 
     LexicalEnvironment();
     LexicalEnvironment(EnvironmentRecordType);
-    LexicalEnvironment(HashMap<FlyString, Variable> variables, ScopeObject* parent_scope);
-    LexicalEnvironment(HashMap<FlyString, Variable> variables, ScopeObject* parent_scope, EnvironmentRecordType);
+    LexicalEnvironment(const Vector<Binding>& bindings, ScopeObject* parent_scope);
+    LexicalEnvironment(const Vector<Binding>& bindings, ScopeObject* parent_scope, EnvironmentRecordType);
     virtual ~LexicalEnvironment() override;
 
     // ^ScopeObject
@@ -64,9 +64,22 @@ public:
 
     void clear();
 
-    const HashMap<FlyString, Variable>& variables() const { return m_variables; }
-
-    void set_home_object(Value object) { m_home_object = object; }
+    // Slot access for identifiers resolved by ScopeAnalysis. Slots are laid out in
+    // the order of the bindings we were created with; put_to_scope() may append more.
+    size_t slot_count() const { return m_slots.size(); }
+    const FlyString& slot_name(size_t index) const { return m_slots[index].name; }
+    const Variable& slot(size_t index) const { return m_slots[index].variable; }
+    void set_slot_value(size_t index, Value value)
+    {
+        m_slots[index].variable.value = value;
+        write_barrier(value);
+    }
+
+    void set_home_object(Value object)
+    {
+        m_home_object = object;
+        write_barrier(object);
+    }
     bool has_super_binding() const;
     Value get_super_base();
 
@@ -74,22 +87,36 @@ public:
     void bind_this_value(GlobalObject&, Value this_value);
 
     // Not a standard operation.
-    void replace_this_binding(Value this_value) { m_this_value = this_value; }
+    void replace_this_binding(Value this_value)
+    {
+        m_this_value = this_value;
+        write_barrier(this_value);
+    }
 
     Value new_target() const { return m_new_target; };
-    void set_new_target(Value new_target) { m_new_target = new_target; }
+    void set_new_target(Value new_target)
+    {
+        m_new_target = new_target;
+        write_barrier(new_target);
+    }
 
     Function* current_function() const { return m_current_function; }
-    void set_current_function(Function& function) { m_current_function = &function; }
+    void set_current_function(Function& function);
 
     EnvironmentRecordType type() const { return m_environment_record_type; }
 
 private:
+    virtual bool is_lexical_environment() const final { return true; }
     virtual void visit_edges(Visitor&) override;
 
+    struct Slot {
+        FlyString name;
+        Variable variable;
+    };
+
     EnvironmentRecordType m_environment_record_type : 8 { EnvironmentRecordType::Declarative };
     ThisBindingStatus m_this_binding_status : 8 { ThisBindingStatus::Uninitialized };
-    HashMap<FlyString, Variable> m_variables;
+    Vector<Slot> m_slots;
     Value m_home_object;
     Value m_this_value;
     Value m_new_target;
@@ -97,4 +124,7 @@ private:
     Function* m_current_function { nullptr };
 };
 
+template<>
+inline bool Object::fast_is<LexicalEnvironment>() const { return is_lexical_environment(); }
+
 }
@@ -92,11 +92,14 @@ Object::Object(GlobalObjectTag)
 {
     // This is the global object
     m_shape = heap().allocate_without_global_object<Shape>(*this);
+    write_barrier(m_shape);
 }
 
 Object::Object(ConstructWithoutPrototypeTag, GlobalObject& global_object)
 {
+    // The allocation may have collected garbage and promoted us, since we're already on the stack.
     m_shape = heap().allocate_without_global_object<Shape>(global_object);
+    write_barrier(m_shape);
 }
 
 Object::Object(Object& prototype)
@@ -140,6 +143,7 @@ bool Object::set_prototype(Object* new_prototype)
         return true;
     }
     m_shape = m_shape->create_prototype_transition(new_prototype);
+    write_barrier(m_shape);
     return true;
 }
 
@@ -437,6 +441,7 @@ void Object::set_shape(Shape& new_shape)
 {
     m_storage.resize(new_shape.property_count());
     m_shape = &new_shape;
+    write_barrier(m_shape);
 }
 
 bool Object::define_property(const StringOrSymbol& property_name, const Object& descriptor, bool throw_exceptions)
@@ -583,6 +588,7 @@ bool Object::put_own_property(const StringOrSymbol& property_name, Value value,
         m_shape->add_property_without_transition(property_name, attributes);
         m_storage.resize(m_shape->property_count());
         m_storage[m_shape->property_count() - 1] = value;
+        write_barrier(value);
         return true;
     }
 
@@ -655,6 +661,7 @@ bool Object::put_own_property(const StringOrSymbol& property_name, Value value,
         call_native_property_setter(value_here.as_native_property(), this, value);
     } else {
         m_storage[metadata.value().offset] = value;
+        write_barrier(value);
     }
     return true;
 }
@@ -747,6 +754,7 @@ void Object::ensure_shape_is_unique()
         return;
 
     m_shape = m_shape->create_unique_clone();
+    write_barrier(m_shape);
 }
 
 Value Object::get_by_index(u32 property_index) const
@@ -859,6 +867,7 @@ bool Object::put(const PropertyName& property_name, Value value, Value receiver)
 
     // If there's a setter in the prototype chain, we go to the setter.
     // Otherwise, it goes in the own property storage.
+    // A data property found on the way shadows any setters further up the chain.
     Object* object = this;
     while (object) {
         auto metadata = object->shape().lookup(string_or_symbol);
@@ -872,6 +881,7 @@ bool Object::put(const PropertyName& property_name, Value value, Value receiver)
                 call_native_property_setter(value_here.as_native_property(), receiver, value);
                 return true;
             }
+            break;
         }
         object = object->prototype();
         if (vm().exception())
@@ -68,6 +68,9 @@ public:
 private:
     virtual void visit_edges(Visitor&) override;
 
+    // The result and reactions are stored without write barriers.
+    virtual bool is_always_remembered() const override { return true; }
+
     bool is_settled() const { return m_state == State::Fulfilled || m_state == State::Rejected; }
 
     void trigger_reactions() const;
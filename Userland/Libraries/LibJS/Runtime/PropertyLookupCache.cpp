@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/Heap/Heap.h>
+#include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/PropertyLookupCache.h>
+#include <LibJS/Runtime/Shape.h>
+#include <LibJS/Runtime/VM.h>
+
+namespace JS {
+
+ALWAYS_INLINE const PropertyLookupCache::Entry* PropertyLookupCache::find(VM& vm, const Object& object) const
+{
+    if (m_sweep_count != vm.heap().sweep_count()) {
+        m_entries = {};
+        m_sweep_count = vm.heap().sweep_count();
+        return nullptr;
+    }
+    auto* shape = &object.shape();
+    for (auto& entry : m_entries) {
+        if (entry.shape == shape)
+            return &entry;
+    }
+    return nullptr;
+}
+
+Optional<Value> PropertyLookupCache::get(VM& vm, const Object& object) const
+{
+    auto* entry = find(vm, object);
+    if (!entry)
+        return {};
+    auto value = object.get_direct(entry->offset);
+    // The shape doesn't tell data properties apart from accessors without a getter or setter.
+    if (value.is_empty() || value.is_accessor() || value.is_native_property())
+        return {};
+    return value;
+}
+
+bool PropertyLookupCache::put(VM& vm, Object& object, Value value)
+{
+    auto* entry = find(vm, object);
+    if (!entry || !entry->is_writable)
+        return false;
+    auto value_here = object.get_direct(entry->offset);
+    if (value_here.is_accessor() || value_here.is_native_property())
+        return false;
+    object.put_direct(entry->offset, value);
+    return true;
+}
+
+void PropertyLookupCache::update(VM& vm, const Object& object, const PropertyName& property_name)
+{
+    if (!property_name.is_string() && !property_name.is_symbol())
+        return;
+    if (object.overrides_property_access())
+        return;
+    auto& shape = object.shape();
+    if (shape.is_unique())
+        return;
+    auto metadata = shape.lookup(property_name.to_string_or_symbol());
+    if (!metadata.has_value())
+        return;
+    auto value = object.get_direct(metadata.value().offset);
+    if (value.is_empty() || value.is_accessor() || value.is_native_property())
+        return;
+
+    if (m_sweep_count != vm.heap().sweep_count()) {
+        m_entries = {};
+        m_sweep_count = vm.heap().sweep_count();
+    }
+    for (auto& entry : m_entries) {
+        if (entry.shape == &shape)
+            return;
+    }
+    m_entries[m_next_entry] = { &shape, static_cast<u32>(metadata.value().offset), metadata.value().attributes.is_writable() };
+    m_next_entry = (m_next_entry + 1) % max_entries;
+}
+
+}
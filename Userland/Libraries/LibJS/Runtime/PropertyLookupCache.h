@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Optional.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS {
+
+// An inline cache for a single named property access site (e.g `o.x` or `o.x = y`).
+// It remembers where the property lives in the storage of objects with a given Shape,
+// so a repeat access on the same shape is a pointer comparison and an indexed load.
+// Only own data properties of ordinary objects with non-unique shapes are cached.
+class PropertyLookupCache {
+public:
+    static constexpr size_t max_entries = 4;
+
+    Optional<Value> get(VM&, const Object&) const;
+    bool put(VM&, Object&, Value);
+
+    void update(VM&, const Object&, const PropertyName&);
+
+private:
+    struct Entry {
+        const Shape* shape { nullptr };
+        u32 offset { 0 };
+        bool is_writable { false };
+    };
+
+    const Entry* find(VM&, const Object&) const;
+
+    // Cached shapes are not kept alive, so the entries are only trusted
+    // as long as no cell has been freed since they were recorded.
+    mutable size_t m_sweep_count { 0 };
+    mutable AK::Array<Entry, max_entries> m_entries;
+    size_t m_next_entry { 0 };
+};
+
+}
@@ -66,6 +66,7 @@ private:
 
     virtual bool is_function() const override { return m_target.is_function(); }
     virtual bool is_array() const override { return m_target.is_array(); };
+    virtual bool overrides_property_access() const override { return true; }
 
     Object& m_target;
     Object& m_handler;
@@ -24,8 +24,11 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <LibJS/AST.h>
 #include <LibJS/Runtime/Error.h>
 #include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/LexicalEnvironment.h>
+#include <LibJS/Runtime/PropertyLookupCache.h>
 #include <LibJS/Runtime/Reference.h>
 
 namespace JS {
@@ -40,6 +43,14 @@ void Reference::put(GlobalObject& global_object, Value value)
     }
 
     if (is_local_variable() || is_global_variable()) {
+        if (m_environment) {
+            if (m_environment->slot(m_environment_index).declaration_kind == DeclarationKind::Const) {
+                vm.throw_exception<TypeError>(global_object, ErrorType::InvalidAssignToConst);
+                return;
+            }
+            m_environment->set_slot_value(m_environment_index, value);
+            return;
+        }
         if (is_local_variable())
             vm.set_variable(m_name.to_string(), value, global_object);
         else
@@ -67,6 +78,15 @@ void Reference::put(GlobalObject& global_object, Value value)
     if (!object)
         return;
 
+    if (m_lookup_cache) {
+        if (m_lookup_cache->put(vm, *object, value))
+            return;
+        object->put(m_name, value);
+        if (!vm.exception())
+            m_lookup_cache->update(vm, *object, m_name);
+        return;
+    }
+
     object->put(m_name, value);
 }
 
@@ -90,7 +110,9 @@ Value Reference::get(GlobalObject& global_object)
 
     if (is_local_variable() || is_global_variable()) {
         Value value;
-        if (is_local_variable())
+        if (m_environment)
+            value = m_environment->slot(m_environment_index).value;
+        else if (is_local_variable())
             value = vm.get_variable(m_name.to_string(), global_object);
         else
             value = global_object.get(m_name);
@@ -115,6 +137,15 @@ Value Reference::get(GlobalObject& global_object)
     if (!object)
         return {};
 
+    if (m_lookup_cache) {
+        if (auto cached_value = m_lookup_cache->get(vm, *object); cached_value.has_value())
+            return cached_value.value();
+        auto value = object->get(m_name).value_or(js_undefined());
+        if (!vm.exception())
+            m_lookup_cache->update(vm, *object, m_name);
+        return value;
+    }
+
     return object->get(m_name).value_or(js_undefined());
 }
 
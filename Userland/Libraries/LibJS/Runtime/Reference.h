@@ -42,6 +42,14 @@ public:
     {
     }
 
+    Reference(Value base, const PropertyName& name, PropertyLookupCache& lookup_cache, bool strict = false)
+        : m_base(base)
+        , m_name(name)
+        , m_strict(strict)
+        , m_lookup_cache(&lookup_cache)
+    {
+    }
+
     enum LocalVariableTag { LocalVariable };
     Reference(LocalVariableTag, const FlyString& name, bool strict = false)
         : m_base(js_null())
@@ -51,6 +59,17 @@ public:
     {
     }
 
+    // A local variable whose slot in the environment is already known.
+    Reference(LocalVariableTag, LexicalEnvironment& environment, u32 index, const FlyString& name, bool strict = false)
+        : m_base(js_null())
+        , m_name(name)
+        , m_strict(strict)
+        , m_local_variable(true)
+        , m_environment(&environment)
+        , m_environment_index(index)
+    {
+    }
+
     enum GlobalVariableTag { GlobalVariable };
     Reference(GlobalVariableTag, const FlyString& name, bool strict = false)
         : m_base(js_null())
@@ -96,6 +115,9 @@ private:
     bool m_strict { false };
     bool m_local_variable { false };
     bool m_global_variable { false };
+    LexicalEnvironment* m_environment { nullptr };
+    u32 m_environment_index { 0 };
+    PropertyLookupCache* m_lookup_cache { nullptr };
 };
 
 }
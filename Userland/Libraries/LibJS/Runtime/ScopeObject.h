@@ -35,6 +35,19 @@ struct Variable {
     DeclarationKind declaration_kind;
 };
 
+// A name declared by a scope, in the order its environment lays out the slots.
+struct Binding {
+    FlyString name;
+    DeclarationKind declaration_kind;
+};
+
+// Where a statically resolved identifier lives: the number of parent()
+// links to follow from the current scope, and the slot in that environment.
+struct EnvironmentCoordinate {
+    u32 hops { 0 };
+    u32 index { 0 };
+};
+
 class ScopeObject : public Object {
     JS_OBJECT(ScopeObject, Object);
 
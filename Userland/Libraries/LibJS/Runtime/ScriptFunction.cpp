@@ -89,20 +89,11 @@ void ScriptFunction::visit_edges(Visitor& visitor)
 
 LexicalEnvironment* ScriptFunction::create_environment()
 {
-    HashMap<FlyString, Variable> variables;
-    for (auto& parameter : m_parameters) {
-        variables.set(parameter.name, { js_undefined(), DeclarationKind::Var });
-    }
-
-    if (is<ScopeNode>(body())) {
-        for (auto& declaration : static_cast<const ScopeNode&>(body()).variables()) {
-            for (auto& declarator : declaration.declarations()) {
-                variables.set(declarator.id().string(), { js_undefined(), declaration.declaration_kind() });
-            }
-        }
-    }
+    // The body's bindings include our parameters, see FunctionNode.
+    VERIFY(is<ScopeNode>(body()));
+    auto& bindings = static_cast<const ScopeNode&>(body()).bindings();
 
-    auto* environment = heap().allocate<LexicalEnvironment>(global_object(), move(variables), m_parent_scope, LexicalEnvironment::EnvironmentRecordType::Function);
+    auto* environment = heap().allocate<LexicalEnvironment>(global_object(), bindings, m_parent_scope, LexicalEnvironment::EnvironmentRecordType::Function);
     environment->set_home_object(home_object());
     environment->set_current_function(*this);
     if (m_is_arrow_function) {
@@ -147,6 +138,8 @@ Value ScriptFunction::execute_function_body()
         vm.current_scope()->put_to_scope(parameter.name, { argument_value, DeclarationKind::Var });
     }
 
+    if (vm.should_run_bytecode() && is<ScopeNode>(*m_body))
+        return interpreter->execute_bytecode(global_object(), static_cast<const ScopeNode&>(*m_body), ScopeType::Function);
     return interpreter->execute_statement(global_object(), m_body, ScopeType::Function);
 }
 
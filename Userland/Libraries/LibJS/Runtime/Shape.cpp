@@ -50,6 +50,7 @@ Shape* Shape::create_put_transition(const StringOrSymbol& property_name, Propert
         return existing_shape;
     auto* new_shape = heap().allocate_without_global_object<Shape>(*this, property_name, attributes, TransitionType::Put);
     m_forward_transitions.set(key, new_shape);
+    write_barrier(new_shape);
     return new_shape;
 }
 
@@ -60,6 +61,7 @@ Shape* Shape::create_configure_transition(const StringOrSymbol& property_name, P
         return existing_shape;
     auto* new_shape = heap().allocate_without_global_object<Shape>(*this, property_name, attributes, TransitionType::Configure);
     m_forward_transitions.set(key, new_shape);
+    write_barrier(new_shape);
     return new_shape;
 }
 
@@ -192,6 +194,8 @@ void Shape::add_property_to_unique_shape(const StringOrSymbol& property_name, Pr
     VERIFY(!m_property_table->contains(property_name));
     m_property_table->set(property_name, { m_property_table->size(), attributes });
     ++m_property_count;
+    if (property_name.is_symbol())
+        write_barrier(const_cast<Symbol*>(property_name.as_symbol()));
 }
 
 void Shape::reconfigure_property_in_unique_shape(const StringOrSymbol& property_name, PropertyAttributes attributes)
@@ -217,11 +221,19 @@ void Shape::remove_property_from_unique_shape(const StringOrSymbol& property_nam
     }
 }
 
+void Shape::set_prototype_without_transition(Object* new_prototype)
+{
+    m_prototype = new_prototype;
+    write_barrier(new_prototype);
+}
+
 void Shape::add_property_without_transition(const StringOrSymbol& property_name, PropertyAttributes attributes)
 {
     ensure_property_table();
     if (m_property_table->set(property_name, { m_property_count, attributes }) == AK::HashSetResult::InsertedNewEntry)
         ++m_property_count;
+    if (property_name.is_symbol())
+        write_barrier(const_cast<Symbol*>(property_name.as_symbol()));
 }
 
 }
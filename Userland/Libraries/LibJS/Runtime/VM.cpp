@@ -217,6 +217,21 @@ Reference VM::get_reference(const FlyString& name)
     return { Reference::GlobalVariable, name };
 }
 
+LexicalEnvironment* VM::environment_for_binding(const Optional<EnvironmentCoordinate>& coordinate, const FlyString& name)
+{
+    if (!coordinate.has_value() || m_call_stack.is_empty())
+        return nullptr;
+    auto* scope = current_scope();
+    for (u32 i = 0; i < coordinate->hops && scope; ++i)
+        scope = scope->parent();
+    if (!scope || !is<LexicalEnvironment>(*scope))
+        return nullptr;
+    auto& environment = static_cast<LexicalEnvironment&>(*scope);
+    if (coordinate->index >= environment.slot_count() || environment.slot_name(coordinate->index) != name)
+        return nullptr;
+    return &environment;
+}
+
 Value VM::construct(Function& function, Function& new_target, Optional<MarkedValueList> arguments, GlobalObject& global_object)
 {
     CallFrame call_frame;
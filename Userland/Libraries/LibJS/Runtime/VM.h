@@ -77,6 +77,12 @@ public:
     bool should_log_exceptions() const { return m_should_log_exceptions; }
     void set_should_log_exceptions(bool b) { m_should_log_exceptions = b; }
 
+    bool should_run_bytecode() const { return m_should_run_bytecode; }
+    void set_should_run_bytecode(bool b) { m_should_run_bytecode = b; }
+
+    bool should_dump_bytecode() const { return m_should_dump_bytecode; }
+    void set_should_dump_bytecode(bool b) { m_should_dump_bytecode = b; }
+
     Heap& heap() { return m_heap; }
     const Heap& heap() const { return m_heap; }
 
@@ -202,6 +208,11 @@ public:
 
     Reference get_reference(const FlyString& name);
 
+    // Finds the environment holding a binding resolved by ScopeAnalysis. Returns null if there is
+    // no coordinate, or the scope chain isn't shaped the way the analysis expected, in which
+    // case the caller has to look up the name instead.
+    LexicalEnvironment* environment_for_binding(const Optional<EnvironmentCoordinate>&, const FlyString& name);
+
     template<typename T, typename... Args>
     void throw_exception(GlobalObject& global_object, Args&&... args)
     {
@@ -286,6 +297,8 @@ private:
 
     bool m_underscore_is_last_value { false };
     bool m_should_log_exceptions { false };
+    bool m_should_run_bytecode { false };
+    bool m_should_dump_bytecode { false };
 };
 
 template<>
@@ -453,6 +453,8 @@ Object* Value::to_object(GlobalObject& global_object) const
 
 FLATTEN Value Value::to_numeric(GlobalObject& global_object) const
 {
+    if (is_number())
+        return *this;
     auto primitive = to_primitive(global_object, Value::PreferredType::Number);
     if (global_object.vm().exception())
         return {};
@@ -912,6 +914,8 @@ Value add(GlobalObject& global_object, Value lhs, Value rhs)
 
 Value sub(GlobalObject& global_object, Value lhs, Value rhs)
 {
+    if (both_number(lhs, rhs))
+        return Value(lhs.as_double() - rhs.as_double());
     auto lhs_numeric = lhs.to_numeric(global_object);
     if (global_object.vm().exception())
         return {};
@@ -928,6 +932,8 @@ Value sub(GlobalObject& global_object, Value lhs, Value rhs)
 
 Value mul(GlobalObject& global_object, Value lhs, Value rhs)
 {
+    if (both_number(lhs, rhs))
+        return Value(lhs.as_double() * rhs.as_double());
     auto lhs_numeric = lhs.to_numeric(global_object);
     if (global_object.vm().exception())
         return {};
@@ -1228,6 +1234,15 @@ bool abstract_eq(GlobalObject& global_object, Value lhs, Value rhs)
 
 TriState abstract_relation(GlobalObject& global_object, bool left_first, Value lhs, Value rhs)
 {
+    if (both_number(lhs, rhs)) {
+        if (lhs.is_nan() || rhs.is_nan())
+            return TriState::Unknown;
+        // Without left_first, lhs is y and rhs is x, just like in the generic path below.
+        if (left_first)
+            return lhs.as_double() < rhs.as_double() ? TriState::True : TriState::False;
+        return rhs.as_double() < lhs.as_double() ? TriState::True : TriState::False;
+    }
+
     Value x_primitive;
     Value y_primitive;
 
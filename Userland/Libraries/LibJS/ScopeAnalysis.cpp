@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <LibJS/AST.h>
+#include <LibJS/ScopeAnalysis.h>
+
+namespace JS {
+
+void ScopeAnalysis::analyze(const ASTNode& node)
+{
+    ScopeAnalysis analysis;
+    node.analyze_scope(analysis);
+    VERIFY(analysis.m_scopes.is_empty());
+}
+
+void ScopeAnalysis::push_scope(ScopeKind kind, const Vector<Binding>& bindings)
+{
+    m_scopes.append({ kind, bindings, {}, false, {} });
+}
+
+void ScopeAnalysis::pop_scope()
+{
+    auto scope = m_scopes.take_last();
+    for (auto& reference : scope.references) {
+        auto& name = reference.identifier->string();
+
+        bool resolved = false;
+        for (size_t i = 0; i < scope.bindings.size(); ++i) {
+            if (scope.bindings[i].name == name) {
+                reference.identifier->m_environment_coordinate = EnvironmentCoordinate { reference.hops, static_cast<u32>(i) };
+                resolved = true;
+                break;
+            }
+        }
+        if (resolved)
+            continue;
+
+        if (scope.kind != ScopeKind::Declarative || scope.contains_direct_eval || scope.dynamic_bindings.contains(name))
+            continue;
+
+        // Anything that makes it past the outermost environment is a global, or doesn't exist.
+        if (m_scopes.is_empty())
+            continue;
+
+        m_scopes.last().references.append({ reference.identifier, reference.hops + 1 });
+    }
+}
+
+void ScopeAnalysis::add_reference(const Identifier& identifier)
+{
+    if (m_scopes.is_empty())
+        return;
+    // NOTE: The VM handles "arguments" specially, so we always let it look that up by name.
+    if (identifier.string() == "arguments")
+        return;
+    m_scopes.last().references.append({ &identifier, 0 });
+}
+
+void ScopeAnalysis::add_dynamic_binding(const FlyString& name)
+{
+    if (!m_scopes.is_empty())
+        m_scopes.last().dynamic_bindings.set(name);
+}
+
+void ScopeAnalysis::add_direct_eval()
+{
+    // eval() runs in the caller's scope, where it may create bindings (see ClassDeclaration).
+    if (!m_scopes.is_empty())
+        m_scopes.last().contains_direct_eval = true;
+}
+
+void ASTNode::analyze_scope(ScopeAnalysis&) const
+{
+}
+
+void ExpressionStatement::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_expression->analyze_scope(analysis);
+}
+
+void ScopeNode::analyze_scope(ScopeAnalysis& analysis) const
+{
+    // Like Interpreter::enter_scope(): the program's declarations live on the global object,
+    // and blocks only get an environment if they declare something.
+    bool has_environment = !is<Program>(*this) && !m_bindings.is_empty();
+    if (has_environment)
+        analysis.push_scope(ScopeAnalysis::ScopeKind::Declarative, m_bindings);
+    for (auto& child : m_children)
+        child.analyze_scope(analysis);
+    if (has_environment)
+        analysis.pop_scope();
+}
+
+void FunctionNode::analyze_function_scope(ScopeAnalysis& analysis, bool is_hoisted) const
+{
+    VERIFY(is<ScopeNode>(*m_body));
+    auto& body = static_cast<const ScopeNode&>(*m_body);
+
+    analysis.push_scope(is_hoisted ? ScopeAnalysis::ScopeKind::HoistedFunction : ScopeAnalysis::ScopeKind::Declarative, body.bindings());
+    for (auto& parameter : m_parameters) {
+        if (parameter.default_value)
+            parameter.default_value->analyze_scope(analysis);
+    }
+    // The body executes directly in the function's environment, so don't let it push another one.
+    for (auto& child : body.children())
+        child.analyze_scope(analysis);
+    analysis.pop_scope();
+}
+
+void FunctionDeclaration::analyze_scope(ScopeAnalysis& analysis) const
+{
+    analyze_function_scope(analysis, true);
+}
+
+void FunctionExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    analyze_function_scope(analysis, false);
+}
+
+void ReturnStatement::analyze_scope(ScopeAnalysis& analysis) const
+{
+    if (m_argument)
+        m_argument->analyze_scope(analysis);
+}
+
+void IfStatement::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_predicate->analyze_scope(analysis);
+    m_consequent->analyze_scope(analysis);
+    if (m_alternate)
+        m_alternate->analyze_scope(analysis);
+}
+
+void WhileStatement::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_test->analyze_scope(analysis);
+    m_body->analyze_scope(analysis);
+}
+
+void DoWhileStatement::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_test->analyze_scope(analysis);
+    m_body->analyze_scope(analysis);
+}
+
+void WithStatement::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_object->analyze_scope(analysis);
+    analysis.push_scope(ScopeAnalysis::ScopeKind::With);
+    m_body->analyze_scope(analysis);
+    analysis.pop_scope();
+}
+
+void ForStatement::analyze_scope(ScopeAnalysis& analysis) const
+{
+    // Mirrors the block ForStatement::execute() wraps around let and const declarations in the head.
+    RefPtr<BlockStatement> wrapper;
+    if (m_init && is<VariableDeclaration>(*m_init) && static_cast<const VariableDeclaration&>(*m_init).declaration_kind() != DeclarationKind::Var) {
+        wrapper = create_ast_node<BlockStatement>(source_range());
+        NonnullRefPtrVector<VariableDeclaration> declarations;
+        declarations.append(static_cast<const VariableDeclaration&>(*m_init));
+        wrapper->add_variables(declarations);
+        analysis.push_scope(ScopeAnalysis::ScopeKind::Declarative, wrapper->bindings());
+    }
+
+    if (m_init)
+        m_init->analyze_scope(analysis);
+    if (m_test)
+        m_test->analyze_scope(analysis);
+    if (m_update)
+        m_update->analyze_scope(analysis);
+    m_body->analyze_scope(analysis);
+
+    if (wrapper)
+        analysis.pop_scope();
+}
+
+void ForInStatement::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_lhs->analyze_scope(analysis);
+    m_rhs->analyze_scope(analysis);
+    m_body->analyze_scope(analysis);
+}
+
+void ForOfStatement::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_lhs->analyze_scope(analysis);
+    m_rhs->analyze_scope(analysis);
+    m_body->analyze_scope(analysis);
+}
+
+void BinaryExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_lhs->analyze_scope(analysis);
+    m_rhs->analyze_scope(analysis);
+}
+
+void LogicalExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_lhs->analyze_scope(analysis);
+    m_rhs->analyze_scope(analysis);
+}
+
+void UnaryExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_lhs->analyze_scope(analysis);
+}
+
+void SequenceExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    for (auto& expression : m_expressions)
+        expression.analyze_scope(analysis);
+}
+
+void Identifier::analyze_scope(ScopeAnalysis& analysis) const
+{
+    analysis.add_reference(*this);
+}
+
+void ClassMethod::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_key->analyze_scope(analysis);
+    m_function->analyze_scope(analysis);
+}
+
+void ClassExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    if (m_super_class)
+        m_super_class->analyze_scope(analysis);
+    if (m_constructor)
+        m_constructor->analyze_scope(analysis);
+    for (auto& method : m_methods)
+        method.analyze_scope(analysis);
+}
+
+void ClassDeclaration::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_class_expression->analyze_scope(analysis);
+    // The class is put into whatever scope is current when the declaration executes.
+    analysis.add_dynamic_binding(m_class_expression->name());
+}
+
+void SpreadExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_target->analyze_scope(analysis);
+}
+
+void CallExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    if (is<Identifier>(*m_callee) && static_cast<const Identifier&>(*m_callee).string() == "eval")
+        analysis.add_direct_eval();
+    m_callee->analyze_scope(analysis);
+    for (auto& argument : m_arguments)
+        argument.value->analyze_scope(analysis);
+}
+
+void AssignmentExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_lhs->analyze_scope(analysis);
+    m_rhs->analyze_scope(analysis);
+}
+
+void UpdateExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_argument->analyze_scope(analysis);
+}
+
+void VariableDeclarator::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_id->analyze_scope(analysis);
+    if (m_init)
+        m_init->analyze_scope(analysis);
+}
+
+void VariableDeclaration::analyze_scope(ScopeAnalysis& analysis) const
+{
+    for (auto& declarator : m_declarations)
+        declarator.analyze_scope(analysis);
+}
+
+void ObjectProperty::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_key->analyze_scope(analysis);
+    if (m_value)
+        m_value->analyze_scope(analysis);
+}
+
+void ObjectExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    for (auto& property : m_properties)
+        property.analyze_scope(analysis);
+}
+
+void ArrayExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    for (auto& element : m_elements) {
+        if (element)
+            element->analyze_scope(analysis);
+    }
+}
+
+void TemplateLiteral::analyze_scope(ScopeAnalysis& analysis) const
+{
+    for (auto& expression : m_expressions)
+        expression.analyze_scope(analysis);
+}
+
+void TaggedTemplateLiteral::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_tag->analyze_scope(analysis);
+    m_template_literal->analyze_scope(analysis);
+}
+
+void MemberExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_object->analyze_scope(analysis);
+    if (m_computed)
+        m_property->analyze_scope(analysis);
+}
+
+void ConditionalExpression::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_test->analyze_scope(analysis);
+    m_consequent->analyze_scope(analysis);
+    m_alternate->analyze_scope(analysis);
+}
+
+void CatchClause::analyze_scope(ScopeAnalysis& analysis) const
+{
+    analysis.push_scope(ScopeAnalysis::ScopeKind::Declarative, { { m_parameter, DeclarationKind::Var } });
+    m_body->analyze_scope(analysis);
+    analysis.pop_scope();
+}
+
+void TryStatement::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_block->analyze_scope(analysis);
+    if (m_handler)
+        m_handler->analyze_scope(analysis);
+    if (m_finalizer)
+        m_finalizer->analyze_scope(analysis);
+}
+
+void ThrowStatement::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_argument->analyze_scope(analysis);
+}
+
+void SwitchCase::analyze_scope(ScopeAnalysis& analysis) const
+{
+    if (m_test)
+        m_test->analyze_scope(analysis);
+    for (auto& statement : m_consequent)
+        statement.analyze_scope(analysis);
+}
+
+void SwitchStatement::analyze_scope(ScopeAnalysis& analysis) const
+{
+    m_discriminant->analyze_scope(analysis);
+    for (auto& switch_case : m_cases)
+        switch_case.analyze_scope(analysis);
+}
+
+}
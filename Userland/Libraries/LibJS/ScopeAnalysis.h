@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <AK/FlyString.h>
+#include <AK/HashTable.h>
+#include <AK/Vector.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/ScopeObject.h>
+
+namespace JS {
+
+// Resolves identifiers to (hops, index) coordinates in the chain of environments
+// the interpreter will create at runtime, so they can be read and written without
+// looking up their name. This only works because the analysis mirrors exactly
+// which nodes push a LexicalEnvironment and with which bindings; anything that can
+// change a scope behind our back (with statements, direct calls to eval, class
+// declarations) makes the affected names fall back to the lookup by name.
+class ScopeAnalysis {
+public:
+    static void analyze(const ASTNode&);
+
+    enum class ScopeKind {
+        // An environment whose parent is wherever execution currently is.
+        Declarative,
+        // A function declaration's environment. Function declarations get instantiated
+        // once for every enclosing block, so their parent environment isn't fixed.
+        HoistedFunction,
+        // The object of a with statement, which can shadow any name.
+        With,
+    };
+
+    void push_scope(ScopeKind, const Vector<Binding>& = {});
+    void pop_scope();
+
+    void add_reference(const Identifier&);
+    void add_dynamic_binding(const FlyString& name);
+    void add_direct_eval();
+
+private:
+    ScopeAnalysis() { }
+
+    struct PendingReference {
+        const Identifier* identifier { nullptr };
+        u32 hops { 0 };
+    };
+
+    struct Scope {
+        ScopeKind kind;
+        Vector<Binding> bindings;
+        HashTable<FlyString> dynamic_bindings;
+        bool contains_direct_eval { false };
+        Vector<PendingReference> references;
+    };
+
+    Vector<Scope> m_scopes;
+};
+
+}
@@ -0,0 +1,18 @@
+test("marking a very long chain of objects", () => {
+    let head = null;
+    for (let i = 0; i < 300000; ++i) head = { next: head };
+    gc();
+    let length = 0;
+    for (let node = head; node; node = node.next) ++length;
+    expect(length).toBe(300000);
+});
+
+test("objects stored into old objects survive collections", () => {
+    const holder = { items: [] };
+    gc();
+    for (let i = 0; i < 20000; ++i) holder.items.push({ value: i });
+    gc();
+    let sum = 0;
+    for (const item of holder.items) sum += item.value;
+    expect(sum).toBe(199990000);
+});
@@ -0,0 +1,70 @@
+test("same access site sees objects with different shapes", () => {
+    const objects = [{ x: 1 }, { y: 0, x: 2 }, { z: 0, y: 0, x: 3 }, { w: 0, z: 0, y: 0, x: 4 }, { v: 0, x: 5 }];
+    const read = o => o.x;
+    let sum = 0;
+    for (let i = 0; i < 3; ++i) {
+        for (const o of objects) sum += read(o);
+    }
+    expect(sum).toBe(45);
+});
+
+test("property added after the access site was warmed up", () => {
+    const read = o => o.y;
+    const o = { x: 1 };
+    expect(read(o)).toBeUndefined();
+    o.y = 2;
+    expect(read(o)).toBe(2);
+});
+
+test("data property becomes an accessor", () => {
+    const o = { x: 1 };
+    const read = o => o.x;
+    expect(read(o)).toBe(1);
+    Object.defineProperty(o, "x", { get: () => 42 });
+    expect(read(o)).toBe(42);
+});
+
+test("property becomes non-writable", () => {
+    const write = (o, v) => {
+        o.x = v;
+    };
+    const o = { x: 1 };
+    write(o, 2);
+    expect(o.x).toBe(2);
+    Object.freeze(o);
+    write(o, 3);
+    expect(o.x).toBe(2);
+});
+
+test("deleted property", () => {
+    const o = { x: 1, y: 2 };
+    const read = o => o.y;
+    expect(read(o)).toBe(2);
+    delete o.x;
+    expect(read(o)).toBe(2);
+    delete o.y;
+    expect(read(o)).toBeUndefined();
+});
+
+test("own data property shadows a setter on the prototype", () => {
+    let setterCalls = 0;
+    const prototype = {
+        set x(value) {
+            ++setterCalls;
+        },
+    };
+    const o = Object.create(prototype);
+    Object.defineProperty(o, "x", { value: 1, writable: true });
+    o.x = 2;
+    expect(o.x).toBe(2);
+    expect(setterCalls).toBe(0);
+});
+
+test("proxy objects are not cached", () => {
+    const read = o => o.x;
+    const target = { x: 1 };
+    const proxy = new Proxy(target, { get: () => 2 });
+    expect(read(target)).toBe(1);
+    expect(read(proxy)).toBe(2);
+    expect(read(target)).toBe(1);
+});
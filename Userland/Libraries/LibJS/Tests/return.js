@@ -51,3 +51,13 @@ describe("returning from loops", () => {
         expect(foo()).toBe(10);
     });
 });
+
+test("returning from a with statement", () => {
+    function foo() {
+        with ({ a: 10 }) {
+            return a;
+        }
+    }
+
+    expect(foo()).toBe(10);
+});
@@ -0,0 +1,53 @@
+test("closures see the enclosing function's variables", () => {
+    function counter(step) {
+        let count = 0;
+        {
+            let unrelated = 1;
+            return () => {
+                count += step * unrelated;
+                return count;
+            };
+        }
+    }
+    const increment = counter(2);
+    increment();
+    expect(increment()).toBe(4);
+});
+
+test("catch parameter shadows the enclosing variable", () => {
+    let e = "outer";
+    try {
+        throw "inner";
+    } catch (e) {
+        expect(e).toBe("inner");
+    }
+    expect(e).toBe("outer");
+});
+
+test("with statement object shadows a local variable", () => {
+    let foo = 1;
+    const object = { foo: 2 };
+    with (object) {
+        expect(foo).toBe(2);
+        foo = 3;
+    }
+    expect(foo).toBe(1);
+    expect(object.foo).toBe(3);
+});
+
+test("eval can add a class to the calling scope", () => {
+    let value = 1;
+    {
+        eval("class Foo { static bar() { return 42; } }");
+        expect(Foo.bar()).toBe(42);
+    }
+    expect(value).toBe(1);
+});
+
+test("assignment to a const local throws", () => {
+    const foo = 1;
+    expect(() => {
+        foo = 2;
+    }).toThrowWithMessage(TypeError, "Invalid assignment to const variable");
+    expect(foo).toBe(1);
+});
@@ -795,6 +795,11 @@ public:
     virtual bool put(const JS::PropertyName&, JS::Value, JS::Value receiver = {}) override;
 )~~~");
     }
+    if (interface.extended_attributes.contains("CustomGet") || interface.extended_attributes.contains("CustomPut")) {
+        generator.append(R"~~~(
+    virtual bool overrides_property_access() const override { return true; }
+)~~~");
+    }
 
     if (interface.wrapper_base_class == "Wrapper") {
         generator.append(R"~~~(
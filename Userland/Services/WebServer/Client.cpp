@@ -34,10 +34,11 @@
 #include <LibCore/DateTime.h>
 #include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
-#include <LibCore/FileStream.h>
 #include <LibCore/MimeData.h>
 #include <LibHTTP/HttpRequest.h>
+#include <errno.h>
 #include <stdio.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
@@ -127,12 +128,10 @@ void Client::handle_request(ReadonlyBytes raw_request)
         return;
     }
 
-    Core::InputFileStream stream { file };
-
-    send_response(stream, request, Core::guess_mime_type_based_on_filename(real_path));
+    send_file_response(file, request, Core::guess_mime_type_based_on_filename(real_path));
 }
 
-void Client::send_response(InputStream& response, const HTTP::HttpRequest& request, const String& content_type)
+void Client::send_response_header(const HTTP::HttpRequest& request, const String& content_type)
 {
     StringBuilder builder;
     builder.append("HTTP/1.0 200 OK\r\n");
@@ -146,6 +145,11 @@ void Client::send_response(InputStream& response, const HTTP::HttpRequest& reque
 
     m_socket->write(builder.to_string());
     log_response(200, request);
+}
+
+void Client::send_response(InputStream& response, const HTTP::HttpRequest& request, const String& content_type)
+{
+    send_response_header(request, content_type);
 
     char buffer[PAGE_SIZE];
     do {
@@ -157,6 +161,24 @@ void Client::send_response(InputStream& response, const HTTP::HttpRequest& reque
     } while (true);
 }
 
+void Client::send_file_response(Core::File& file, const HTTP::HttpRequest& request, const String& content_type)
+{
+    send_response_header(request, content_type);
+
+    // Let the kernel move the file's contents straight into the socket instead of copying them through here.
+    for (;;) {
+        auto nsent = sendfile(m_socket->fd(), file.fd(), nullptr, 1 * MiB);
+        if (nsent < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("sendfile");
+            return;
+        }
+        if (nsent == 0)
+            break;
+    }
+}
+
 void Client::send_redirect(StringView redirect_path, const HTTP::HttpRequest& request)
 {
     StringBuilder builder;
@@ -708,21 +708,29 @@ public:
 int main(int argc, char** argv)
 {
     bool gc_on_every_allocation = false;
+    bool print_gc_report = false;
     bool disable_syntax_highlight = false;
+    bool run_bytecode = false;
+    bool dump_bytecode = false;
     const char* script_path = nullptr;
 
     Core::ArgsParser args_parser;
     args_parser.set_general_help("This is a JavaScript interpreter.");
     args_parser.add_option(s_dump_ast, "Dump the AST", "dump-ast", 'A');
     args_parser.add_option(s_print_last_result, "Print last result", "print-last-result", 'l');
-    args_parser.add_option(gc_on_every_allocation, "GC on every allocation", "gc-on-every-allocation", 'g');
+    args_parser.add_option(gc_on_every_allocation, "GC on every allocation", "gc-on-every-allocation", 0);
+    args_parser.add_option(print_gc_report, "Print a report of garbage collection pauses on exit", "gc-report", 'g');
     args_parser.add_option(disable_syntax_highlight, "Disable live syntax highlighting", "no-syntax-highlight", 's');
+    args_parser.add_option(run_bytecode, "Run the bytecode interpreter instead of walking the AST", "bytecode", 'b');
+    args_parser.add_option(dump_bytecode, "Dump the bytecode of each function the first time it runs", "dump-bytecode", 'd');
     args_parser.add_positional_argument(script_path, "Path to script file", "script", Core::ArgsParser::Required::No);
     args_parser.parse(argc, argv);
 
     bool syntax_highlight = !disable_syntax_highlight;
 
     vm = JS::VM::create();
+    vm->set_should_run_bytecode(run_bytecode || dump_bytecode);
+    vm->set_should_dump_bytecode(dump_bytecode);
     // NOTE: These will print out both warnings when using something like Promise.reject().catch(...) -
     // which is, as far as I can tell, correct - a promise is created, rejected without handler, and a
     // handler then attached to it. The Node.js REPL doesn't warn in this case, so it's something we
@@ -953,6 +961,9 @@ int main(int argc, char** argv)
         s_editor->on_tab_complete = move(complete);
         repl(*interpreter);
         s_editor->save_history(s_history_path);
+
+        if (print_gc_report)
+            interpreter->heap().dump_statistics();
     } else {
         interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
         ReplConsoleClient console_client(interpreter->global_object().console());
@@ -977,7 +988,12 @@ int main(int argc, char** argv)
             source = file_contents;
         }
 
-        if (!parse_and_run(*interpreter, source))
+        bool success = parse_and_run(*interpreter, source);
+
+        if (print_gc_report)
+            interpreter->heap().dump_statistics();
+
+        if (!success)
             return 1;
     }
 